@@ -3,139 +3,108 @@
 
 
 	void AppraisalManager::appraise(CharacterManager* character, AppraisalVariables* appVars,
-		double intensityCorrection, std::shared_ptr<Emotion::Elicit> currentElicitor) {
+		double intensityCorrection, std::uint32_t currentElicitor) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (appVars != nullptr) {
-			std::shared_ptr<Emotion::Elicit> elicitor = (currentElicitor != nullptr) ? currentElicitor : nullptr;
-			std::string type = appVars->getType();
-			Desirability* desirability = appVars->getDesirability();
-			Praiseworthiness* praiseworthiness = appVars->getPraiseworthiness();
-			Appealingness* appealingness = appVars->getAppealingness();
-			Likelihood* likelihood = appVars->getLikelihood();
-			Realization* realization = appVars->getRealization();
-			Likin* liking = appVars->getLiking();
-			Agency* agency = appVars->getAgency();
-
-			if (type == "EEC") {
+			std::uint32_t elicitor = currentElicitor;
+			AppraisalVariables::Type type = appVars->getType();
+			bool desirability = appVars->has(AppraisalVariables::HasDesirability);
+			bool praiseworthiness = appVars->has(AppraisalVariables::HasPraiseworthiness);
+			bool appealingness = appVars->has(AppraisalVariables::HasAppealingness);
+			bool likelihood = appVars->has(AppraisalVariables::HasLikelihood);
+			bool realization = appVars->has(AppraisalVariables::HasRealization);
+			bool liking = appVars->has(AppraisalVariables::HasLiking);
+			bool agency = appVars->has(AppraisalVariables::HasAgency);
+			bool self = appVars->isSelfAgency();
+			// the corrected degrees are only built by the branch that adds them,
+			// so a degree outside [-1,1] of a variable no EEC uses does not throw
+			auto corrDesirability = [&]() { return Desirability(appVars->getDesirability()*intensityCorrection); };
+			auto corrPraiseworthiness = [&]() { return Praiseworthiness(appVars->getPraiseworthiness()*intensityCorrection); };
+			auto corrAppealingness = [&]() { return Appealingness(appVars->getAppealingness()*intensityCorrection); };
+			auto corrLikelihood = [&]() { return Likelihood(appVars->getLikelihood()*intensityCorrection); };
+			auto corrRealization = [&]() { return Realization(appVars->getRealization()*intensityCorrection); };
+			auto corrLiking = [&]() { return Likin(appVars->getLiking()*intensityCorrection); };
+
+			if (type == AppraisalVariables::Type::EEC) {
 
 				// if EEC contains a realization value, than no other variable is considered ...
-				if ((realization != nullptr)) {
-					Realization* corrRealization =
-						new Realization(realization->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrRealization));
+				if (realization) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrRealization()));
 					return;
 				}
 
 				// eecs for compound emotions (desirability and praiseworthiness)
-				if ((desirability != nullptr) && (praiseworthiness != nullptr) && (agency != nullptr) && (likelihood == nullptr) && (liking == nullptr)) {
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability));
-					Praiseworthiness* corrPraiseworthiness =
-						new Praiseworthiness(praiseworthiness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness, agency));
+				if (desirability && praiseworthiness && agency && !likelihood && !liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability()));
+					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness(), self));
 					return;
 				}
 
-				if ((desirability != nullptr) && (likelihood == nullptr) && (liking == nullptr)) {
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability));
+				if (desirability && !likelihood && !liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability()));
 					return;
 				}
-				if ((desirability != nullptr) && (likelihood != nullptr) && (liking == nullptr)) {
-					Likelihood* corrLikelihood =
-						new Likelihood(likelihood->getDegree()*intensityCorrection);
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability, corrLikelihood));
+				if (desirability && likelihood && !liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability(), corrLikelihood()));
 					return;
 				}
-				if ((desirability != nullptr) && (likelihood == nullptr) && (liking != nullptr)) {
-					Likin* corrLiking =
-						new Likin(liking->getDegree()*intensityCorrection);
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability, corrLiking));
+				if (desirability && !likelihood && liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability(), corrLiking()));
 					return;
 				}
 
 				// eecs for compound emotions (praiseworthiness & appealingness)
-				if ((praiseworthiness != nullptr) && (agency != nullptr) && (appealingness != nullptr)) {
-					Praiseworthiness* corrPraiseworthiness =
-						new Praiseworthiness(praiseworthiness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness, agency));
-					Appealingness* corrAppealingness =
-						new Appealingness(appealingness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness));
+				if (praiseworthiness && agency && appealingness) {
+					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness(), self));
+					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness()));
 					return;
 				}
 
 				// eecs for action
-				if ((praiseworthiness != nullptr) && (agency != nullptr)) {
-					Praiseworthiness* corrPraiseworthiness =
-						new Praiseworthiness(praiseworthiness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness, agency));
+				if (praiseworthiness && agency) {
+					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness(), self));
 					return;
 				}
 
 				// eecs for object
-				if ((appealingness != nullptr)) {
-					Appealingness* corrAppealingness =
-						new Appealingness(appealingness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness));
+				if (appealingness) {
+					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness()));
 					return;
 				}
 				return;
 			}
 
-			if (type == "Action") {
+			if (type == AppraisalVariables::Type::Action) {
 				//sLog.info("\tas action");
-				if ((praiseworthiness != nullptr) && (agency != nullptr)) {
-					Praiseworthiness* corrPraiseworthiness =
-						new Praiseworthiness(praiseworthiness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness, agency));
+				if (praiseworthiness && agency) {
+					character->addEEC(EEC::appraiseAction(elicitor, corrPraiseworthiness(), self));
 				}
 				return;
 			}
-			if (type == "Event") {
+			if (type == AppraisalVariables::Type::Event) {
 				//sLog.info("\tas event");
-				if ((realization != nullptr)) {
-					Realization* corrRealization =
-						new Realization(realization->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrRealization));
+				if (realization) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrRealization()));
 					return;
 				}
-				if ((desirability != nullptr) && (likelihood == nullptr) && (liking == nullptr)) {
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability));
+				if (desirability && !likelihood && !liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability()));
 					return;
 				}
-				if ((desirability != nullptr) && (likelihood != nullptr) && (liking == nullptr)) {
-					Likelihood* corrLikelihood =
-						new Likelihood(likelihood->getDegree()*intensityCorrection);
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability, corrLikelihood));
+				if (desirability && likelihood && !liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability(), corrLikelihood()));
 					return;
 				}
-				if ((desirability != nullptr) && (likelihood == nullptr) && (liking != nullptr)) {
-					Likin* corrLiking =
-						new Likin(liking->getDegree()*intensityCorrection);
-					Desirability* corrDesirability =
-						new Desirability(desirability->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability, corrLiking));
+				if (desirability && !likelihood && liking) {
+					character->addEEC(EEC::appraiseEvent(elicitor, corrDesirability(), corrLiking()));
 					return;
 				}
 				return;
 			}
-			if (type == "Object") {
+			if (type == AppraisalVariables::Type::Object) {
 				//sLog.info("\tas object");
-				if ((appealingness != nullptr)) {
-					Appealingness* corrAppealingness =
-						new Appealingness(appealingness->getDegree()*intensityCorrection);
-					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness));
+				if (appealingness) {
+					character->addEEC(EEC::appraiseObject(elicitor, corrAppealingness()));
 				}
 				return;
 			}
@@ -150,7 +119,7 @@
 
 	AppraisalManager::AppraisalManager() {}
 
-	void AppraisalManager::processBasicECC(AppraisalVariables* appVar, CharacterManager *performer, std::shared_ptr<Emotion::Elicit> elicitor)
+	void AppraisalManager::processBasicECC(AppraisalVariables* appVar, CharacterManager *performer, std::uint32_t elicitor)
 	{
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		//sLog.info("Appraising eec for " + performer.getName());
@@ -15,7 +15,7 @@ private:
 	std::recursive_mutex _mutex;
 
 	void appraise(CharacterManager* character, AppraisalVariables* appVars,
-		double intensityCorrection, std::shared_ptr<Emotion::Elicit> currentElicitor);
+		double intensityCorrection, std::uint32_t currentElicitor);
 
 	
 	
@@ -23,7 +23,7 @@ public:
 
 	AppraisalManager();
 
-	void processBasicECC(AppraisalVariables* appVar, CharacterManager *performer, std::shared_ptr<Emotion::Elicit> elicitor);
+	void processBasicECC(AppraisalVariables* appVar, CharacterManager *performer, std::uint32_t elicitor);
 
 
 	void processPADInput(CharacterManager* performer, Mood m, double intensity, std::string description);
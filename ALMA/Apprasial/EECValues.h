@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+
+/**
+* The <code>EECValues</code> struct is a plain value form of an Emotion
+* Eliciting Condition. It holds the degrees of the appraisal variables in
+* place and marks the specified ones in a bit mask, so large numbers of
+* conditions can be passed to the batched inference of the
+* <code>EmotionEngine</code> in a contiguous array without any allocation.
+* <br>
+* The elicitor is identified by its id in the <code>ElicitorRegistry</code>,
+* 0 meaning none; <code>EEC</code> fills it in from its elicitor. Two single
+* emotions only form a compound emotion if they have the same elicitor.
+*
+* @see EEC
+* @version 1.0
+*/
+struct EECValues {
+	enum Variable : std::uint8_t {
+		HasDesirabilityForSelf = 1 << 0,
+		HasDesirabilityForOther = 1 << 1,
+		HasLikelihood = 1 << 2,
+		HasLiking = 1 << 3,
+		HasRealization = 1 << 4,
+		HasPraiseworthiness = 1 << 5,
+		HasAppealingness = 1 << 6
+	};
+
+	/** the specified appraisal variables */
+	std::uint8_t mask = 0;
+	/** true if the character itself is the agent of a praised or blamed action */
+	bool selfAgency = false;
+	/** the id of the emotion-inducing situation, 0 if there is none */
+	std::uint32_t elicitor = 0;
+	double desirabilityForSelf = 0.0;
+	double desirabilityForOther = 0.0;
+	double likelihood = 0.0;
+	double liking = 0.0;
+	double realization = 0.0;
+	double praiseworthiness = 0.0;
+	double appealingness = 0.0;
+
+	EECValues() {}
+
+	explicit EECValues(std::uint32_t Elicitor) : elicitor(Elicitor) {}
+
+	bool has(Variable variable) const {
+		return (mask & variable) != 0;
+	}
+
+	/**
+	* Returns the condition of an event that is desirable or undesirable for
+	* the character itself.
+	*
+	* @param elicitor the id of the emotion-inducing situation
+	* @param desirability the desirability of the event
+	* @throws std::invalid_argument if the degree is not in <code>[-1.0,1.0]</code>.
+	*/
+	static EECValues appraiseEvent(std::uint32_t elicitor, double desirability) {
+		return EECValues(elicitor).setDesirabilityForSelf(desirability);
+	}
+
+	/**
+	* Returns the condition of a praiseworthy or blameworthy action.
+	*
+	* @param elicitor the id of the emotion-inducing situation
+	* @param praiseworthiness the praiseworthiness of the action
+	* @param self true if the character itself performed the action
+	* @throws std::invalid_argument if the degree is not in <code>[-1.0,1.0]</code>.
+	*/
+	static EECValues appraiseAction(std::uint32_t elicitor, double praiseworthiness, bool self) {
+		return EECValues(elicitor).setPraiseworthiness(praiseworthiness, self);
+	}
+
+	/**
+	* Returns the condition of an appealing or unappealing object.
+	*
+	* @param elicitor the id of the emotion-inducing situation
+	* @param appealingness the appealingness of the object
+	* @throws std::invalid_argument if the degree is not in <code>[-1.0,1.0]</code>.
+	*/
+	static EECValues appraiseObject(std::uint32_t elicitor, double appealingness) {
+		return EECValues(elicitor).setAppealingness(appealingness);
+	}
+
+	EECValues& setDesirabilityForSelf(double degree) {
+		desirabilityForSelf = checked(degree);
+		mask |= HasDesirabilityForSelf;
+		return *this;
+	}
+
+	EECValues& setDesirabilityForOther(double degree) {
+		desirabilityForOther = checked(degree);
+		mask |= HasDesirabilityForOther;
+		return *this;
+	}
+
+	EECValues& setLikelihood(double degree) {
+		likelihood = checked(degree);
+		mask |= HasLikelihood;
+		return *this;
+	}
+
+	EECValues& setLiking(double degree) {
+		liking = checked(degree);
+		mask |= HasLiking;
+		return *this;
+	}
+
+	EECValues& setRealization(double degree) {
+		realization = checked(degree);
+		mask |= HasRealization;
+		return *this;
+	}
+
+	EECValues& setPraiseworthiness(double degree, bool self) {
+		praiseworthiness = checked(degree);
+		selfAgency = self;
+		mask |= HasPraiseworthiness;
+		return *this;
+	}
+
+	EECValues& setAppealingness(double degree) {
+		appealingness = checked(degree);
+		mask |= HasAppealingness;
+		return *this;
+	}
+
+private:
+	static double checked(double degree) {
+		if (degree < -1.0 || degree > 1.0)
+			throw std::invalid_argument("Invalid degree ");
+		return degree;
+	}
+};
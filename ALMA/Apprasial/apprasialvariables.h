@@ -7,11 +7,14 @@
 #include"eec/Realization.h"
 #include"eec/Agency.h"
 #include<string>
+#include<cstdint>
+#include<stdexcept>
 
 /**
 * The class<code> AppraisalVariables</code> holds all posssible variables
 * and their values, which are the result of an subjective appraisal. Based
-* on these values emotions will be generated.
+* on these values emotions will be generated. The variables are stored in
+* place, a bit mask tells which of them are specified.
 *
 * @author Patrick Gebhard
 *
@@ -19,110 +22,168 @@
 */
 class AppraisalVariables {
 
+public:
+	enum class Type : std::uint8_t { Unknown, EEC, Action, Event, Object };
+
+	enum Variable : std::uint8_t {
+		HasDesirability = 1 << 0,
+		HasPraiseworthiness = 1 << 1,
+		HasAppealingness = 1 << 2,
+		HasLikelihood = 1 << 3,
+		HasRealization = 1 << 4,
+		HasAgency = 1 << 5,
+		HasLiking = 1 << 6
+	};
+
 private:
-	 std::string type;
-	 std::string signal;
-	 Desirability *desirability;
-	 Praiseworthiness *praiseworthiness;
-	 Appealingness *appealingness;
-	 Likelihood *likelihood;
-	 Realization *realization;
-	 Agency *agency;
-	 Likin *liking;
-	 std::string elicitor;
+	 Type type = Type::Unknown;
+	 /** the specified variables */
+	 std::uint8_t mask = 0;
+	 bool selfAgency = false;
+	 double desirability = 0.0;
+	 double praiseworthiness = 0.0;
+	 double appealingness = 0.0;
+	 double likelihood = 0.0;
+	 double realization = 0.0;
+	 double liking = 0.0;
+
+	 double& degree(Variable variable) {
+		 switch (variable) {
+		 case HasDesirability: return desirability;
+		 case HasPraiseworthiness: return praiseworthiness;
+		 case HasAppealingness: return appealingness;
+		 case HasLikelihood: return likelihood;
+		 case HasRealization: return realization;
+		 default: return liking;
+		 }
+	 }
+
+	 /**
+	 * Adds x to the degree of a variable and keeps it in [-1.0,1.0]. A variable
+	 * that is not specified starts at 0.0 and is specified afterwards.
+	 */
+	 void adjust(Variable variable, double x) {
+		 double& value = degree(variable);
+		 value = (has(variable) ? value : 0.0) + x;
+		 value = (value > 1.0) ? 1.0 : value;
+		 value = (value < -1.0) ? -1.0 : value;
+		 mask |= variable;
+	 }
 
 public: 
 	AppraisalVariables(){}
-		AppraisalVariables(std::string Type,
-		std::string Signal,
-		Desirability *Desirability,
-		Praiseworthiness *Praiseworthiness,
-		Appealingness *Appealingness,
-		Likelihood *Likelihood,
-		Realization *Realization,
-		Agency *Agency,
-		Likin *Liking,
-			std::string Elicitor) {
-		type = Type;
-		signal = Signal;
-		desirability = Desirability;
-		praiseworthiness = Praiseworthiness;	
-		appealingness = Appealingness;
-		likelihood = Likelihood;
-		realization = Realization;
-		agency = Agency;
-		liking = Liking;
-		elicitor = Elicitor;
+
+	explicit AppraisalVariables(Type appraisalType) : type(appraisalType) {}
+
+	/**
+	* Returns the type of the appraisal for its name in the rule files.
+	*
+	* @param name "EEC", "Action", "Event" or "Object"
+	* @return the type, <code>Type::Unknown</code> for any other name
+	*/
+	static Type typeByName(const std::string& name) {
+		if (name == "EEC")
+			return Type::EEC;
+		if (name == "Action")
+			return Type::Action;
+		if (name == "Event")
+			return Type::Event;
+		if (name == "Object")
+			return Type::Object;
+		return Type::Unknown;
 	}
 
-	 std::string getType() {
+	 Type getType() const {
 		return type;
 	}
 
-	 std::string getSignal() {
-		return signal;
-	}
+	 bool has(Variable variable) const {
+		 return (mask & variable) != 0;
+	 }
+
+	 /**
+	 * Specifies a variable.
+	 *
+	 * @param variable the variable, not <code>HasAgency</code>
+	 * @param value the degree of the variable
+	 * @throws std::invalid_argument if the degree is not in <code>[-1.0,1.0]</code>.
+	 */
+	 AppraisalVariables& set(Variable variable, double value) {
+		 if (value < -1.0 || value > 1.0)
+			 throw std::invalid_argument("Invalid degree ");
+		 degree(variable) = value;
+		 mask |= variable;
+		 return *this;
+	 }
 
-	Desirability* getDesirability() {
+	 /**
+	 * Specifies the character responsible for an action.
+	 *
+	 * @param self true if the character itself is responsible
+	 */
+	 AppraisalVariables& setAgency(bool self) {
+		 selfAgency = self;
+		 mask |= HasAgency;
+		 return *this;
+	 }
+
+	 double getDesirability() const {
 		return desirability;
 	}
 
-	 Praiseworthiness* getPraiseworthiness() {
+	 double getPraiseworthiness() const {
 		return praiseworthiness;
 	}
 
-	 Appealingness* getAppealingness() {
+	 double getAppealingness() const {
 		return appealingness;
 	}
 
-	 Likelihood* getLikelihood() {
+	 double getLikelihood() const {
 		return likelihood;
 	}
 
-	 Realization* getRealization() {
+	 double getRealization() const {
 		return realization;
 	}
 
-	 Agency* getAgency() {
-		return agency;
+	 bool isSelfAgency() const {
+		return selfAgency;
 	}
 
-	 Likin* getLiking() {
+	 double getLiking() const {
 		return liking;
 	}
 
 	 void setLiking(double x)
 	 {
-		 getLiking()->setDegree(getLiking()->getDegree() + x);
+		 adjust(HasLiking, x);
 	 }
 
 	 void setRealization(double x)
 	 {
-		 getRealization()->setDegree(getRealization()->getDegree() + x);
+		 adjust(HasRealization, x);
 	 }
 
 	 void setLikelihood(double x)
 	 {
-		 getLikelihood()->setDegree(getLikelihood()->getDegree() + x);
+		 adjust(HasLikelihood, x);
 	 }
 
 	 void setAppealingness(double x)
 	 {
-		 getAppealingness()->setDegree(getAppealingness()->getDegree() + x);
+		 adjust(HasAppealingness, x);
 	 }
 
 	 void setPraiseworthiness(double x)
 	 {
-		 getPraiseworthiness()->setDegree(getPraiseworthiness()->getDegree() + x);
+		 adjust(HasPraiseworthiness, x);
 	 }
 
 	 void setDesirability(double x)
 	 {
-		 getDesirability()->setDegree(getDesirability()->getDegree() + x);
+		 adjust(HasDesirability, x);
 	 }
-	 std::string getElicitor() {
-		return elicitor;
-	}
 
 
 
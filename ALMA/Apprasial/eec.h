@@ -6,6 +6,7 @@
 #include"eec/Liking.h"
 #include"eec/Praiseworthiness.h"
 #include"eec/Realization.h"
+#include"EECValues.h"
 #include "../Emotions/emotion.h"
 
 
@@ -24,8 +25,8 @@
 * emotions, and object-based emotions respectively. Besides, there are other
 * local variables, which only affect particular groups of emotions.
 * <P>
-* The methods of this class all throw a <code>NullPointerException</code>
-* if the arguments provided to them are null.
+* An EEC is a value: the appraisal variables are stored in place and a
+* bit mask marks the specified ones.
 *
 * @author Patrick Gebhard (based on the work of Wenji Mao and Martin Klesen)
 * @version 2.0
@@ -34,16 +35,11 @@ class EEC {
 private:
 	EEC() {} // defeat instanciation
 public:
-	std::shared_ptr<Emotion::Elicit> elicitor;
-	// variables affecting the intensity of particular groups of emotions
-	 Desirability* desirabilityForSelf;
-	 Desirability* desirabilityForOther;
-	 Praiseworthiness* praiseworthiness;
-	 Appealingness* appealingness;
-	 Likelihood* likelihood;
-	 Realization* realization;
-	 Likin* liking;
-	 Agency* character;
+	/**
+	* the variables affecting the intensity of particular groups of emotions,
+	* the mask tells which of them are specified, and the id of the elicitor
+	*/
+	EECValues values;
 
 
 					 /**
@@ -51,16 +47,14 @@ public:
 					 * subjective appraisal of an event as being desirable or
 					 * undesirable for the character itself.
 					 *
-					 * @param elicitor the emotion-inducing situation
+					 * @param elicitor the id of the emotion-inducing situation
 					 * @param desirability the desirability of the event
 					 * @return the new Emotion Eliciting Condition.
 					 */
-	 static EEC* appraiseEvent(std::shared_ptr<Emotion::Elicit> elicitor, Desirability* desirability) {
-		if (desirability == nullptr)
-			throw std::invalid_argument("Desirability not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->desirabilityForSelf = desirability;
+	 static EEC appraiseEvent(std::uint32_t elicitor, Desirability desirability) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setDesirabilityForSelf(desirability.getDegree());
 		return eec;
 	}
 
@@ -69,21 +63,17 @@ public:
 	* subjective appraisal of an anticipated event as being
 	* desirable or undesirable for the character itself.
 	*
-	* @param elicitor the emotion-inducing situation
+	* @param elicitor the id of the emotion-inducing situation
 	* @param desirability the desirability of the anticipated event
 	* @param likelihood the likelihood of the anticipated event
 	* @return the new Emotion Eliciting Condition.
 	*/
-	 static EEC* appraiseEvent(std::shared_ptr<Emotion::Elicit> elicitor, Desirability* desirability,
-		Likelihood* likelihood) {
-		if (desirability == nullptr)
-			throw std::invalid_argument("Desirability not specified.");
-		if (likelihood == nullptr)
-			throw std::invalid_argument("Likelihood not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->desirabilityForSelf = desirability;
-		eec->likelihood = likelihood;
+	 static EEC appraiseEvent(std::uint32_t elicitor, Desirability desirability,
+		Likelihood likelihood) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setDesirabilityForSelf(desirability.getDegree());
+		eec.values.setLikelihood(likelihood.getDegree());
 		return eec;
 	}
 
@@ -91,16 +81,14 @@ public:
 	* Returns a new Emotion Eliciting Condition representing the
 	* status of an anticipated event.
 	*
-	* @param elicitor the emotion-inducing situation
+	* @param elicitor the id of the emotion-inducing situation
 	* @param realization the status of an anticipated event
 	* @return the new Emotion Eliciting Condition.
 	*/
-	 static EEC* appraiseEvent(std::shared_ptr<Emotion::Elicit>elicitor, Realization* realization) {
-		if (realization == nullptr)
-			throw std::invalid_argument("Realization not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->realization = realization;
+	 static EEC appraiseEvent(std::uint32_t elicitor, Realization realization) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setRealization(realization.getDegree());
 		return eec;
 	}
 
@@ -109,20 +97,16 @@ public:
 	* subjective appraisal of an event as being desirable or
 	* undesirable for another character.
 	*
-	* @param elicitor the emotion-inducing situation
+	* @param elicitor the id of the emotion-inducing situation
 	* @param desirability the desirability of the event for the other person
 	* @param liking the liking for the other person
 	* @return the new Emotion Eliciting Condition.
 	*/
-	 static EEC* appraiseEvent(std::shared_ptr<Emotion::Elicit> elicitor, Desirability* desirability, Likin* liking) {
-		if (desirability == nullptr)
-			throw new std::invalid_argument("Desirability not specified.");
-		if (liking == nullptr)
-			throw std::invalid_argument("Liking not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->desirabilityForOther = desirability;
-		eec->liking = liking;
+	 static EEC appraiseEvent(std::uint32_t elicitor, Desirability desirability, Likin liking) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setDesirabilityForOther(desirability.getDegree());
+		eec.values.setLiking(liking.getDegree());
 		return eec;
 	}
 
@@ -131,21 +115,16 @@ public:
 	* subjective appraisal of an action as being praiseworthy or
 	* blameworthy.
 	*
-	* @param elicitor the emotion-inducing situation
+	* @param elicitor the id of the emotion-inducing situation
 	* @param praiseworthiness the praiseworthiness of the action.
-	* @param character the character considered responsible for the action.
+	* @param self true if the character itself is responsible for the action.
 	* @return the new Emotion Eliciting Condition.
 	*/
-	 static EEC* appraiseAction(std::shared_ptr<Emotion::Elicit> elicitor, Praiseworthiness* praiseworthiness,
-		Agency* character) {
-		if (praiseworthiness == nullptr)
-			throw std::invalid_argument("Praiseworthiness not specified.");
-		if (character == nullptr)
-			throw std::invalid_argument("Agency not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->praiseworthiness = praiseworthiness;
-		eec->character = character;
+	 static EEC appraiseAction(std::uint32_t elicitor, Praiseworthiness praiseworthiness,
+		bool self) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setPraiseworthiness(praiseworthiness.getDegree(), self);
 		return eec;
 	}
 
@@ -154,27 +133,29 @@ public:
 	* subjective appraisal of an object as being appealing or
 	* unappealing.
 	*
-	* @param elicitor the emotion-inducing situation
+	* @param elicitor the id of the emotion-inducing situation
 	* @param appealingness the appealingness of the object
 	* @return the new Emotion Eliciting Condition.
 	*/
-	 static EEC* appraiseObject(std::shared_ptr<Emotion::Elicit> elicitor, Appealingness* appealingness) {
-		if (appealingness == nullptr)
-			throw std::invalid_argument("Appealingness not specified.");
-		EEC* eec = new EEC();
-		eec->elicitor = elicitor;
-		eec->appealingness = appealingness;
+	 static EEC appraiseObject(std::uint32_t elicitor, Appealingness appealingness) {
+		EEC eec;
+		eec.values.elicitor = elicitor;
+		eec.values.setAppealingness(appealingness.getDegree());
 		return eec;
 	}
 
+	bool has(EECValues::Variable variable) const {
+		return values.has(variable);
+	}
+
 	/**
 	* Returns the emotion-inducing situation whose subjective appraisal
 	* is represented by this Emotion Eliciting Condition.
 	*
-	* @return the emotion-inducing situation.
+	* @return the id of the emotion-inducing situation.
 	*/
-	 std::shared_ptr<Emotion::Elicit> getElicitor() {
-		return elicitor;
+	 std::uint32_t getElicitor() const {
+		return values.elicitor;
 	}
 
 	/**
@@ -2,8 +2,6 @@
 #include "Manage/charactermanager.h"
 #include"AppraisalManager.h"
 
-ofstream outputFile;
-std::string filename = "./output/HighNegAgreeNoMem.csv";
 
 bool ESelector::run() 
 {
@@ -42,14 +40,15 @@ bool ESelector::run()
 bool EmotionAdder::run(int _playerChoice)
 {
 	theNPC->emotionAffector(theNPC->getName());// makes the memmory impact the emotional state of the npc;
-	AppraisalVariables* appvar = new AppraisalVariables();
+	AppraisalVariables noAppraisal;
+	AppraisalVariables* appvar = &noAppraisal;
 	appraisalManagerInstance = new AppraisalManager();
 	double intensityNum = 0.0;
 	double total = 0.0;
 	std::shared_ptr<Emotion> Emo;
 	std::string key = "";
 	intensity = intensityMap[choices[_playerChoice]];
-	std::shared_ptr<Emotion::Elicit> Elictor = std::make_shared<Emotion::Elicit>(triggers[_playerChoice]); 	
+	std::uint32_t Elictor = Emotion::elicitorOf(triggers[_playerChoice]); 	
 	//positive emotions 
 	/*if (choices[_playerChoice] == "joy" or choices[_playerChoice] == "happyfor" or choices[_playerChoice] == "hope" or
 		choices[_playerChoice] ==  "satisfaction" or choices[_playerChoice] == "relief" or choices[_playerChoice] == "pride" or choices[_playerChoice] == "admiration" or
@@ -316,15 +315,20 @@ bool EmotionAdder::run(int _playerChoice)
 	// sending to memory 
 	//theNPC->sendToMem(key,theNPC->getName(), triggers[_playerChoice], theNPC->getCurrentMood(), intensity, triggers[_playerChoice]);
 	
-	outputFile.open(filename, ios::out | ios::app);
-
-	outputFile << choices[_playerChoice] << ","
-		<< theNPC->getCurrentMood().getPleasure() << "," << theNPC->getCurrentMood().getArousal() << "," 
-		<< theNPC->getCurrentMood().getDominance() << "," << theNPC->getCurrentMood().getMoodWord() << "," 
-		<< theNPC->getCurrentMood().getMoodWordIntensity() << "," << theNPC->getMoodEngine()->getEmotionsCenter()->getPValue() << "," 
-		<< theNPC->getMoodEngine()->getEmotionsCenter()->getAValue() << "," << theNPC->getMoodEngine()->getEmotionsCenter()->getDValue() << std::endl;
-	outputFile.close();
-	theNPC->getMoodEngine()->getEmotionsCenter()->getPValue();
+	Mood currentMood = theNPC->getCurrentMood();
+	EmotionPADCentroid emotionsCenter = theNPC->getEmotionsCenter();
+	TelemetryRecord record;
+	record.kind = TelemetryRecord::MoodSample;
+	record.setLabel(choices[_playerChoice]);
+	record.values[0] = currentMood.getPleasure();
+	record.values[1] = currentMood.getArousal();
+	record.values[2] = currentMood.getDominance();
+	record.setMood(currentMood.getMoodWord());
+	record.setDetail(currentMood.getMoodWordIntensity());
+	record.values[3] = emotionsCenter.getPValue();
+	record.values[4] = emotionsCenter.getAValue();
+	record.values[5] = emotionsCenter.getDValue();
+	Telemetry::getInstance().submit(theNPC->getMoodChannel(), record);
 	
 	switch (getTypeByName(choices[_playerChoice]))
 	{
@@ -241,7 +241,9 @@ public:
 			std::cout << decision << "\n\n";
 		}
 		int choice;
-		std::cin >> choice;
+		// an exhausted choice script picks the first option
+		if (!(*input() >> choice))
+			choice = 1;
 		
 		//if child is a emotion adder pass the choice down else just run
 		Node* temp = nullptr;
@@ -272,7 +274,20 @@ public:
 	{
 		return Id;
 	}
+	/**
+	* Sets the stream all player choices are read from, std::cin by default.
+	* Scripted runs pass a stream holding the sequence of choices.
+	*/
+	static void setInput(std::istream* in)
+	{
+		input() = in;
+	}
 private:
+	static std::istream*& input()
+	{
+		static std::istream* in = &std::cin;
+		return in;
+	}
 	int Id = 0;
 	std::vector<std::string> choices;
 };
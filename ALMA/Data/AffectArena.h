@@ -0,0 +1,277 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+/**
+* The class <code>AffectArena</code> is a per-character memory region. All
+* long-lived affect objects of a character (engines, emotion history, emotions
+* and emotion vectors) are carved out of one block, so spawning a character
+* costs a single allocation and despawning a single release.
+* <br>
+* Objects created with <code>create</code> live until the arena is destroyed
+* and are destroyed in reverse creation order. Small objects handed out through
+* <code>ArenaAllocator</code> (e.g. emotions created with
+* <code>makeShared</code>) are recycled through per-size free lists, so the
+* steady state of a character does not grow the arena. If the initial block
+* is exhausted further blocks are chained.
+*
+* @version 1.0
+*/
+class AffectArena {
+	struct Block {
+		Block* next;
+		size_t size;
+		size_t used;
+	};
+
+	struct FreeNode {
+		FreeNode* next;
+	};
+
+	struct Destructor {
+		void(*destroy)(void*);
+		void* object;
+		Destructor* next;
+	};
+
+	static const size_t sALIGN = alignof(std::max_align_t);
+	static const size_t sSIZECLASSES = 32;
+	static const size_t sHEADER = (sizeof(Block) + sALIGN - 1) / sALIGN * sALIGN;
+
+	std::mutex _mutex;
+	Block* fBlocks = nullptr;
+	FreeNode* fFreeLists[sSIZECLASSES] = {};
+	Destructor* fDestructors = nullptr;
+	size_t fBlockSize;
+
+	static size_t roundUp(size_t size) {
+		return (size + sALIGN - 1) / sALIGN * sALIGN;
+	}
+
+	template<class T>
+	static void destroyObject(void* object) {
+		static_cast<T*>(object)->~T();
+	}
+
+	void* bump(size_t size) {
+		if ((fBlocks == nullptr) || (fBlocks->used + size > fBlocks->size)) {
+			size_t capacity = (size > fBlockSize) ? size : fBlockSize;
+			Block* block = static_cast<Block*>(std::malloc(sHEADER + capacity));
+			if (block == nullptr)
+				throw std::bad_alloc();
+			block->next = fBlocks;
+			block->size = capacity;
+			block->used = 0;
+			fBlocks = block;
+		}
+		void* result = reinterpret_cast<char*>(fBlocks) + sHEADER + fBlocks->used;
+		fBlocks->used += size;
+		return result;
+	}
+
+	void registerDestructor(void(*destroy)(void*), void* object) {
+		Destructor* d = static_cast<Destructor*>(allocate(sizeof(Destructor)));
+		d->destroy = destroy;
+		d->object = object;
+		std::lock_guard<std::mutex> lock(_mutex);
+		d->next = fDestructors;
+		fDestructors = d;
+	}
+
+public:
+	/**
+	* Creates an arena whose first block holds the specified number of bytes.
+	*
+	* @param blockSize size of the initial (and of every chained) block
+	*/
+	explicit AffectArena(size_t blockSize) : fBlockSize(roundUp(blockSize)) {
+		bump(0);
+	}
+
+	AffectArena(const AffectArena&) = delete;
+	AffectArena& operator=(const AffectArena&) = delete;
+
+	~AffectArena() {
+		destroyObjects();
+		while (fBlocks != nullptr) {
+			Block* next = fBlocks->next;
+			std::free(fBlocks);
+			fBlocks = next;
+		}
+	}
+
+	/**
+	* Destroys all objects created by <code>create</code> in reverse creation
+	* order. The owner calls this on despawn: the objects may hold shared
+	* objects allocated from this arena, which in turn keep the arena alive.
+	*/
+	void destroyObjects() {
+		Destructor* d;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			d = fDestructors;
+			fDestructors = nullptr;
+		}
+		for (; d != nullptr; d = d->next) {
+			if (d->object != nullptr)
+				d->destroy(d->object);
+		}
+	}
+
+	/**
+	* Returns uninitialized memory of the specified size. Small sizes are served
+	* from the free lists first.
+	*
+	* @param size number of bytes
+	* @return pointer to memory aligned for any fundamental type
+	*/
+	void* allocate(size_t size) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		size = roundUp(size == 0 ? 1 : size);
+		size_t sizeClass = size / sALIGN - 1;
+		if ((sizeClass < sSIZECLASSES) && (fFreeLists[sizeClass] != nullptr)) {
+			FreeNode* node = fFreeLists[sizeClass];
+			fFreeLists[sizeClass] = node->next;
+			return node;
+		}
+		return bump(size);
+	}
+
+	/**
+	* Returns memory obtained by <code>allocate</code> to the arena. Small
+	* sizes are kept for reuse, larger ones are reclaimed when the arena is
+	* destroyed.
+	*
+	* @param p the memory to return
+	* @param size the size that was passed to <code>allocate</code>
+	*/
+	void deallocate(void* p, size_t size) {
+		if (p == nullptr)
+			return;
+		std::lock_guard<std::mutex> lock(_mutex);
+		size = roundUp(size == 0 ? 1 : size);
+		size_t sizeClass = size / sALIGN - 1;
+		if (sizeClass < sSIZECLASSES) {
+			FreeNode* node = static_cast<FreeNode*>(p);
+			node->next = fFreeLists[sizeClass];
+			fFreeLists[sizeClass] = node;
+		}
+	}
+
+	/**
+	* Constructs an object inside the arena. The object is destroyed together
+	* with the arena.
+	*
+	* @param args the constructor arguments
+	* @return the new object
+	*/
+	template<class T, class... Args>
+	T* create(Args&&... args) {
+		void* p = allocate(sizeof(T));
+		T* object = nullptr;
+		try {
+			object = new (p) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			deallocate(p, sizeof(T));
+			throw;
+		}
+		registerDestructor(&destroyObject<T>, object);
+		return object;
+	}
+
+	/**
+	* Destroys an object created by <code>create</code> and constructs a new one
+	* in its place. Used where the Java code replaced an engine with a new
+	* instance.
+	* <br>
+	* The address does not change, so a pointer to the object is a stable
+	* handle: it refers to the new object after the call. Pointers and
+	* references into the old object's members are invalid afterwards and must
+	* not be held across a recreate. If the constructor throws, the object is
+	* gone and <code>object</code> is set to nullptr.
+	*
+	* @param object an object created by this arena, the owner's pointer
+	* @param args the constructor arguments
+	* @return the new object (same address as <code>object</code>)
+	*/
+	template<class T, class... Args>
+	T* recreate(T*& object, Args&&... args) {
+		if (object == nullptr)
+			return object = create<T>(std::forward<Args>(args)...);
+		object->~T();
+		try {
+			return new (object) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (Destructor* d = fDestructors; d != nullptr; d = d->next) {
+				if (d->object == object)
+					d->object = nullptr;
+			}
+			object = nullptr;
+			throw;
+		}
+	}
+
+	template<class T, class... Args>
+	static std::shared_ptr<T> makeShared(const std::shared_ptr<AffectArena>& arena, Args&&... args);
+};
+
+/**
+* Standard allocator that takes its memory from an <code>AffectArena</code>.
+* It keeps the arena alive, so objects allocated through it may safely
+* outlive the character that created them.
+*/
+template<class T>
+class ArenaAllocator {
+	template<class U> friend class ArenaAllocator;
+	std::shared_ptr<AffectArena> fArena;
+
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(std::shared_ptr<AffectArena> arena) : fArena(std::move(arena)) {
+	}
+
+	template<class U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : fArena(other.fArena) {
+	}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(fArena->allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t n) {
+		fArena->deallocate(p, n * sizeof(T));
+	}
+
+	template<class U>
+	bool operator==(const ArenaAllocator<U>& other) const {
+		return fArena == other.fArena;
+	}
+
+	template<class U>
+	bool operator!=(const ArenaAllocator<U>& other) const {
+		return fArena != other.fArena;
+	}
+};
+
+/**
+* Creates a shared object in the specified arena, or on the heap if no arena
+* is given.
+*
+* @param arena the arena or nullptr
+* @param args the constructor arguments
+* @return the new shared object
+*/
+template<class T, class... Args>
+std::shared_ptr<T> AffectArena::makeShared(const std::shared_ptr<AffectArena>& arena, Args&&... args) {
+	if (arena == nullptr)
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
@@ -10,6 +10,10 @@ class AffectConsts {
 	 long emotionDecayOverallTime = 1.8;
 	 int emotionDecayPeriod = 1;
 	 int emotionDecaySteps = 1;
+	 /** Maximal number of emotion vectors in the emotion history */
+	 int emotionHistoryLength = 64;
+	 /** Largest change of mood or traits that keeps the cached default emotions */
+	 double defaultEmotionsEpsilon = 0.001;
 
 	 long moodReturnOverallTime = 600000;
 	 int moodReturnPeriod = 1;
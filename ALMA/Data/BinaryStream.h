@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/**
+* The class <code>BinaryWriter</code> serializes plain values and strings into
+* an in-memory buffer. Values are stored in the byte order of the machine, the
+* resulting data is meant to be read back by the same build (save games,
+* migration between servers of one deployment, forking characters).
+*
+* @version 1.0
+*/
+class BinaryWriter {
+	std::string fBuffer;
+
+public:
+	BinaryWriter() {
+	}
+
+	/**
+	* Appends a trivially copyable value.
+	*
+	* @param value the value to append
+	*/
+	template<class T>
+	void write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+		fBuffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	/**
+	* Appends a string prefixed with its length.
+	*
+	* @param value the string to append
+	*/
+	void writeString(const std::string& value) {
+		write<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+		fBuffer.append(value);
+	}
+
+	/**
+	* Appends raw bytes without a length prefix.
+	*
+	* @param data the bytes
+	* @param size the number of bytes
+	*/
+	void writeBytes(const char* data, size_t size) {
+		fBuffer.append(data, size);
+	}
+
+	const std::string& data() const {
+		return fBuffer;
+	}
+
+	size_t size() const {
+		return fBuffer.size();
+	}
+};
+
+/**
+* The class <code>BinaryReader</code> reads values written by
+* <code>BinaryWriter</code> from a memory range. Reading past the end throws an
+* <code>std::invalid_argument</code>, so truncated or corrupt data never leads
+* to reads outside the range.
+*
+* @version 1.0
+*/
+class BinaryReader {
+	const char* fData;
+	size_t fSize;
+	size_t fPosition = 0;
+
+	void require(size_t size) {
+		if (size > fSize - fPosition)
+			throw std::invalid_argument("Unexpected end of binary data");
+	}
+
+public:
+	/**
+	* Creates a reader for the specified bytes. The bytes must outlive the
+	* reader.
+	*
+	* @param data the first byte
+	* @param size the number of bytes
+	*/
+	BinaryReader(const char* data, size_t size) : fData(data), fSize(size) {
+	}
+
+	explicit BinaryReader(const std::string& data) : BinaryReader(data.data(), data.size()) {
+	}
+
+	/**
+	* Reads a trivially copyable value.
+	*
+	* @return the value
+	*/
+	template<class T>
+	T read() {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+		require(sizeof(T));
+		T value;
+		std::memcpy(&value, fData + fPosition, sizeof(T));
+		fPosition += sizeof(T);
+		return value;
+	}
+
+	/**
+	* Reads a string written by <code>BinaryWriter::writeString</code>.
+	*
+	* @return the string
+	*/
+	std::string readString() {
+		std::uint32_t size = read<std::uint32_t>();
+		require(size);
+		std::string value(fData + fPosition, size);
+		fPosition += size;
+		return value;
+	}
+
+	/**
+	* Reads an element count and checks that at least <code>minElementSize</code>
+	* bytes per element are left, so corrupt counts fail before anything is
+	* allocated.
+	*
+	* @param minElementSize the smallest possible size of one element
+	* @return the count
+	*/
+	std::uint32_t readCount(size_t minElementSize) {
+		std::uint32_t count = read<std::uint32_t>();
+		if ((minElementSize > 0) && (count > (fSize - fPosition) / minElementSize))
+			throw std::invalid_argument("Invalid element count in binary data");
+		return count;
+	}
+
+	/**
+	* Skips the specified number of bytes.
+	*
+	* @param size the number of bytes
+	*/
+	void skip(size_t size) {
+		require(size);
+		fPosition += size;
+	}
+
+	size_t position() const {
+		return fPosition;
+	}
+
+	bool atEnd() const {
+		return fPosition == fSize;
+	}
+};
@@ -0,0 +1,326 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../Emotions/EmotionSet.h"
+#include "../Manage/affectsnapshot.h"
+
+/**
+* The struct <code>QuantizedAffect</code> is the reduced precision affective
+* state of one member of a crowd. Mood and mood tendency are stored as 16 bit
+* fixed point in <code>[-1,1]</code>, intensities and baselines of the
+* enabled emotion types as unsigned fixed point in <code>[0,1]</code> of the
+* width of <code>Level</code>. The record is cache line aligned and takes
+* two cache lines with every emotion type enabled; an emotion set of up to
+* 12 types with 16 bit levels or 25 types with 8 bit levels fits one.
+*
+* @param Level the fixed point type of intensities and baselines,
+*              <code>std::uint8_t</code> or <code>std::uint16_t</code>
+*/
+template<class Level>
+struct alignas(64) QuantizedAffect {
+	static_assert(std::numeric_limits<Level>::is_integer && !std::numeric_limits<Level>::is_signed,
+		"Emotion levels are unsigned fixed point");
+
+	std::int16_t mood[3];
+	std::int16_t tendency[3];
+	std::uint8_t dominantEmotion;
+	/** indexed by the dense index of the enabled emotion type */
+	Level intensities[EnabledEmotions::sCOUNT];
+	Level baselines[EnabledEmotions::sCOUNT];
+};
+
+/**
+* The deviation of the quantized state from the double precision reference,
+* as the largest and the root mean square error of each kind of value.
+*/
+struct CrowdPrecisionReport {
+	size_t members = 0;
+	double maxMoodError = 0.0;
+	double rmsMoodError = 0.0;
+	double maxIntensityError = 0.0;
+	double rmsIntensityError = 0.0;
+	double maxBaselineError = 0.0;
+	double rmsBaselineError = 0.0;
+	/** members whose dominant emotion changed */
+	size_t dominantMismatches = 0;
+
+	std::string toString() const {
+		return "members=" + std::to_string(members)
+			+ " mood max=" + std::to_string(maxMoodError) + " rms=" + std::to_string(rmsMoodError)
+			+ " intensity max=" + std::to_string(maxIntensityError) + " rms=" + std::to_string(rmsIntensityError)
+			+ " baseline max=" + std::to_string(maxBaselineError) + " rms=" + std::to_string(rmsBaselineError)
+			+ " dominant mismatches=" + std::to_string(dominantMismatches);
+	}
+};
+
+/**
+* The class <code>CrowdAffectStore</code> is an optional storage mode for the
+* affective state of very large populations. It keeps one
+* <code>QuantizedAffect</code> record per member in a contiguous array
+* instead of a double precision <code>AffectSnapshot</code>; the characters
+* themselves keep computing in double precision and publish into the store.
+* <br>
+* The kernels read the fixed point values and widen them to float while they
+* compute, the records are never expanded in memory. Quantization rounds to
+* the nearest step, so the error of a value is at most half a step; the
+* precision report measures it against the double reference.
+*
+* @param Level the fixed point type of intensities and baselines
+* @version 1.0
+*/
+template<class Level = std::uint16_t>
+class CrowdAffectStore {
+public:
+	typedef QuantizedAffect<Level> Record;
+
+	/** the value of one step of a mood component */
+	static constexpr float sMOODSTEP = 1.0f / 32767.0f;
+	/** the value of one step of an intensity or a baseline */
+	static constexpr float sLEVELSTEP = 1.0f / std::numeric_limits<Level>::max();
+
+private:
+	/** the records, aligned to cache lines */
+	std::unique_ptr<unsigned char[]> fMemory;
+	Record* fRecords = nullptr;
+	size_t fSize = 0;
+
+	static std::int16_t quantizeMood(double value) {
+		value = (value > 1.0) ? 1.0 : ((value < -1.0) ? -1.0 : value);
+		return static_cast<std::int16_t>(std::lround(value * 32767.0));
+	}
+
+	static Level quantizeLevel(double value) {
+		value = (value > 1.0) ? 1.0 : ((value < 0.0) ? 0.0 : value);
+		return static_cast<Level>(std::lround(value * std::numeric_limits<Level>::max()));
+	}
+
+	static float widenMood(std::int16_t value) {
+		return value * sMOODSTEP;
+	}
+
+	static float widenLevel(Level value) {
+		return value * sLEVELSTEP;
+	}
+
+	const Record& at(size_t member) const {
+		if (member >= fSize)
+			throw std::invalid_argument("Crowd member out of range: " + std::to_string(member));
+		return fRecords[member];
+	}
+
+public:
+	/**
+	* Creates a store for the specified number of members, all in the neutral
+	* state.
+	*/
+	explicit CrowdAffectStore(size_t members = 0) {
+		resize(members);
+	}
+
+	CrowdAffectStore(const CrowdAffectStore&) = delete;
+	CrowdAffectStore& operator=(const CrowdAffectStore&) = delete;
+
+	size_t size() const {
+		return fSize;
+	}
+
+	/**
+	* Changes the number of members. The state of the remaining members is
+	* kept, new members are in the neutral state.
+	*/
+	void resize(size_t members) {
+		std::unique_ptr<unsigned char[]> memory(new unsigned char[members * sizeof(Record) + alignof(Record)]);
+		std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory.get());
+		Record* records = reinterpret_cast<Record*>((address + alignof(Record) - 1) & ~(static_cast<std::uintptr_t>(alignof(Record)) - 1));
+		size_t kept = (members < fSize) ? members : fSize;
+		// records are plain values, all zero is the neutral state
+		std::memset(static_cast<void*>(records), 0, members * sizeof(Record));
+		if (kept > 0)
+			std::memcpy(static_cast<void*>(records), fRecords, kept * sizeof(Record));
+		fMemory = std::move(memory);
+		fRecords = records;
+		fSize = members;
+	}
+
+	/**
+	* Stores the affective state of a member, e.g. the snapshot its character
+	* published. Emotion types that are not enabled are dropped.
+	*
+	* @param member the index of the member
+	* @param snapshot the double precision state
+	*/
+	void store(size_t member, const AffectSnapshot& snapshot) {
+		at(member);
+		Record& record = fRecords[member];
+		record.mood[0] = quantizeMood(snapshot.moodPleasure);
+		record.mood[1] = quantizeMood(snapshot.moodArousal);
+		record.mood[2] = quantizeMood(snapshot.moodDominance);
+		record.tendency[0] = quantizeMood(snapshot.tendencyPleasure);
+		record.tendency[1] = quantizeMood(snapshot.tendencyArousal);
+		record.tendency[2] = quantizeMood(snapshot.tendencyDominance);
+		record.dominantEmotion = static_cast<std::uint8_t>(snapshot.dominantEmotion);
+		EnabledEmotions::forEach([&](EmotionType type) {
+			size_t index = EnabledEmotions::indexOf(type);
+			record.intensities[index] = quantizeLevel(snapshot.intensities[type]);
+			record.baselines[index] = quantizeLevel(snapshot.baselines[type]);
+		});
+	}
+
+	/**
+	* Returns the state of a member widened to a snapshot. Its version is 0,
+	* the types that are not enabled are 0.0.
+	*
+	* @param member the index of the member
+	*/
+	AffectSnapshot load(size_t member) const {
+		const Record& record = at(member);
+		AffectSnapshot snapshot;
+		snapshot.moodPleasure = widenMood(record.mood[0]);
+		snapshot.moodArousal = widenMood(record.mood[1]);
+		snapshot.moodDominance = widenMood(record.mood[2]);
+		snapshot.tendencyPleasure = widenMood(record.tendency[0]);
+		snapshot.tendencyArousal = widenMood(record.tendency[1]);
+		snapshot.tendencyDominance = widenMood(record.tendency[2]);
+		snapshot.dominantEmotion = record.dominantEmotion;
+		EnabledEmotions::forEach([&](EmotionType type) {
+			size_t index = EnabledEmotions::indexOf(type);
+			snapshot.intensities[type] = widenLevel(record.intensities[index]);
+			snapshot.baselines[type] = widenLevel(record.baselines[index]);
+		});
+		return snapshot;
+	}
+
+	/**
+	* Writes the mood of every member to three float arrays of
+	* <code>size()</code> elements.
+	*/
+	void getMoods(float* pleasure, float* arousal, float* dominance) const {
+		for (size_t i = 0; i < fSize; i++) {
+			const Record& record = fRecords[i];
+			pleasure[i] = widenMood(record.mood[0]);
+			arousal[i] = widenMood(record.mood[1]);
+			dominance[i] = widenMood(record.mood[2]);
+		}
+	}
+
+	/**
+	* Writes the intensity of an emotion type of every member to a float
+	* array of <code>size()</code> elements, 0.0 if the type is not enabled.
+	*/
+	void getIntensities(EmotionType type, float* intensities) const {
+		if (!EnabledEmotions::contains(type)) {
+			for (size_t i = 0; i < fSize; i++)
+				intensities[i] = 0.0f;
+			return;
+		}
+		size_t index = EnabledEmotions::indexOf(type);
+		for (size_t i = 0; i < fSize; i++)
+			intensities[i] = widenLevel(fRecords[i].intensities[index]);
+	}
+
+	/**
+	* Returns the average mood of the crowd.
+	*/
+	void getAverageMood(double& pleasure, double& arousal, double& dominance) const {
+		// integer sums are exact, the mean is widened once
+		std::int64_t sums[3] = { 0, 0, 0 };
+		for (size_t i = 0; i < fSize; i++) {
+			const Record& record = fRecords[i];
+			sums[0] += record.mood[0];
+			sums[1] += record.mood[1];
+			sums[2] += record.mood[2];
+		}
+		double scale = (fSize == 0) ? 0.0 : sMOODSTEP / static_cast<double>(fSize);
+		pleasure = sums[0] * scale;
+		arousal = sums[1] * scale;
+		dominance = sums[2] * scale;
+	}
+
+	/**
+	* Counts the members whose mood lies within the specified distance of a
+	* mood, e.g. to find the crowd members in an extreme mood.
+	*/
+	size_t countNearMood(float pleasure, float arousal, float dominance, float distance) const {
+		float limit = distance * distance;
+		size_t count = 0;
+		for (size_t i = 0; i < fSize; i++) {
+			const Record& record = fRecords[i];
+			float dp = widenMood(record.mood[0]) - pleasure;
+			float da = widenMood(record.mood[1]) - arousal;
+			float dd = widenMood(record.mood[2]) - dominance;
+			count += ((dp * dp + da * da + dd * dd) <= limit) ? 1 : 0;
+		}
+		return count;
+	}
+
+	/**
+	* Compares the stored state with the double precision state it was
+	* stored from.
+	*
+	* @param reference the snapshots of the members, <code>size()</code> elements
+	* @return the deviation of the stored state
+	*/
+	CrowdPrecisionReport compare(const std::vector<AffectSnapshot>& reference) const {
+		if (reference.size() != fSize)
+			throw std::invalid_argument("Reference does not match the crowd size.");
+		CrowdPrecisionReport report;
+		report.members = fSize;
+		double moodSquares = 0.0;
+		double intensitySquares = 0.0;
+		double baselineSquares = 0.0;
+		size_t moods = 0;
+		size_t levels = 0;
+		auto account = [](double error, double& max, double& squares) {
+			error = std::fabs(error);
+			max = (error > max) ? error : max;
+			squares += error * error;
+		};
+		for (size_t i = 0; i < fSize; i++) {
+			AffectSnapshot stored = load(i);
+			const AffectSnapshot& exact = reference[i];
+			const double storedMood[6] = { stored.moodPleasure, stored.moodArousal, stored.moodDominance,
+				stored.tendencyPleasure, stored.tendencyArousal, stored.tendencyDominance };
+			const double exactMood[6] = { exact.moodPleasure, exact.moodArousal, exact.moodDominance,
+				exact.tendencyPleasure, exact.tendencyArousal, exact.tendencyDominance };
+			for (int k = 0; k < 6; k++)
+				account(storedMood[k] - exactMood[k], report.maxMoodError, moodSquares);
+			moods += 6;
+			EnabledEmotions::forEach([&](EmotionType type) {
+				account(stored.intensities[type] - exact.intensities[type], report.maxIntensityError, intensitySquares);
+				account(stored.baselines[type] - exact.baselines[type], report.maxBaselineError, baselineSquares);
+				levels++;
+			});
+			// the dominant emotion as it would be chosen from the stored values
+			std::uint64_t dominant = EmotionType::Undefined;
+			double dominance = 0.0;
+			EnabledEmotions::forEach([&](EmotionType type) {
+				double relative = stored.intensities[type] - stored.baselines[type];
+				if (relative > dominance) {
+					dominance = relative;
+					dominant = type;
+				}
+			});
+			if (dominant != exact.dominantEmotion)
+				report.dominantMismatches++;
+		}
+		if (moods > 0)
+			report.rmsMoodError = std::sqrt(moodSquares / moods);
+		if (levels > 0) {
+			report.rmsIntensityError = std::sqrt(intensitySquares / levels);
+			report.rmsBaselineError = std::sqrt(baselineSquares / levels);
+		}
+		return report;
+	}
+};
+
+template<class Level>
+constexpr float CrowdAffectStore<Level>::sMOODSTEP;
+template<class Level>
+constexpr float CrowdAffectStore<Level>::sLEVELSTEP;
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+* The class <code>MappedFile</code> maps a whole file read-only into memory, so
+* large files can be parsed in place without copying them through a stream.
+* A file that does not exist or is empty yields an empty range.
+*
+* @version 1.0
+*/
+class MappedFile {
+	const char* fData = nullptr;
+	size_t fSize = 0;
+#ifdef _WIN32
+	HANDLE fFile = INVALID_HANDLE_VALUE;
+	HANDLE fMapping = nullptr;
+#else
+	int fFile = -1;
+#endif
+
+public:
+	/**
+	* Maps the specified file.
+	*
+	* @param path the file name
+	*/
+	explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+		fFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fFile == INVALID_HANDLE_VALUE)
+			return;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(fFile, &size) || (size.QuadPart == 0))
+			return;
+		fMapping = CreateFileMappingA(fFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (fMapping == nullptr)
+			return;
+		fData = static_cast<const char*>(MapViewOfFile(fMapping, FILE_MAP_READ, 0, 0, 0));
+		if (fData != nullptr)
+			fSize = static_cast<size_t>(size.QuadPart);
+#else
+		fFile = open(path.c_str(), O_RDONLY);
+		if (fFile < 0)
+			return;
+		struct stat status;
+		if ((fstat(fFile, &status) != 0) || (status.st_size == 0))
+			return;
+		void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fFile, 0);
+		if (data == MAP_FAILED)
+			return;
+		fData = static_cast<const char*>(data);
+		fSize = static_cast<size_t>(status.st_size);
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() {
+#ifdef _WIN32
+		if (fData != nullptr)
+			UnmapViewOfFile(fData);
+		if (fMapping != nullptr)
+			CloseHandle(fMapping);
+		if (fFile != INVALID_HANDLE_VALUE)
+			CloseHandle(fFile);
+#else
+		if (fData != nullptr)
+			munmap(const_cast<char*>(fData), fSize);
+		if (fFile >= 0)
+			close(fFile);
+#endif
+	}
+
+	const char* data() const {
+		return fData;
+	}
+
+	size_t size() const {
+		return fSize;
+	}
+};
@@ -0,0 +1,480 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+* The class <code>TelemetryRecord</code> is one fixed-size entry of the
+* simulation log: either a mood sample written after an emotion event or a
+* recalled memory. A text longer than its field keeps a prefix in the field
+* and its full value in the overflow slot of <code>Telemetry</code>, which
+* the writer thread takes it from. A record with such a text must be
+* submitted; copies submitted after it only carry the prefix.
+*
+* @version 1.1
+*/
+struct TelemetryRecord {
+	enum Kind : std::uint8_t { MoodSample = 0, MemoryRecall };
+	/** the text fields */
+	enum Text : std::uint8_t { Label = 0, MoodText, Detail };
+	static const size_t sTEXTS = 3;
+
+	std::uint8_t kind = MoodSample;
+	std::uint16_t channel = 0;
+	/** milliseconds since the epoch */
+	std::int64_t time = 0;
+	/**
+	* MoodSample: pleasure, arousal, dominance, emotions center p, a, d
+	* MemoryRecall: intensity
+	*/
+	double values[6] = {};
+	/** MoodSample: the player's choice, MemoryRecall: the memory name */
+	char label[32] = {};
+	/** MoodSample: mood word, MemoryRecall: emotion */
+	char mood[24] = {};
+	/** MoodSample: mood word intensity, MemoryRecall: reaction */
+	char detail[24] = {};
+	/** per text the overflow slot holding its full value, 0 if it fits its field */
+	std::uint32_t overflow[sTEXTS] = {};
+
+	char* field(Text text, size_t& size) {
+		switch (text) {
+		case Label: size = sizeof(label); return label;
+		case MoodText: size = sizeof(mood); return mood;
+		default: size = sizeof(detail); return detail;
+		}
+	}
+
+	const char* getText(Text text) const {
+		switch (text) {
+		case Label: return label;
+		case MoodText: return mood;
+		default: return detail;
+		}
+	}
+
+	void setText(Text text, const std::string& value);
+
+	void setLabel(const std::string& text) { setText(Label, text); }
+	void setMood(const std::string& text) { setText(MoodText, text); }
+	void setDetail(const std::string& text) { setText(Detail, text); }
+};
+
+static_assert(std::is_trivially_copyable<TelemetryRecord>::value, "TelemetryRecord must be trivially copyable");
+
+/**
+* Destination of telemetry records. Sinks are only called from the writer
+* thread.
+*/
+class TelemetrySink {
+public:
+	virtual ~TelemetrySink() {}
+
+	/**
+	* @param record the record
+	* @param texts the full values of the text fields, indexed by
+	* <code>TelemetryRecord::Text</code>
+	*/
+	virtual void write(const TelemetryRecord& record, const char* const* texts) = 0;
+
+	virtual void flush() = 0;
+};
+
+/**
+* Writes records as CSV rows with the columns of the former per-event logs.
+*/
+class CsvTelemetrySink : public TelemetrySink {
+	static const size_t sBUFFERSIZE = 64 * 1024;
+	std::unique_ptr<char[]> fBuffer;
+	std::ofstream fOut;
+
+public:
+	CsvTelemetrySink(const std::string& path, bool append) : fBuffer(new char[sBUFFERSIZE]) {
+		fOut.rdbuf()->pubsetbuf(fBuffer.get(), sBUFFERSIZE);
+		fOut.open(path, append ? (std::ios::out | std::ios::app) : std::ios::out);
+	}
+
+	void write(const TelemetryRecord& record, const char* const* texts) {
+		const char* label = texts[TelemetryRecord::Label];
+		const char* mood = texts[TelemetryRecord::MoodText];
+		const char* detail = texts[TelemetryRecord::Detail];
+		if (record.kind == TelemetryRecord::MoodSample) {
+			fOut << label << "," << record.values[0] << "," << record.values[1] << ","
+				<< record.values[2] << "," << mood << "," << detail << ","
+				<< record.values[3] << "," << record.values[4] << "," << record.values[5] << "\n";
+		}
+		else {
+			fOut << label << "," << mood << "," << record.values[0] << ",," << detail << ",\n";
+		}
+	}
+
+	void flush() {
+		fOut.flush();
+	}
+};
+
+/**
+* Writes the raw records. A new file starts with the magic "ALMT", a version
+* and the record size. A record with overflowing texts is followed by the
+* full value of each of them, in field order, as a 32 bit length and the
+* bytes.
+*/
+class BinaryTelemetrySink : public TelemetrySink {
+	static const size_t sBUFFERSIZE = 64 * 1024;
+	std::unique_ptr<char[]> fBuffer;
+	std::ofstream fOut;
+
+public:
+	BinaryTelemetrySink(const std::string& path, bool append) : fBuffer(new char[sBUFFERSIZE]) {
+		fOut.rdbuf()->pubsetbuf(fBuffer.get(), sBUFFERSIZE);
+		fOut.open(path, std::ios::binary | (append ? (std::ios::out | std::ios::app) : std::ios::out));
+		fOut.seekp(0, std::ios::end);
+		if (fOut.tellp() == std::streampos(0)) {
+			std::uint32_t header[3] = { 0x544D4C41, 2, static_cast<std::uint32_t>(sizeof(TelemetryRecord)) };
+			fOut.write(reinterpret_cast<const char*>(header), sizeof(header));
+		}
+	}
+
+	void write(const TelemetryRecord& record, const char* const* texts) {
+		fOut.write(reinterpret_cast<const char*>(&record), sizeof(TelemetryRecord));
+		for (size_t i = 0; i < TelemetryRecord::sTEXTS; i++) {
+			if (record.overflow[i] == 0)
+				continue;
+			std::uint32_t length = static_cast<std::uint32_t>(std::strlen(texts[i]));
+			fOut.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			fOut.write(texts[i], length);
+		}
+	}
+
+	void flush() {
+		fOut.flush();
+	}
+};
+
+/**
+* Bounded lock-free queue for telemetry records (after D. Vyukov). Any
+* number of threads may push; records are popped by the writer thread only.
+*/
+class TelemetryRingBuffer {
+	struct Cell {
+		std::atomic<size_t> sequence;
+		TelemetryRecord record;
+	};
+
+	std::unique_ptr<Cell[]> fCells;
+	size_t fMask;
+	alignas(64) std::atomic<size_t> fEnqueuePos{ 0 };
+	alignas(64) std::atomic<size_t> fDequeuePos{ 0 };
+
+public:
+	/**
+	* @param capacity number of records, must be a power of two
+	*/
+	explicit TelemetryRingBuffer(size_t capacity) : fCells(new Cell[capacity]), fMask(capacity - 1) {
+		if ((capacity < 2) || ((capacity & (capacity - 1)) != 0))
+			throw std::invalid_argument("Telemetry buffer capacity must be a power of two");
+		for (size_t i = 0; i < capacity; i++)
+			fCells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/**
+	* @return false if the buffer is full
+	*/
+	bool tryPush(const TelemetryRecord& record) {
+		size_t pos = fEnqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = fCells[pos & fMask];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+			if (diff == 0) {
+				if (fEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.record = record;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = fEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	* @return false if the buffer is empty
+	*/
+	bool tryPop(TelemetryRecord& record) {
+		size_t pos = fDequeuePos.load(std::memory_order_relaxed);
+		Cell& cell = fCells[pos & fMask];
+		size_t seq = cell.sequence.load(std::memory_order_acquire);
+		if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0)
+			return false;
+		fDequeuePos.store(pos + 1, std::memory_order_relaxed);
+		record = cell.record;
+		cell.sequence.store(pos + fMask + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+/**
+* The class <code>Telemetry</code> collects mood and memory records from any
+* thread and writes them to disk on a background thread.
+* <br>
+* <code>submit</code> copies the record into a lock-free ring buffer and
+* returns; it only waits if the buffer is full. The writer thread drains the
+* buffer in batches into the sinks, which buffer their output, and flushes
+* the sinks whenever the buffer runs empty. Each output file is one channel;
+* the sink type is chosen by the file extension (".bin" binary, otherwise
+* CSV) and a "{run}" in the file name is replaced by the run name.
+* All records are written when the process exits or <code>flush</code>
+* returns.
+* <br>
+* Texts longer than their record field are kept in an overflow slot until
+* the writer thread writes their record, so no text is truncated. Only
+* these texts take a lock.
+*
+* @version 1.0
+*/
+class Telemetry {
+	static const size_t sCAPACITY = 8192;
+	static const size_t sBATCHSIZE = 256;
+
+	std::mutex _mutex;
+	TelemetryRingBuffer fBuffer{ sCAPACITY };
+	std::vector<std::unique_ptr<TelemetrySink>> fSinks;
+	std::unordered_map<std::string, int> fChannels;
+	std::string fRunName;
+	std::atomic<bool> fRunning{ true };
+	std::atomic<std::uint64_t> fSubmitted{ 0 };
+	std::atomic<std::uint64_t> fWritten{ 0 };
+	std::atomic<std::uint64_t> fStalls{ 0 };
+	std::mutex fOverflowMutex;
+	std::unordered_map<std::uint32_t, std::string> fOverflow;
+	std::uint32_t fNextOverflow = 1;
+	std::atomic<std::uint64_t> fOverflows{ 0 };
+	std::thread fWriter;
+
+	Telemetry() {
+		char name[32];
+		std::time_t now = std::time(nullptr);
+		std::tm local;
+#ifdef _WIN32
+		localtime_s(&local, &now);
+#else
+		localtime_r(&now, &local);
+#endif
+		std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S", &local);
+		fRunName = name;
+		fWriter = std::thread([this]() { writeLoop(); });
+	}
+
+	void writeLoop() {
+		std::vector<TelemetryRecord> batch;
+		batch.reserve(sBATCHSIZE);
+		bool dirty = false;
+		for (;;) {
+			TelemetryRecord record;
+			while ((batch.size() < sBATCHSIZE) && fBuffer.tryPop(record))
+				batch.push_back(record);
+			if (!batch.empty()) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (const TelemetryRecord& r : batch) {
+					std::string overflow[TelemetryRecord::sTEXTS];
+					const char* texts[TelemetryRecord::sTEXTS];
+					for (size_t i = 0; i < TelemetryRecord::sTEXTS; i++) {
+						TelemetryRecord::Text text = static_cast<TelemetryRecord::Text>(i);
+						texts[i] = (r.overflow[i] != 0) && takeOverflow(r.overflow[i], overflow[i])
+							? overflow[i].c_str() : r.getText(text);
+					}
+					if (r.channel < fSinks.size())
+						fSinks[r.channel]->write(r, texts);
+				}
+				fWritten.fetch_add(batch.size(), std::memory_order_release);
+				batch.clear();
+				dirty = true;
+				continue;
+			}
+			if (dirty) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (auto& sink : fSinks)
+					sink->flush();
+				dirty = false;
+			}
+			if (!fRunning.load(std::memory_order_acquire) &&
+				(fWritten.load(std::memory_order_acquire) == fSubmitted.load(std::memory_order_acquire)))
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+
+public:
+	Telemetry(const Telemetry&) = delete;
+	Telemetry& operator=(const Telemetry&) = delete;
+
+	~Telemetry() {
+		fRunning.store(false, std::memory_order_release);
+		if (fWriter.joinable())
+			fWriter.join();
+	}
+
+	static Telemetry& getInstance() {
+		static Telemetry instance;
+		return instance;
+	}
+
+	/**
+	* Sets the name that replaces "{run}" in file names of channels opened
+	* afterwards. Defaults to the start time of the process.
+	*/
+	void setRunName(const std::string& name) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		fRunName = name;
+	}
+
+	std::string getRunName() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return fRunName;
+	}
+
+	/**
+	* Returns the channel writing to the specified file, opening it on first
+	* use. All callers using the same file share one channel.
+	*
+	* @param path file name, may contain "{run}"
+	* @param append false truncates the file when it is opened
+	* @return the channel id for <code>submit</code>
+	*/
+	int openChannel(std::string path, bool append = true) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_t token = path.find("{run}");
+		if (token != std::string::npos)
+			path.replace(token, 5, fRunName);
+		auto it = fChannels.find(path);
+		if (it != fChannels.end())
+			return it->second;
+		bool binary = (path.size() >= 4) && (path.compare(path.size() - 4, 4, ".bin") == 0);
+		if (binary)
+			fSinks.emplace_back(new BinaryTelemetrySink(path, append));
+		else
+			fSinks.emplace_back(new CsvTelemetrySink(path, append));
+		int channel = static_cast<int>(fSinks.size()) - 1;
+		fChannels.emplace(path, channel);
+		return channel;
+	}
+
+	/**
+	* Queues a record for the specified channel. Never performs I/O.
+	*
+	* @param channel a channel returned by <code>openChannel</code>
+	* @param record the record
+	*/
+	void submit(int channel, TelemetryRecord record) {
+		record.channel = static_cast<std::uint16_t>(channel);
+		if (record.time == 0)
+			record.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		fSubmitted.fetch_add(1, std::memory_order_relaxed);
+		if (fBuffer.tryPush(record))
+			return;
+		fStalls.fetch_add(1, std::memory_order_relaxed);
+		while (!fBuffer.tryPush(record))
+			std::this_thread::yield();
+	}
+
+	/**
+	* Blocks until all records submitted so far are on disk.
+	*/
+	void flush() {
+		std::uint64_t target = fSubmitted.load(std::memory_order_acquire);
+		while (fWritten.load(std::memory_order_acquire) < target)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& sink : fSinks)
+			sink->flush();
+	}
+
+	/**
+	* Returns how often <code>submit</code> had to wait for a full buffer.
+	*/
+	std::uint64_t getStalls() const {
+		return fStalls.load(std::memory_order_relaxed);
+	}
+
+	/**
+	* Keeps the full value of a text that does not fit its record field.
+	*
+	* @param text the text
+	* @param previous the slot the field used before, 0 for none; it is
+	* released
+	* @return the overflow slot
+	*/
+	std::uint32_t storeOverflow(const std::string& text, std::uint32_t previous) {
+		std::lock_guard<std::mutex> lock(fOverflowMutex);
+		if (previous != 0)
+			fOverflow.erase(previous);
+		std::uint32_t slot = fNextOverflow++;
+		if (fNextOverflow == 0)
+			fNextOverflow = 1;
+		fOverflow[slot] = text;
+		fOverflows.fetch_add(1, std::memory_order_relaxed);
+		return slot;
+	}
+
+	/**
+	* Releases an overflow slot that is no longer used.
+	*/
+	void releaseOverflow(std::uint32_t slot) {
+		std::lock_guard<std::mutex> lock(fOverflowMutex);
+		fOverflow.erase(slot);
+	}
+
+	/**
+	* Moves the text out of an overflow slot and releases the slot.
+	*
+	* @return false if the slot holds no text
+	*/
+	bool takeOverflow(std::uint32_t slot, std::string& text) {
+		std::lock_guard<std::mutex> lock(fOverflowMutex);
+		auto it = fOverflow.find(slot);
+		if (it == fOverflow.end())
+			return false;
+		text = std::move(it->second);
+		fOverflow.erase(it);
+		return true;
+	}
+
+	/**
+	* Returns how many texts did not fit their record field and were written
+	* through the overflow slot.
+	*/
+	std::uint64_t getOverflows() const {
+		return fOverflows.load(std::memory_order_relaxed);
+	}
+};
+
+inline void TelemetryRecord::setText(Text text, const std::string& value) {
+	size_t size;
+	char* target = field(text, size);
+	size_t length = (value.size() < size - 1) ? value.size() : size - 1;
+	std::memcpy(target, value.data(), length);
+	target[length] = '\0';
+	if (value.size() > length)
+		overflow[text] = Telemetry::getInstance().storeOverflow(value, overflow[text]);
+	else if (overflow[text] != 0) {
+		Telemetry::getInstance().releaseOverflow(overflow[text]);
+		overflow[text] = 0;
+	}
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+class Emotion;
+
+/**
+* The class <code>ElicitorRegistry</code> interns emotion-inducing situations
+* to small integer ids. Equal situations get the same id, so elicitors are
+* compared and hashed by their id instead of by value. Situations are named by
+* a string, by the traits of a personality or by an emotion; emotions are
+* compared by identity and get a new id each.
+* <br>
+* The registry keeps the single payload of every elicitor, so emotions only
+* carry the id. The payload of an emotion elicitor is a copy owned by the
+* registry, the emotion itself may live in a character's arena.
+* <br>
+* Ids are only valid within one process and are never reused. 0 means no
+* elicitor.
+*
+* @version 1.1
+*/
+class ElicitorRegistry
+{
+public:
+	/** the kind of an elicitor, the values are stored in checkpoints */
+	enum class Type : std::uint8_t
+	{
+		Unknown,
+		String,
+		Emotion,
+		Personality
+	};
+
+	/**
+	* The payload of an elicitor. Only the field of its type is set.
+	*/
+	struct Entry
+	{
+		Type type = Type::Unknown;
+		std::string name;
+		std::shared_ptr<const Emotion> emotion;
+		std::array<double, 5> traits = { { 0.0, 0.0, 0.0, 0.0, 0.0 } };
+	};
+
+	/** the id of no elicitor */
+	static const std::uint32_t sNONE = 0;
+
+private:
+	mutable std::mutex fMutex;
+	std::unordered_map<std::string, std::uint32_t> fStrings;
+	std::map<std::array<double, 5>, std::uint32_t> fPersonalities;
+	/** the payloads, id 1 first */
+	std::deque<Entry> fEntries;
+
+	ElicitorRegistry() {}
+
+	std::uint32_t add(Entry entry)
+	{
+		fEntries.push_back(std::move(entry));
+		return static_cast<std::uint32_t>(fEntries.size());
+	}
+
+	size_t indexOf(std::uint32_t id) const
+	{
+		if ((id == sNONE) || (id > fEntries.size()))
+			throw std::invalid_argument("Unknown elicitor id " + std::to_string(id));
+		return id - 1;
+	}
+
+public:
+	ElicitorRegistry(const ElicitorRegistry&) = delete;
+	ElicitorRegistry& operator=(const ElicitorRegistry&) = delete;
+
+	static ElicitorRegistry& getInstance()
+	{
+		static ElicitorRegistry instance;
+		return instance;
+	}
+
+	/**
+	* Returns the id of a situation named by a string, interning it on first
+	* use.
+	*/
+	std::uint32_t intern(const std::string& situation)
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+		auto it = fStrings.find(situation);
+		if (it != fStrings.end())
+			return it->second;
+		Entry entry;
+		entry.type = Type::String;
+		entry.name = situation;
+		return fStrings[situation] = add(std::move(entry));
+	}
+
+	/**
+	* Returns the id of a personality, interning its traits on first use.
+	*
+	* @param traits openness, conscientiousness, extraversion, agreeableness
+	* and neurotism
+	*/
+	std::uint32_t intern(const double traits[5])
+	{
+		std::array<double, 5> key = { { traits[0], traits[1], traits[2], traits[3], traits[4] } };
+		std::unique_lock<std::mutex> lock(fMutex);
+		auto it = fPersonalities.find(key);
+		if (it != fPersonalities.end())
+			return it->second;
+		Entry entry;
+		entry.type = Type::Personality;
+		entry.traits = key;
+		return fPersonalities[key] = add(std::move(entry));
+	}
+
+	/**
+	* Returns a new id for an emotion elicitor that is equal to no other.
+	*
+	* @param emotion the registry's copy of the eliciting emotion, may be set
+	* later with <code>setEmotion</code>
+	*/
+	std::uint32_t create(std::shared_ptr<const Emotion> emotion = nullptr)
+	{
+		Entry entry;
+		entry.type = Type::Emotion;
+		entry.emotion = std::move(emotion);
+		std::unique_lock<std::mutex> lock(fMutex);
+		return add(std::move(entry));
+	}
+
+	/**
+	* Sets the eliciting emotion of an emotion elicitor.
+	*
+	* @throws std::invalid_argument if the id is no emotion elicitor
+	*/
+	void setEmotion(std::uint32_t id, std::shared_ptr<const Emotion> emotion)
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+		Entry& entry = fEntries[indexOf(id)];
+		if (entry.type != Type::Emotion)
+			throw std::invalid_argument("Elicitor " + std::to_string(id) + " is no emotion");
+		entry.emotion = std::move(emotion);
+	}
+
+	/**
+	* Returns a copy of the payload of an elicitor, an empty entry for
+	* <code>sNONE</code>.
+	*
+	* @throws std::invalid_argument if the id was never handed out
+	*/
+	Entry get(std::uint32_t id) const
+	{
+		if (id == sNONE)
+			return Entry();
+		std::unique_lock<std::mutex> lock(fMutex);
+		return fEntries[indexOf(id)];
+	}
+
+	/**
+	* Returns the name of a situation elicitor, an empty string for any other
+	* elicitor.
+	*/
+	std::string getName(std::uint32_t id) const
+	{
+		if (id == sNONE)
+			return std::string();
+		std::unique_lock<std::mutex> lock(fMutex);
+		const Entry& entry = fEntries[indexOf(id)];
+		return (entry.type == Type::String) ? entry.name : std::string();
+	}
+};
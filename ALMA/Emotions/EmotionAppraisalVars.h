@@ -1,15 +1,19 @@
 #pragma once
 #include <functional>
+/**
+* The appraisal variables an emotion was elicited with. The degrees are kept
+* in single precision, every emotion carries a copy.
+*/
 class EmotionAppraisalVars {
 
 public:
-	double desirability = 0.0;
-	double praiseworthy = 0.0;
-	double appealingness = 0.0;
-	double likelihood = 0.0;
-	bool realization = 0.0;
-	double liking = 0.0;
-	bool agency = 0.0;
+	float desirability = 0.0f;
+	float praiseworthy = 0.0f;
+	float appealingness = 0.0f;
+	float likelihood = 0.0f;
+	float liking = 0.0f;
+	bool realization = false;
+	bool agency = false;
 
 	EmotionAppraisalVars() {
 	}
@@ -3,25 +3,215 @@
 #include<vector>
 #include"EmotionVector.h"
 #include<mutex>
+#include<cstdint>
+#include<deque>
+#include<stdexcept>
+#include<algorithm>
+#include<unordered_map>
+#include<utility>
+#include<limits>
+/**
+* The class <code>EmotionHistory</code> keeps the emotion vectors of the last
+* inferences of a character in a ring buffer of fixed length. Adding to a
+* full history drops the oldest vector. The vectors are deltas that only
+* hold the emotions an event changed.
+* <br>
+* For every emotion type the history keeps the positions of the vectors that
+* can still hold the strongest emotion of that type, strongest first, as a
+* monotonic deque. A vector is only kept while no later vector has an emotion
+* of that type at least as intense, so the front is the latest of the most
+* intense emotions and the emotional state is read without walking the
+* history. Emotions of stored vectors must only be changed through
+* <code>replace</code> or <code>removeEmotionByElicitor</code>, which update
+* the deque in place: a stronger emotion drops the weaker candidates before
+* it, a weaker one only rescans the vectors between it and the previous
+* candidate. Decaying emotions therefore never rebuild a whole deque; only
+* <code>remove</code>, which moves the sequence numbers, marks all types
+* stale so their deques are rebuilt when they are read next.
+* <br>
+* The history also indexes its emotions by elicitor: for every pair of
+* elicitor id and emotion type it keeps the sequence numbers of the vectors
+* holding such an emotion, so the emotions of an elicitor are found without
+* a scan.
+*/
 class EmotionHistory {
+public:
+	/** the default number of emotion vectors kept */
+	static const size_t sDEFAULTLENGTH = 64;
 
 private:
-	std::vector<std::shared_ptr<EmotionVector>> history;
+	std::vector<std::shared_ptr<EmotionVector>> fRing;
+	/** the physical position of the oldest vector */
+	size_t fFirst = 0;
+	size_t fSize = 0;
+	/** the sequence number of the oldest vector, every added vector gets the next one */
+	std::uint64_t fFirstSequence = 0;
+	/** per enabled type the sequence numbers of the maximum candidates, strongest first */
+	std::deque<std::uint64_t> fMaxima[EnabledEmotions::sCOUNT];
+	/** bit <code>1 << type</code> is set for every type whose deque must be rebuilt */
+	std::uint32_t fStale = 0;
+	/** per elicitor and type the sequence numbers of the vectors holding such an emotion, oldest first */
+	std::unordered_map<std::uint64_t, std::vector<std::uint64_t>> fElicited;
 	// Logger log = Logger.getLogger(Logger.GLOBAL_LOGGER_NAME);
 
+	std::recursive_mutex _mutex;
+
+	const std::shared_ptr<EmotionVector>& at(size_t index) const {
+		return fRing[(fFirst + index) % fRing.size()];
+	}
+
+	const std::shared_ptr<Emotion>& emotionAt(std::uint64_t sequence, size_t type) const {
+		return at(static_cast<size_t>(sequence - fFirstSequence))->get(static_cast<Emotion::Type>(type));
+	}
+
+	std::deque<std::uint64_t>& maximaOf(size_t type) {
+		return fMaxima[EnabledEmotions::indexOf(static_cast<EmotionType>(type))];
+	}
+
+	/** the intensity of an emotion of the vector with that sequence number, -infinity if it has none */
+	double intensityAt(std::uint64_t sequence, size_t type) const {
+		const std::shared_ptr<Emotion>& emotion = emotionAt(sequence, type);
+		return (emotion == nullptr) ? -std::numeric_limits<double>::infinity() : emotion->getIntensity();
+	}
+
 	/**
-	* Constructs an empty history.
+	* Updates the deque of a type after the emotion of the vector with that
+	* sequence number changed from the specified intensity.
+	* <br>
+	* A candidate is more intense than every later emotion of its type, so the
+	* maximum after the changed vector is the next candidate. A stronger
+	* emotion becomes a candidate if it beats that maximum and drops the
+	* candidates before it it is at least as intense as. A weaker candidate
+	* uncovers the vectors between it and the previous candidate, only they
+	* are scanned again.
 	*/
-	std::recursive_mutex _mutex;
+	void update(size_t type, std::uint64_t sequence, double oldIntensity) {
+		if ((fStale & (1u << type)) != 0)
+			return;
+		std::deque<std::uint64_t>& maxima = maximaOf(type);
+		double intensity = intensityAt(sequence, type);
+		auto position = std::lower_bound(maxima.begin(), maxima.end(), sequence);
+		bool candidate = (position != maxima.end()) && (*position == sequence);
+		auto next = candidate ? position + 1 : position;
+		double later = (next == maxima.end()) ? -std::numeric_limits<double>::infinity() : intensityAt(*next, type);
+		if (intensity > oldIntensity) {
+			if (intensity <= later)
+				return;
+			if (!candidate)
+				position = maxima.insert(position, sequence);
+			auto first = position;
+			while ((first != maxima.begin()) && (intensityAt(*(first - 1), type) <= intensity))
+				--first;
+			maxima.erase(first, position);
+			return;
+		}
+		if (!candidate || (intensity == oldIntensity))
+			return;
+		std::uint64_t previous = (position == maxima.begin()) ? fFirstSequence : *(position - 1) + 1;
+		position = maxima.erase(position);
+		std::vector<std::uint64_t> uncovered;
+		for (std::uint64_t i = sequence + 1; i-- > previous;) {
+			double current = intensityAt(i, type);
+			if (current > later) {
+				uncovered.push_back(i);
+				later = current;
+			}
+		}
+		maxima.insert(position, uncovered.rbegin(), uncovered.rend());
+	}
+
+	/** appends the emotion of the vector with that sequence number to the deque of its type */
+	void push(size_t type, std::uint64_t sequence) {
+		const std::shared_ptr<Emotion>& emotion = emotionAt(sequence, type);
+		if (emotion == nullptr)
+			return;
+		std::deque<std::uint64_t>& maxima = maximaOf(type);
+		double intensity = emotion->getIntensity();
+		while (!maxima.empty() && (emotionAt(maxima.back(), type)->getIntensity() <= intensity))
+			maxima.pop_back();
+		maxima.push_back(sequence);
+	}
+
+	static std::uint64_t elicitedKey(std::uint32_t elicitor, size_t type) {
+		return (static_cast<std::uint64_t>(elicitor) << 8) | type;
+	}
+
+	void indexEmotion(std::uint64_t sequence, const std::shared_ptr<Emotion>& emotion) {
+		std::uint32_t elicitor = emotion->getElicitor();
+		if (elicitor == ElicitorRegistry::sNONE)
+			return;
+		std::vector<std::uint64_t>& sequences = fElicited[elicitedKey(elicitor, emotion->getType())];
+		sequences.insert(std::upper_bound(sequences.begin(), sequences.end(), sequence), sequence);
+	}
+
+	void unindexEmotion(std::uint64_t sequence, const std::shared_ptr<Emotion>& emotion) {
+		auto it = fElicited.find(elicitedKey(emotion->getElicitor(), emotion->getType()));
+		if (it == fElicited.end())
+			return;
+		std::vector<std::uint64_t>& sequences = it->second;
+		auto position = std::lower_bound(sequences.begin(), sequences.end(), sequence);
+		if ((position != sequences.end()) && (*position == sequence))
+			sequences.erase(position);
+		if (sequences.empty())
+			fElicited.erase(it);
+	}
+
+	void reindex() {
+		fElicited.clear();
+		for (size_t i = 0; i < fSize; i++) {
+			for (const std::shared_ptr<Emotion>& emotion : *at(i))
+				indexEmotion(fFirstSequence + i, emotion);
+		}
+	}
+
+	void rebuild(size_t type) {
+		maximaOf(type).clear();
+		for (size_t i = 0; i < fSize; i++)
+			push(type, fFirstSequence + i);
+		fStale &= ~(1u << type);
+	}
+
+	void dropFirst() {
+		EnabledEmotions::forEach([this](EmotionType type) {
+			std::deque<std::uint64_t>& maxima = maximaOf(type);
+			if (!maxima.empty() && (maxima.front() == fFirstSequence))
+				maxima.pop_front();
+		});
+		for (const std::shared_ptr<Emotion>& emotion : *fRing[fFirst])
+			unindexEmotion(fFirstSequence, emotion);
+		fRing[fFirst] = nullptr;
+		fFirst = (fFirst + 1) % fRing.size();
+		fSize--;
+		fFirstSequence++;
+	}
+
 public:
-	EmotionHistory() {
-		history = std::vector<std::shared_ptr<EmotionVector>>();
+	/**
+	* Constructs an empty history.
+	*
+	* @param length the maximal number of emotion vectors kept
+	* @throws std::invalid_argument if the length is not positive
+	*/
+	explicit EmotionHistory(size_t length = sDEFAULTLENGTH) {
+		if (length == 0)
+			throw std::invalid_argument("Emotion history length not positive.");
+		fRing.resize(length);
 	}
 
 	/**
 	* Removes all elements from the emotion history.
 
-	synchronized*/ void clear() { std::unique_lock<std::recursive_mutex> lock(_mutex); history.clear(); }
+	synchronized*/ void clear() {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		for (std::shared_ptr<EmotionVector>& emotions : fRing)
+			emotions = nullptr;
+		for (std::deque<std::uint64_t>& maxima : fMaxima)
+			maxima.clear();
+		fElicited.clear();
+		fFirst = 0;
+		fSize = 0;
+		fStale = 0;
+	}
 
 	/**
 	* Appends the specified element to the end of the history.
@@ -35,7 +225,17 @@ public:
 	//synchronized 
 	void add(std::shared_ptr<EmotionVector> emotions) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		history.push_back(emotions);
+		if (fSize == fRing.size())
+			dropFirst();
+		std::uint64_t sequence = fFirstSequence + fSize;
+		fRing[(fFirst + fSize) % fRing.size()] = std::move(emotions);
+		fSize++;
+		EnabledEmotions::forEach([this, sequence](EmotionType type) {
+			if ((fStale & (1u << type)) == 0)
+				push(type, sequence);
+		});
+		for (const std::shared_ptr<Emotion>& emotion : *at(fSize - 1))
+			indexEmotion(sequence, emotion);
 	}
 
 	/**
@@ -45,7 +245,12 @@ public:
 	*
 	*/
 	//synchronized
-	int size() { std::unique_lock<std::recursive_mutex> lock(_mutex); return history.size(); }
+	int size() { std::unique_lock<std::recursive_mutex> lock(_mutex); return static_cast<int>(fSize); }
+
+	/**
+	* Returns the maximal number of elements in this history.
+	*/
+	int length() const { return static_cast<int>(fRing.size()); }
 
 	/**
 	* Returns the element at the specified position in this history.
@@ -57,9 +262,64 @@ public:
 	*/
 	// synchronized 
 	std::shared_ptr<EmotionVector> get(int index) {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (index < 0 || index >= size())
-			throw std::invalid_argument("Index out of range: " + index);
-		return history.at(index);
+			throw std::invalid_argument("Index out of range: " + std::to_string(index));
+		return at(index);
+	}
+
+	/**
+	* Replaces the emotion of the same type in the element at the specified
+	* position in this history. An emotion that was changed in place, i.e.
+	* is the one the element already holds, can not be compared with its
+	* previous intensity; use <code>replace(index, emotion, oldIntensity)</code>
+	* for it, otherwise the maxima of its type are rebuilt on the next query.
+	*
+	* @param index index of the element
+	* @param emotion the new emotion
+	* @throws IndexOutOfBoundsException if index is out of range
+	*                                   (index < 0 || index >= size())
+	*/
+	void replace(int index, std::shared_ptr<Emotion> emotion) {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		if (index < 0 || index >= size())
+			throw std::invalid_argument("Index out of range: " + std::to_string(index));
+		Emotion::Type type = emotion->getType();
+		const std::shared_ptr<Emotion>& old = at(index)->get(type);
+		if ((old != nullptr) && (old == emotion)) {
+			fStale |= 1u << type;
+			return;
+		}
+		replace(index, std::move(emotion), (old == nullptr) ? -std::numeric_limits<double>::infinity() : old->getIntensity());
+	}
+
+	/**
+	* Replaces the emotion of the same type in the element at the specified
+	* position in this history, e.g. by the same emotion after it decayed in
+	* place.
+	*
+	* @param index index of the element
+	* @param emotion the new emotion
+	* @param oldIntensity the intensity of the replaced emotion before it
+	* changed
+	* @throws IndexOutOfBoundsException if index is out of range
+	*                                   (index < 0 || index >= size())
+	*/
+	void replace(int index, std::shared_ptr<Emotion> emotion, double oldIntensity) {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		if (index < 0 || index >= size())
+			throw std::invalid_argument("Index out of range: " + std::to_string(index));
+		Emotion::Type type = emotion->getType();
+		std::uint64_t sequence = fFirstSequence + index;
+		std::shared_ptr<Emotion> old = at(index)->get(type);
+		if (!at(index)->add(emotion))
+			return;
+		update(type, sequence, oldIntensity);
+		if ((old == nullptr) || (old->getElicitor() != emotion->getElicitor())) {
+			if (old != nullptr)
+				unindexEmotion(sequence, old);
+			indexEmotion(sequence, emotion);
+		}
 	}
 
 	/**
@@ -75,8 +335,14 @@ public:
 	void remove(int index) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (index < 0 || index >= size())
-			throw std::invalid_argument("Index out of range: " + index);
-		history.erase(history.begin() + index - 1);
+			throw std::invalid_argument("Index out of range: " + std::to_string(index));
+		for (size_t i = index; i + 1 < fSize; i++)
+			fRing[(fFirst + i) % fRing.size()] = at(i + 1);
+		fRing[(fFirst + fSize - 1) % fRing.size()] = nullptr;
+		fSize--;
+		// the sequence numbers behind the removed element moved
+		fStale = (1u << EmotionVector::sSLOTS) - 1;
+		reindex();
 	}
 
 	/**
@@ -87,16 +353,15 @@ public:
 	bool removeFirstIfInactive() {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (size() > 0) {
-			std::shared_ptr<EmotionVector> firstEmotionVector = history.front();
 			bool remove = true;
-			for (std::shared_ptr<Emotion> emotion : firstEmotionVector->getEmotions())
+			for (const std::shared_ptr<Emotion>& emotion : *at(0))
 			{
 				if (emotion->getIntensity() > emotion->getBaseline()) {
 					remove = false;
 				}
 			}
 			if (remove) {
-				history.erase(history.begin());
+				dropFirst();
 				return true;
 			}
 			else {
@@ -109,75 +374,87 @@ public:
 	}
 
 	/**
-	* Returns the emotion that has the queried elicitor or null. The first
-	* occurence of an emotion whoses elicitor matches the queried elicitor
+	* Returns the emotion that has the queried elicitor or null. The latest
+	* emotion of that type whose elicitor matches the queried elicitor
 	* will be returend.
 	*
 	* @param queryEmotionType type of emotion
-	*        queryElicitor the elicitor of an emotion
+	* @param elicitor the elicitor id of an emotion
 	*
 	* @return emotion or null
 	*/
 	// synchronized 
-	bool getEmotionByElicitor(Emotion::Type queryEmotionType,
-		std::shared_ptr<Emotion> queryElicitor, std::shared_ptr<Emotion> emotion) {
+	std::shared_ptr<Emotion> getEmotionByElicitor(Emotion::Type queryEmotionType,
+		std::uint32_t elicitor) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		if (size() == 0) return false;
-		for (int i = size() - 1; i >= 0; i--) {
-			std::shared_ptr<EmotionVector> emotions = get(i);
-			for (std::shared_ptr<Emotion> histEmotion : emotions->getEmotions()) {
-				//debug log.info("History emotion " + histEmotion.getType() + " has " + histEmotion.getElicitor().toString() + " elicitor context queried has " + queryElicitor.toString());
-				if ((histEmotion->getType() == queryEmotionType) &&
-					queryElicitor->operator== (histEmotion->getElicitor()->Emo))
-				{
-					if (emotion == nullptr)
-					{
-						emotion = histEmotion;
-						return true;
-					}
-				}
-			}
-		}
-		return false;
+		if (elicitor == ElicitorRegistry::sNONE)
+			return nullptr;
+		auto it = fElicited.find(elicitedKey(elicitor, queryEmotionType));
+		if (it == fElicited.end())
+			return nullptr;
+		return emotionAt(it->second.back(), queryEmotionType);
 	}
 
-	std::shared_ptr<Emotion> getEmotionByElicitor(Emotion::Type queryEmotionType,
-		std::shared_ptr<Emotion> queryElicitor) {
+	/**
+	* Returns the emotions of the specified types that have the queried
+	* elicitor together with the index of their history element, latest
+	* element first and in type order within an element.
+	*
+	* @param elicitor the elicitor id of an emotion
+	* @param types the emotion types, one bit <code>1 << type</code> per type
+	* @return pairs of history index and emotion
+	*/
+	std::vector<std::pair<int, std::shared_ptr<Emotion>>> getEmotionsByElicitor(
+		std::uint32_t elicitor, std::uint32_t types) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		if (size() == 0) return false;
-		for (int i = size() - 1; i >= 0; i--) {
-			std::shared_ptr<EmotionVector> emotions = get(i);
-			for (std::shared_ptr<Emotion> histEmotion : emotions->getEmotions()) {
-				//debug log.info("History emotion " + histEmotion.getType() + " has " + histEmotion.getElicitor().toString() + " elicitor context queried has " + queryElicitor.toString());
-				if ((histEmotion->getType() == queryEmotionType) &&
-					queryElicitor == (histEmotion->getElicitor()->Emo))
-				{
-					return histEmotion;
-				}
-			}
+		std::vector<std::pair<int, std::shared_ptr<Emotion>>> result;
+		if (elicitor == ElicitorRegistry::sNONE)
+			return result;
+		// (sequence, type) pairs, ordered latest first below
+		std::vector<std::pair<std::uint64_t, size_t>> found;
+		for (size_t type = 0; type < EmotionVector::sSLOTS; type++) {
+			if ((types & (1u << type)) == 0)
+				continue;
+			auto it = fElicited.find(elicitedKey(elicitor, type));
+			if (it == fElicited.end())
+				continue;
+			for (std::uint64_t sequence : it->second)
+				found.emplace_back(sequence, type);
 		}
-		return nullptr;
+		std::sort(found.begin(), found.end(),
+			[](const std::pair<std::uint64_t, size_t>& a, const std::pair<std::uint64_t, size_t>& b) {
+			return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+		});
+		result.reserve(found.size());
+		for (const auto& entry : found)
+			result.emplace_back(static_cast<int>(entry.first - fFirstSequence), emotionAt(entry.first, entry.second));
+		return result;
 	}
 
 	/**
 	* Removes the emotion that has the queried elicitor or null.
 	*
 	* @param queryEmotion emotion
-	*        queryElicitor the elicitor of an emotion
+	*        elicitor the elicitor id of an emotion
 	*/
 	// synchronized
 	void removeEmotionByElicitor( std::shared_ptr<Emotion> queryEmotion,
-		std::shared_ptr<Emotion::Elicit> queryElicitor) {
+		std::uint32_t elicitor) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		if (size() == 0) return;
-		for (int i = size() - 1; i >= 0; i--) {
-			std::shared_ptr<EmotionVector> emotions = get(i);
-			for (std::shared_ptr<Emotion> histEmotion : emotions->getEmotions()) {
-				if ((histEmotion == queryEmotion) &&
-					(queryElicitor->operator==(histEmotion->getElicitor()))) {
-					// log.fine("History emotion " + histEmotion + " has " + histEmotion.getElicitor().toString() + " will be removed");
-					emotions->remove(queryEmotion->getType());
-				}
+		if ((queryEmotion == nullptr) || (elicitor == ElicitorRegistry::sNONE))
+			return;
+		Emotion::Type type = queryEmotion->getType();
+		auto it = fElicited.find(elicitedKey(elicitor, type));
+		if (it == fElicited.end())
+			return;
+		// a copy, removing the emotions changes the index
+		std::vector<std::uint64_t> sequences = it->second;
+		for (std::uint64_t sequence : sequences) {
+			if (emotionAt(sequence, type) == queryEmotion) {
+				// log.fine("History emotion " + histEmotion + " has " + histEmotion.getElicitor().toString() + " will be removed");
+				unindexEmotion(sequence, queryEmotion);
+				at(static_cast<size_t>(sequence - fFirstSequence))->remove(type);
+				update(type, sequence, queryEmotion->getIntensity());
 			}
 		}
 	}
@@ -193,34 +470,41 @@ public:
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (size() == 0)
 			throw std::runtime_error("Empty EmotionVector");
-		const size_t lastIndex = size() - 1;
-		
-		return history.at(lastIndex);
+		return at(fSize - 1);
 	}
 
 	/**
 	* Returns the emotional state of an agent by collecting the emotions
 	* with the highest intensity for each type in the history and by adding
 	* them to the specified collection.
+	* <br>
+	* The history holds deltas, so a type the history has no emotion of keeps
+	* the emotion of the collection. If that emotion is still active it left
+	* the history before it decayed and is replaced by its baseline.
 	*
 	* @param emotions the collection used to store the emotional state
-	* @return the new emotional state or the unmodified collection
-	*         if the history is empty (size() == 0).
+	* @return the new emotional state
 	*/
 	// synchronized 
 	std::shared_ptr<EmotionVector> getEmotionalState(std::shared_ptr<EmotionVector>& emotions) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		if (size() == 0) return emotions;
-		for (const Emotion::Type type : emotions->getEmotionTypes()) {
-			double max = 0.0;
-			// traverse history in reverse order, latest element first
-			for (int i = size() - 1; i >= 0; i--) {
-				std::shared_ptr<Emotion> e = get(i)->get(type);
-				if (e != nullptr && e->getIntensity() > max) {
-					max = e->getIntensity();
-					emotions->add(std::move(e));
-				}
+		for (size_t type = 0; type < EmotionVector::sSLOTS; type++) {
+			Emotion::Type emotionType = static_cast<Emotion::Type>(type);
+			if (!emotions->hasType(emotionType))
+				continue;
+			if ((fStale & (1u << type)) != 0)
+				rebuild(type);
+			if (maximaOf(type).empty()) {
+				const std::shared_ptr<Emotion>& current = emotions->get(emotionType);
+				if ((current != nullptr) && (current->getIntensity() > current->getBaseline()))
+					emotions->add(std::make_shared<Emotion>(emotionType, current->getBaseline(), current->getBaseline(),
+						current->getElicitor()));
+				continue;
 			}
+			// the latest of the most intense emotions of this type
+			const std::shared_ptr<Emotion>& e = emotionAt(maximaOf(type).front(), type);
+			if (e->getIntensity() > 0.0)
+				emotions->add(e);
 		}
 		return emotions;
 	}
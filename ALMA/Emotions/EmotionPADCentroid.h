@@ -44,6 +44,21 @@ public:
 		return fWeight;
 	}
 
+	 int getEmotionCount() {
+		return fEmotionCnt;
+	}
+
+	/**
+	* Sets all values at once, used to restore a checkpointed centroid.
+	*/
+	 void restore(double pValue, double aValue, double dValue, double weight, int emotionCnt) {
+		fPValue = pValue;
+		fAValue = aValue;
+		fDValue = dValue;
+		fWeight = weight;
+		fEmotionCnt = emotionCnt;
+	}
+
 	 double getIntensity() {
 		return sqrt((fPValue*fPValue) + (fAValue*fAValue) + (fDValue*fDValue));
 	}
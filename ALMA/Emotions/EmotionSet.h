@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include "EmotionType.h"
+
+/**
+* The emotion types a build supports, one bit <code>1 << type</code> per
+* type. Deployments that only use a few emotions define it on the compiler
+* command line, e.g. <code>/DALMA_ENABLED_EMOTIONS=0x1FE</code> for Joy to
+* Fear; all per character storage is then sized for exactly these types.
+* The default enables every type.
+*/
+#ifndef ALMA_ENABLED_EMOTIONS
+#define ALMA_ENABLED_EMOTIONS ((1u << (EmotionType::Physical + 1)) - 1)
+#endif
+
+/**
+* Returns the number of emotion types in a mask.
+*/
+constexpr std::uint32_t emotionCount(std::uint32_t mask)
+{
+	mask = mask - ((mask >> 1) & 0x55555555u);
+	mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+	return (((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+/**
+* The class <code>EmotionSet</code> describes a set of emotion types fixed
+* at compile time. It maps the types of the set to dense indices in type
+* order, so per type storage holds one entry per type of the set only.
+*
+* @param Mask bit <code>1 << type</code> is set for every type of the set
+* @version 1.0
+*/
+template<std::uint32_t Mask>
+class EmotionSet
+{
+	static constexpr EmotionType typeAt(size_t index, std::uint32_t bits, size_t type)
+	{
+		return (bits == 0) ? EmotionType::Undefined : (((bits & 1u) != 0)
+			? ((index == 0) ? static_cast<EmotionType>(type) : typeAt(index - 1, bits >> 1, type + 1))
+			: typeAt(index, bits >> 1, type + 1));
+	}
+
+	template<class F, size_t... Index>
+	static void forEach(F& f, std::index_sequence<Index...>)
+	{
+		int unrolled[] = { 0, (f(typeAt(Index)), 0)... };
+		(void)unrolled;
+	}
+
+public:
+	static_assert((Mask >> (EmotionType::Physical + 1)) == 0, "Unknown emotion type in emotion set");
+
+	/** bit <code>1 << type</code> is set for every type of the set */
+	static const std::uint32_t sMASK = Mask;
+	/** number of types in the set */
+	static const size_t sCOUNT = emotionCount(Mask);
+	/** true if the set holds every type, indices are then the types */
+	static const bool sALL = (Mask == ((1u << (EmotionType::Physical + 1)) - 1));
+
+	static constexpr bool contains(EmotionType type)
+	{
+		return (type <= EmotionType::Physical) && ((Mask & (1u << type)) != 0);
+	}
+
+	/**
+	* Returns the dense index of a type of the set, the number of types of
+	* the set that precede it.
+	*/
+	static constexpr size_t indexOf(EmotionType type)
+	{
+		return sALL ? static_cast<size_t>(type) : emotionCount(Mask & ((1u << type) - 1));
+	}
+
+	/**
+	* Returns the type with the specified dense index.
+	*/
+	static constexpr EmotionType typeAt(size_t index)
+	{
+		return typeAt(index, Mask, 0);
+	}
+
+	/**
+	* Calls <code>f(type)</code> for every type of the set in type order. The
+	* loop is unrolled at compile time.
+	*/
+	template<class F>
+	static void forEach(F f)
+	{
+		forEach(f, std::make_index_sequence<sCOUNT>());
+	}
+
+	/**
+	* Returns the types of the set in type order, for the interfaces that take
+	* a list of emotion types. Undefined is not an emotion and left out.
+	*/
+	static std::list<EmotionType> toList()
+	{
+		std::list<EmotionType> types;
+		forEach([&types](EmotionType type) {
+			if (type != EmotionType::Undefined)
+				types.push_back(type);
+		});
+		return types;
+	}
+};
+
+/** the emotion types of this build */
+typedef EmotionSet<ALMA_ENABLED_EMOTIONS> EnabledEmotions;
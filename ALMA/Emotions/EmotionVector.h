@@ -2,20 +2,97 @@
 #include"../Personality/Personality.h"
 #include"../Mood/Mood.h"
 #include<list>
+#include<vector>
 #include"../Personality/PersonalityMoodRelations.h"
-#include <unordered_map>
 #include"PADEmotion.h"
 #include"EmotionType.h"
-#include<mutex>
+#include"EmotionSet.h"
+#include<cstddef>
+#include<cstdint>
+#include<iterator>
 #include"Emotion.h"
+#include"../Data/AffectArena.h"
 
+/**
+* The class <code>EmotionVector</code> holds at most one emotion of every
+* emotion type. The emotions are stored in a fixed slot per type of the
+* build's <code>EnabledEmotions</code>, indexed by the dense index of the
+* type; emotions of other types are never stored. One bit mask marks the
+* types the vector can store, another the types it holds an emotion of.
+* Iterating the vector visits the emotions in type order.
+* <br>
+* The emotional state of a character holds an emotion of every type. The
+* history stores deltas, vectors that only hold the emotions an event
+* changed.
+* <br>
+* A vector is owned by one character and only used under the lock of its
+* manager or engine, so it does not lock itself.
+*/
 class EmotionVector  {//implements Comparator<Emotion>
+ public:
+	/** number of emotion types including Undefined, types are below it */
+	static const size_t sSLOTS = EmotionType::Physical + 1;
+
+	/**
+	* Iterates the emotions of the vector in type order.
+	*/
+	class const_iterator {
+		const EmotionVector* fVector;
+		/** the dense index of the slot */
+		size_t fIndex;
+
+		void skip() {
+			while ((fIndex < EnabledEmotions::sCOUNT) && (fVector->fSlots[fIndex] == nullptr))
+				fIndex++;
+		}
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef std::shared_ptr<Emotion> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const std::shared_ptr<Emotion>* pointer;
+		typedef const std::shared_ptr<Emotion>& reference;
+
+		const_iterator(const EmotionVector* vector, size_t index) : fVector(vector), fIndex(index) {
+			skip();
+		}
+
+		const std::shared_ptr<Emotion>& operator*() const {
+			return fVector->fSlots[fIndex];
+		}
+
+		const_iterator& operator++() {
+			fIndex++;
+			skip();
+			return *this;
+		}
+
+		bool operator==(const const_iterator& other) const {
+			return fIndex == other.fIndex;
+		}
+
+		bool operator!=(const const_iterator& other) const {
+			return fIndex != other.fIndex;
+		}
+	};
 
-	/** maps emotion types to emotions */
  protected:
-	 
-	 std::recursive_mutex _mutex;
-	 std::unordered_map <Emotion::Type, std::shared_ptr<Emotion>> emotions;
+	/** the emotion of every enabled type, indexed by the dense index of the type */
+	std::shared_ptr<Emotion> fSlots[EnabledEmotions::sCOUNT];
+	/** bit <code>1 << type</code> is set for every type of the vector */
+	std::uint32_t fTypes = 0;
+	/** bit <code>1 << type</code> is set for every type the vector holds an emotion of */
+	std::uint32_t fMask = 0;
+
+	void set(Emotion::Type type, std::shared_ptr<Emotion> emotion) {
+		if (!EnabledEmotions::contains(type))
+			return;
+		fTypes |= (1u << type);
+		if (emotion != nullptr)
+			fMask |= (1u << type);
+		fSlots[EnabledEmotions::indexOf(type)] = std::move(emotion);
+	}
+
  public:
 	// static Logger log = Logger.getLogger(Logger.GLOBAL_LOGGER_NAME);
 
@@ -28,36 +105,92 @@ class EmotionVector  {//implements Comparator<Emotion>
 	*
 	* @param personality a personality object
 	* @param emotionTypes the predefined set of emotion types
+	* @param arena the character's arena the emotions are allocated from,
+	*              nullptr allocates them on the heap
 	* @throws NullPointerException if one of the arguments is null or
 	*                              if the list of emotion types is empty
 	*/
-	 EmotionVector(Personality& personality, Mood mood, const std::list<Emotion::Type>& emotionTypes) {
+	 EmotionVector(Personality& personality, Mood mood, const std::list<Emotion::Type>& emotionTypes,
+		 const std::shared_ptr<AffectArena>& arena = nullptr) {
 		if (emotionTypes.empty())
 			throw std::invalid_argument("Invalid null (or empty) list of emotion types");
 		/*if (mood == null)
 			throw std::invalid_argument("Invalid null mood!");*/
 		 if(personality == nullptr)
 			throw std::invalid_argument("Invalid null personality!"); 
+		// the baselines of all types for the personality and the moody personality in one pass
+		double traits[2 * PersonalityEmotionsRelations::sTRAITS];
+		personality.getTraits(traits);
+		PersonalityMoodRelations::getMoodyTraits(mood.getPleasure(), mood.getArousal(), mood.getDominance(),
+			traits + PersonalityEmotionsRelations::sTRAITS);
+		double baselines[2 * PersonalityEmotionsRelations::sTYPES];
+		personality.getPersonalityEmotionsRelations()->getInfluences(traits, 2, nullptr, baselines);
+		// all emotions share the one elicitor of the personality
+		std::uint32_t elicitor = Emotion::elicitorOf(personality);
 		// TODO INTRODUCE NEW EMOTION TYPES
 		for (Emotion::Type type : emotionTypes) {
+			if (!EnabledEmotions::contains(type))
+				continue;
 			if (type == Emotion::Type::Physical) {
 				// do a separate initialisation of physical emotionsz
 				Mood padValues =  Mood(0.0, 0.0, 0.0);
-				std::shared_ptr<PADEmotion> pademotion = std::make_shared<PADEmotion>(padValues, 0.0, personality.toString());
-				emotions.emplace(type, pademotion);
+				std::shared_ptr<PADEmotion> pademotion = AffectArena::makeShared<PADEmotion>(arena, padValues, 0.0, personality.toString());
+				set(type, pademotion);
 			}
 			else {
-				double baseline = personality.getEmotionBaseline(type);
-				double moodyBaseline = personality.getEmotionBaseline(PersonalityMoodRelations::getInstance()->getMoodyPersonalityTraits(mood), type);
+				double baseline = baselines[type];
+				double moodyBaseline = baselines[PersonalityEmotionsRelations::sTYPES + type];
 				baseline = (baseline + moodyBaseline) / 2.0;
 				//log.info(type.toString() + " baseline= " + baseline + " mood influence= " + moodyBaseline);
 				// intensity = baseline, elicitor = personality
-				std::shared_ptr<Emotion> emotion = std::make_shared<Emotion>(type, baseline, baseline, personality);
-				emotions.emplace(type, emotion);
+				std::shared_ptr<Emotion> emotion = AffectArena::makeShared<Emotion>(arena, type, baseline, baseline, elicitor);
+				set(type, emotion);
 			}
 		}
 	}
 
+	/**
+	* Creates a new <code>EmotionVector</code> that holds exactly the
+	* specified emotions. Used to restore checkpointed emotion vectors
+	* without recomputing the personality based baselines.
+	*
+	* @param entries pairs of emotion type and emotion
+	*/
+	 explicit EmotionVector(const std::vector<std::pair<Emotion::Type, std::shared_ptr<Emotion>>>& entries) {
+		 for (const auto& entry : entries)
+			 set(entry.first, entry.second);
+	 }
+
+	/**
+	* Creates an empty <code>EmotionVector</code> for the specified emotion
+	* types, i.e. a delta that only holds the emotions added to it.
+	*
+	* @param types bit <code>1 << type</code> is set for every emotion type
+	*/
+	 explicit EmotionVector(std::uint32_t types) : fTypes(types & EnabledEmotions::sMASK) {
+	 }
+
+	/**
+	* Returns the baseline of an emotion of the specified type in a vector
+	* created for the personality and the mood, without creating the vector.
+	*
+	* @param personality a personality object
+	* @param mood the mood
+	* @param type the emotion type
+	* @return the baseline
+	*/
+	 static double getBaseline(Personality& personality, Mood mood, Emotion::Type type) {
+		 if (type == Emotion::Type::Physical)
+			 return 0.0;
+		 double traits[2 * PersonalityEmotionsRelations::sTRAITS];
+		 personality.getTraits(traits);
+		 PersonalityMoodRelations::getMoodyTraits(mood.getPleasure(), mood.getArousal(), mood.getDominance(),
+			 traits + PersonalityEmotionsRelations::sTRAITS);
+		 std::shared_ptr<PersonalityEmotionsRelations> relations = personality.getPersonalityEmotionsRelations();
+		 return (relations->getEmotionBaseline(traits, type) +
+			 relations->getEmotionBaseline(traits + PersonalityEmotionsRelations::sTRAITS, type)) / 2.0;
+	 }
+
 	/**
 	* Compares the intensity of two emotions. Returns a negative integer,
 	* zero, or a positive integer as the intensity of the first emotion is
@@ -88,24 +221,28 @@ class EmotionVector  {//implements Comparator<Emotion>
 		return 0;
 	}
 
+	const_iterator begin() const {
+		return const_iterator(this, 0);
+	}
+
+	const_iterator end() const {
+		return const_iterator(this, EnabledEmotions::sCOUNT);
+	}
+
 	/**
 	* Returns the emotions sorted by their intensity in ascending order.
+	* Emotions of the same relative intensity stay in type order.
 	*
 	* @return the emotions sorted by their intensity
 	* @see #compare(Object, Object)
 	*/
-	// synchronized
-	 
-	  std::list<std::shared_ptr<Emotion>> getEmotions() {
-		  std::unique_lock<std::recursive_mutex> lock(_mutex);
-		  std::list<std::shared_ptr<Emotion>> result;
-		  for (auto kv : emotions) {
-			 // keys.push_back(kv.first);      i need to sort this by intesity 
-			  result.push_back(kv.second);
-		  }
-		  result.sort();
-	 	return result;
-	 }
+	std::list<std::shared_ptr<Emotion>> getEmotions() const {
+		std::list<std::shared_ptr<Emotion>> result(begin(), end());
+		result.sort([](const std::shared_ptr<Emotion>& e1, const std::shared_ptr<Emotion>& e2) {
+			return (e1->getIntensity() - e1->getBaseline()) < (e2->getIntensity() - e2->getBaseline());
+		});
+		return result;
+	}
 
 	/**
 	* Returns the emotion with the highest intensity.
@@ -115,14 +252,17 @@ class EmotionVector  {//implements Comparator<Emotion>
 	* @return the emotion with the highest relative intensity.
 	* @see #getEmotions()
 	*/
-	// synchronized 
-	 std::shared_ptr<Emotion> getDominantEmotion() {
-		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		std::list<std::shared_ptr<Emotion>> sortedEmotions = getEmotions();
-		int size = sortedEmotions.size();
-
-		auto result = sortedEmotions.back();
+	std::shared_ptr<Emotion> getDominantEmotion() const {
+		std::shared_ptr<Emotion> result = nullptr;
+		for (const std::shared_ptr<Emotion>& emotion : *this) {
+			// the last of equal emotions, like the back of the sorted list
+			if ((result == nullptr) || ((emotion->getIntensity() - emotion->getBaseline()) >=
+				(result->getIntensity() - result->getBaseline())))
+				result = emotion;
+		}
 
+		if (result == nullptr)
+			return nullptr;
 		if (result->getIntensity() != result->getBaseline())
 			return get(EmotionType::Undefined);
 
@@ -130,20 +270,33 @@ class EmotionVector  {//implements Comparator<Emotion>
 	}
 
 	/**
-	* Returns the predefined set of emotion types as an unmodifiable list.
+	* Returns the predefined set of emotion types in type order.
 	*
 	* @return the predefined set of emotion types.
 	*/
-	//	 synchronized
-	  std::list<EmotionType> getEmotionTypes() {
-		  std::unique_lock<std::recursive_mutex> lock(_mutex);
-		  std::list<EmotionType> keys;
-		  for (auto kv : emotions) {
-			  keys.push_back(kv.first);
-			  //vals.push_back(kv.second);
-		  }
-		  return keys;
-	 }
+	std::list<EmotionType> getEmotionTypes() const {
+		std::list<EmotionType> keys;
+		for (size_t type = 0; type < sSLOTS; type++) {
+			if (hasType(static_cast<Emotion::Type>(type)))
+				keys.push_back(static_cast<Emotion::Type>(type));
+		}
+		return keys;
+	}
+
+	/**
+	* Returns the bit mask of the predefined emotion types, bit
+	* <code>1 << type</code> is set for every type.
+	*/
+	std::uint32_t getTypes() const {
+		return fTypes;
+	}
+
+	/**
+	* Returns the bit mask of the types the vector holds an emotion of.
+	*/
+	std::uint32_t getMask() const {
+		return fMask;
+	}
 
 	/**
 	* Returns an emotion of that type or null if there is no emotion
@@ -152,10 +305,9 @@ class EmotionVector  {//implements Comparator<Emotion>
 	* @param type the emotion type
 	* @return an emotion of that type or null
 	*/
-	// synchronized
-	 std::shared_ptr<Emotion> get(Emotion::Type type) {
-		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		return emotions.at(type);
+	const std::shared_ptr<Emotion>& get(Emotion::Type type) const {
+		static const std::shared_ptr<Emotion> none;
+		return contains(type) ? fSlots[EnabledEmotions::indexOf(type)] : none;
 	}
 
 	/**
@@ -170,27 +322,25 @@ class EmotionVector  {//implements Comparator<Emotion>
 	*         and false otherwise.
 	* @see #getEmotionTypes()
 	*/
-	// synchronized
-	 bool add(std::shared_ptr<Emotion> emotion) {
-		 std::unique_lock<std::recursive_mutex> lock(_mutex);
+	bool add(std::shared_ptr<Emotion> emotion) {
 		Emotion::Type type = emotion->getType();
-		if (emotions.at(type)) {
-			emotions.erase(type);
-			emotions.insert(std::make_pair(type, (emotion)));
-			return true;
-		}
-		else return false;
+		if (!hasType(type))
+			return false;
+		fSlots[EnabledEmotions::indexOf(type)] = std::move(emotion);
+		fMask |= (1u << type);
+		return true;
 	}
 
 	/**
 	* Removes the specified emotiontype
 	* @param type the emotion type to be removed
 	*/
-	// synchronized 
-	 void remove(Emotion::Type type) {
-		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		 if (hasType(type))
-			 emotions.erase(type);
+	void remove(Emotion::Type type) {
+		if (!EnabledEmotions::contains(type))
+			return;
+		fSlots[EnabledEmotions::indexOf(type)] = nullptr;
+		fTypes &= ~(1u << type);
+		fMask &= ~(1u << type);
 	}
 
 	/**
@@ -201,9 +351,19 @@ class EmotionVector  {//implements Comparator<Emotion>
 	*
 	* @return true if the emotion vector has the defined emotion type
 	*/
+	bool hasType(Emotion::Type type) const {
+		return (type < sSLOTS) && ((fTypes & (1u << type)) != 0);
+	}
 
-	 bool hasType(Emotion::Type type) {
-		 return emotions.find(type) != emotions.end();
+	/**
+	* Queries if the emotion vector holds an emotion of the queried type.
+	*
+	* @param type type of emotion
+	*
+	* @return true if the emotion vector holds an emotion of that type
+	*/
+	bool contains(Emotion::Type type) const {
+		return (type < sSLOTS) && ((fMask & (1u << type)) != 0);
 	}
 
 	/**
@@ -214,15 +374,12 @@ class EmotionVector  {//implements Comparator<Emotion>
 	*
 	* @param newEmotions an emotion vector
 	*/
-	//synchronized
-	void merge(EmotionVector newEmotions) {
-		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		for (auto& newEmotion : newEmotions.emotions) {
-			Emotion::Type newEmotionType = newEmotion.first;
-			if (emotions.find(newEmotionType) == emotions.end()) {
-				emotions.insert(std::make_pair(newEmotionType, newEmotion.second));
-			}
-		}
+	void merge(const EmotionVector& newEmotions) {
+		std::uint32_t added = newEmotions.fMask & ~fMask;
+		EnabledEmotions::forEach([&](EmotionType type) {
+			if ((added & (1u << type)) != 0)
+				set(type, newEmotions.fSlots[EnabledEmotions::indexOf(type)]);
+		});
 	}
 
 	/**
@@ -245,8 +402,4 @@ class EmotionVector  {//implements Comparator<Emotion>
 	//	}
 	//	return sb.toString();
 	//}
-	const std::unordered_map<Emotion::Type, std::shared_ptr<Emotion>>& Getmap()
-	{
-		return emotions;
-	}
 };
\ No newline at end of file
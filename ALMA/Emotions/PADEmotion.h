@@ -9,7 +9,7 @@
 		 :Emotion(EmotionType::Physical, intensity, 0.0, description)
 	 {
 		  
-		mPADValues = padVals;
+		setPADValues(padVals);
 	}
 
 
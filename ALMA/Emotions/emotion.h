@@ -1,6 +1,7 @@
 #pragma once
 
 #include<string>
+#include<cstdint>
 #include"EmotionType.h"
 #include"EmotionAppraisalVars.h"
 #include"../Mood/Mood.h"
@@ -8,80 +9,116 @@
 #include <chrono>
 #include <memory>
 #include "../Personality/Personality.h"
+#include "ElicitorRegistry.h"
 
 class Emotion {
 
 public:
 
-	enum class ElicitType
-	{
-		Unknown,
-		String,
-		Emotion,
-		Personality
-	};
+	/** the kind of an elicitor */
+	typedef ElicitorRegistry::Type ElicitType;
 
-	struct Elicit
-	{
-		ElicitType Type;
-		std::string string;
-		std::shared_ptr<Emotion> Emo;
-		Personality Pre;
-		Elicit()
-		{
-			Type = ElicitType::Unknown;
-		}
-		Elicit(const std::string& str)
-		{
-			string = str;
-			Type = ElicitType::String;
-		}
-		Elicit(std::shared_ptr<Emotion>& val)
-		{
-			/*MAKE SHARED*/
-		//	Emo = std::move(val);
-			Emo = val;
-			Type = ElicitType::Emotion;
-		}
-		Elicit(Personality& val)
-		{
-			/*MAKE THIS SHARED*/
-		//	 Pre = std::move(val);
-			Pre = val;
-			Type = ElicitType::Personality;
-		}	
+	/**
+	* Returns the elicitor id of a situation named by a string.
+	*/
+	static std::uint32_t elicitorOf(const std::string& situation) {
+		return ElicitorRegistry::getInstance().intern(situation);
+	}
 
-		//Elicit(const Elicit&) = delete;
+	/**
+	* Returns the elicitor id of a personality, equal personalities have the
+	* same id.
+	*/
+	static std::uint32_t elicitorOf(const Personality& personality) {
+		double traits[5];
+		personality.getTraits(traits);
+		return ElicitorRegistry::getInstance().intern(traits);
+	}
 
-		bool operator==(std::shared_ptr<Elicit> e)
-		{
-			return Type == e->Type
-				&& Emo->operator==(e->Emo)
-				&& Pre.equals(&e->Pre);
-		}
-	};
+	/**
+	* Returns a new elicitor id for an emotion. The registry keeps a copy of
+	* the emotion, the id is only equal to itself.
+	*/
+	static std::uint32_t elicitorOf(const Emotion& emotion) {
+		return ElicitorRegistry::getInstance().create(std::make_shared<const Emotion>(emotion));
+	}
 
 	typedef EmotionType Type;
 
-	const std::vector<std::string> TypeNames = {
-		"Undefined", "Joy", "Distress", "HappyFor", "Gloating", "Resentment", "Pity", "Hope", "Fear",
-		"Satisfaction", "Relief", "FearsConfirmed", "Disappointment", "Pride", "Admiration",
-		"Shame", "Reproach", "Liking", "Disliking", "Gratitude", "Anger", "Gratification",
-		"Remorse", "Love", "Hate", "Physical"
-	};
+	/**
+	* Returns the name of an emotion type. The names are shared by all
+	* emotions.
+	*
+	* @param type the emotion type
+	* @return the name of the type
+	*/
+	static const std::string& typeName(Type type) {
+		static const std::string names[] = {
+			"Undefined", "Joy", "Distress", "HappyFor", "Gloating", "Resentment", "Pity", "Hope", "Fear",
+			"Satisfaction", "Relief", "FearsConfirmed", "Disappointment", "Pride", "Admiration",
+			"Shame", "Reproach", "Liking", "Disliking", "Gratitude", "Anger", "Gratification",
+			"Remorse", "Love", "Hate", "Physical"
+		};
+		return names[type];
+	}
 
-	Type type;
+	/**
+	* Returns the current tick, the milliseconds since the first call. Ticks
+	* wrap around after about 49 days.
+	*/
+	static std::uint32_t currentTick() {
+		static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+		return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - epoch).count());
+	}
 
+	// An emotion is a small record: the names live in static tables, the
+	// degrees are kept in single precision and the elicitor is the id the
+	// <code>ElicitorRegistry</code> keeps its payload under, so copying an
+	// emotion does not allocate.
+	std::uint32_t elicitor = ElicitorRegistry::sNONE;
 	EmotionAppraisalVars mApraisalVars;
-	double intensity;
-	double baseline;
-	long double mTimeOfElicitation;
-	long double mCalculatedEndTime;
-	long double  mCalculatedDuration;
-	std::shared_ptr<Elicit> elicitor;
+	float intensity = 0.0f;
+	float baseline = 0.0f;
+	/** the tick the emotion was elicited at, checkpoints store its age instead */
+	std::uint32_t mTimeOfElicitation = 0;
+	/** the decay progress, kept by the <code>DecayFunction</code>: the steps
+	* decayed so far, the step the decay ends at and the intensity range the
+	* decay started with. The range is 0 while the emotion is not decaying. */
+	std::uint32_t mDecayStep = 0;
+	std::uint32_t mDecayEnd = 0;
+	float mDecayRange = 0.0f;
 
 protected:
-	Mood mPADValues;
+	/** pleasure, arousal and dominance of a physical emotion */
+	float mPADValues[3] = { 0.0f, 0.0f, 0.0f };
+
+	void setPADValues(Mood pad) {
+		mPADValues[0] = static_cast<float>(pad.getPleasure());
+		mPADValues[1] = static_cast<float>(pad.getArousal());
+		mPADValues[2] = static_cast<float>(pad.getDominance());
+	}
+
+	void init(Type Type, double Intensity, double Baseline) {
+		if (Intensity < 0.0 || Intensity > 1.0) {
+			throw std::invalid_argument("Invalid intensity ");
+		}
+		if (Baseline < 0.0 || Baseline > 1.0) {
+			throw std::invalid_argument("Invalid baseline ");
+		}
+		if (Intensity < Baseline) {
+			throw std::invalid_argument("Error: intensity ");
+		}
+		mTimeOfElicitation = currentTick();
+
+		type = static_cast<std::uint8_t>(Type);
+		intensity = static_cast<float>(Intensity);
+		baseline = static_cast<float>(Baseline);
+	}
+
+public:
+	std::uint8_t type = EmotionType::Undefined;
+
 	/**
 	* <code>Emotion</code> object with the specified type and the specified
 	* Constructs a new
@@ -95,104 +132,43 @@ protected:
 	* real number in the interval <code>[0.0,1.0]</code> or if the intensity is
 	* less than the baseline.
 	*/
-
-public:
 	Emotion(){}
 
-	Emotion(Type Type, double Intensity, double Baseline,  std::shared_ptr<Elicit> Elicitor)
+	Emotion(Type Type, double Intensity, double Baseline, std::uint32_t Elicitor)
+		: elicitor(Elicitor)
 	{
-		if (Intensity < 0.0 || Intensity > 1.0) {
-			throw std::invalid_argument("Invalid intensity ");
-		}
-
-		if (Baseline < 0.0 || Baseline > 1.0) {
-			throw std::invalid_argument("Invalid baseline ");
-		}
-		if (Intensity < Baseline) {
-			throw std::invalid_argument("Error: intensity ");
-		}
-		mTimeOfElicitation = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-		type = Type;
-		intensity = Intensity;
-		baseline = Baseline;
-		elicitor = Elicitor;
+		init(Type, Intensity, Baseline);
 	}
 
-	Emotion(Type Type, double Intensity, double Baseline, std::string Elicitor)
-		: elicitor(new Elicit(Elicitor))
-	{
-		if (Intensity < 0.0 || Intensity > 1.0) {
-			throw std::invalid_argument("Invalid intensity ");
-		}
-		if (Baseline < 0.0 || Baseline > 1.0) {
-			throw std::invalid_argument("Invalid baseline ");
-		}
-		if (Intensity < Baseline) {
-			throw std::invalid_argument("Error: intensity ");
-		}
-		mTimeOfElicitation = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-		type = Type;
-		intensity = Intensity;
-		baseline = Baseline;
-	}
-	Emotion(Type Type, double Intensity, double Baseline, Personality Elicitor)
-		: elicitor(new Elicit(Elicitor))
+	Emotion(Type Type, double Intensity, double Baseline, const std::string& Elicitor)
+		: elicitor(elicitorOf(Elicitor))
 	{
-		if (Intensity < 0.0 || Intensity > 1.0) {
-			throw std::invalid_argument("Invalid intensity ");
-		}
-		if (Baseline < 0.0 || Baseline > 1.0) {
-			throw std::invalid_argument("Invalid baseline ");
-		}
-		if (Intensity < Baseline) {
-			throw std::invalid_argument("Error: intensity ");
-		}
-		mTimeOfElicitation = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-		
-		type = Type;
-		intensity = Intensity;
-		baseline = Baseline;
-	
+		init(Type, Intensity, Baseline);
 	}
 
-	Emotion(Type Type, double Intensity, double Baseline, std::shared_ptr<Emotion>& Elicitor)
-		: elicitor(new Elicit(Elicitor))
+	Emotion(Type Type, double Intensity, double Baseline, const Personality& Elicitor)
+		: elicitor(elicitorOf(Elicitor))
 	{
-		if (Intensity < 0.0 || Intensity > 1.0) {
-			throw std::invalid_argument("Invalid intensity ");
-		}
-		if (Baseline < 0.0 || Baseline > 1.0) {
-			throw std::invalid_argument("Invalid baseline ");
-		}
-		if (Intensity < Baseline) {
-			throw std::invalid_argument("Error: intensity ");
-		}
-		mTimeOfElicitation = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-		
-		type = Type;
-		intensity = Intensity;
-		baseline = Baseline;
+		init(Type, Intensity, Baseline);
 	}
 
-	
-	Emotion(Type Type, double Intensity, double Baseline, EmotionAppraisalVars eav, std::shared_ptr<Emotion>& Elicitor)
-	: Emotion(Type, Intensity, Baseline, Elicitor)
+	Emotion(Type Type, double Intensity, double Baseline, const std::shared_ptr<Emotion>& Elicitor)
+		: elicitor(elicitorOf(*Elicitor))
 	{
-		mApraisalVars = eav;
+		init(Type, Intensity, Baseline);
 	}
-	
-	Emotion(Type Type, double Intensity, double Baseline, EmotionAppraisalVars eav, std::shared_ptr<Elicit> Elicitor)
+
+	Emotion(Type Type, double Intensity, double Baseline, EmotionAppraisalVars eav, std::uint32_t Elicitor)
 		: Emotion(Type, Intensity, Baseline, Elicitor)
 	{
 		mApraisalVars = eav;
 	}
 
 	/**
-	* Returns the creation time of this emotion.
+	* Returns the creation tick of this emotion.
 	*
-	* @return the emotion type.
+	* @return the tick the emotion was elicited at.
+	* @see #currentTick()
 	*/
 	long getStart() const {
 		return mTimeOfElicitation;
@@ -204,7 +180,7 @@ public:
 	* @return the emotion type.
 	*/
 	Type getType() const {
-		return type;
+		return static_cast<Type>(type);
 	}
 
 	/**
@@ -222,7 +198,15 @@ public:
 	* @param intensity the new intensity
 	*/
 	void setIntensity(double Intensity) {
-		intensity = Intensity;
+		intensity = static_cast<float>(Intensity);
+	}
+
+	/**
+	* Returns true while a decay function decays this emotion towards its
+	* baseline.
+	*/
+	bool isDecaying() const {
+		return mDecayRange > 0.0f;
 	}
 
 	/**
@@ -246,9 +230,10 @@ public:
 	/**
 	* Returns the elicitor of this emotion.
 	*
-	* @return the emotion elicitor.
+	* @return the id of the emotion elicitor, <code>ElicitorRegistry::sNONE</code>
+	* for none.
 	*/
-	std::shared_ptr<Elicit> getElicitor() const {
+	std::uint32_t getElicitor() const {
 		return elicitor;
 	}
 
@@ -258,7 +243,7 @@ public:
 	* @return defined pleasure, dominance, and arousal values.
 	*/
 	Mood getPADValues() const {
-		return mPADValues;
+		return Mood(mPADValues[0], mPADValues[1], mPADValues[2]);
 	}
 
 	/**
@@ -268,8 +253,8 @@ public:
 	* @return a string representation of the emotion.
 	*/
 	std::string toString() const {
-		return TypeNames[type] + " (" + std::to_string(intensity) + "/" + std::to_string(baseline) + ") << " + 
-			((elicitor->Type != ElicitType::Unknown) ? elicitor->string : "");
+		return typeName(getType()) + " (" + std::to_string(intensity) + "/" + std::to_string(baseline) + ") << " + 
+			ElicitorRegistry::getInstance().getName(elicitor);
 	}
 
 	/**
@@ -290,8 +275,8 @@ public:
 		}
 
 		//figure out how to compare enums
-		return e->getType() == type
-			&& e->getIntensity() == intensity && e->getBaseline() == baseline
+		return e->getType() == getType()
+			&& e->getIntensity() == getIntensity() && e->getBaseline() == getBaseline()
 			&& (elicitor == e->getElicitor());
 	}
 
@@ -300,9 +285,7 @@ public:
 		return std::hash<size_t>()(type)
 			* std::hash<double>()(intensity)
 			<< std::hash<double>()(baseline)
-			<< std::hash<long double>()(mTimeOfElicitation)
-			* std::hash<long double>()(mCalculatedEndTime)
-			^ std::hash<long double>()(mCalculatedDuration)
+			<< std::hash<std::uint32_t>()(mTimeOfElicitation)
 			* (std::hash<EmotionAppraisalVars>()(mApraisalVars) << 1);
 	}
 };
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include "Emotions/Emotion.h"
+#include "Emotions/EmotionSet.h"
 #include <cstdlib>
 #include "Manage/charactermanager.h"
 #include"Manage/appraisalrules.h"
@@ -12,73 +14,28 @@
 AppraisalRules* addRules(const json& node, CharacterManager* npc)
 {
 	AppraisalRules* rule = new AppraisalRules();
-	AppraisalVariables* variable;
-	int counter = 0;
-	Desirability* Desire;
-	Praiseworthiness* praise;
-	Appealingness* appeal;
-	Likelihood* likehood;
-	Realization* real;
-	Likin* like;
-	Agency* agent;
+	// variables with the degree 0 are not specified
+	static const std::pair<const char*, AppraisalVariables::Variable> variables[] = {
+		{ "Desirability", AppraisalVariables::HasDesirability },
+		{ "Praiseworthiness", AppraisalVariables::HasPraiseworthiness },
+		{ "Appealingness", AppraisalVariables::HasAppealingness },
+		{ "Likelihood", AppraisalVariables::HasLikelihood },
+		{ "Realization", AppraisalVariables::HasRealization },
+		{ "Likin", AppraisalVariables::HasLiking }
+	};
 	for (auto& child : node["children"])
 	{
-		if (child["Desirability"].get<double>() != 0)
+		AppraisalVariables variable(AppraisalVariables::typeByName(child["type"].get<std::string>()));
+		for (const auto& entry : variables)
 		{
-			Desire = new Desirability(child["Desirability"].get<double>());
+			double degree = child[entry.first].get<double>();
+			if (degree != 0)
+				variable.set(entry.second, degree);
 		}
-		else
-			 Desire = nullptr;
-		if (child["Praiseworthiness"].get<double>() != 0)
-		{
-			praise = new Praiseworthiness(child["Praiseworthiness"].get<double>());
-		}
-		else
-			praise = nullptr;
-		if (child["Appealingness"].get<double>() != 0)
-		{
-			appeal = new Appealingness(child["Appealingness"].get<double>());
-		}
-		else
-			appeal = nullptr;
-		if (child["Likelihood"].get<double>() != 0)
-		{
-			likehood = new Likelihood(child["Likelihood"].get<double>());
-		}
-		else
-			likehood = nullptr;
-		if (child["Realization"].get<double>() != 0)
-		{
-			real = new Realization(child["Realization"].get<double>());
-		}
-		else
-		real = nullptr;
-		if (child["Likin"].get<double>() != 0)
-		{
-			like = new Likin(child["Likin"].get<double>());
-		}
-		else
-			like = nullptr;
+		std::string agency = child["Agency"].get<std::string>();
+		if ((agency == "other") || (agency == "self"))
+			variable.setAgency(agency == "self");
 
-		if ((child["Agency"].get<std::string>()) == "other" or (child["Agency"].get<std::string>()) == "self")
-		{
-			agent = new Agency(child["Agency"].get<std::string>());
-		}
-		else
-			agent = nullptr;
-			
-
-		variable=  new AppraisalVariables(child["type"].get<std::string>(),
-			child["signal"].get<std::string>(),
-			Desire,
-			praise,
-			appeal,
-			likehood,
-			real,
-		    agent,
-			like,
-			child["signal"].get<std::string>());
-		
 		rule->add(npc->getName(), child["signal"].get<std::string>(), "Basic", variable);
 
 	}
@@ -92,21 +49,370 @@ AppraisalRules* addRules(const json& node, CharacterManager* npc)
 
 	std::string filename = "./output/-HighPosExtraNoMem.csv";
 	std::string filename1 = "./output/HighPosNeuro-Memorycapture.csv";
-int main()
+
+/**
+* Reads the configuration of a headless run, as written by the sweep runner:
+* <pre>
+* { "personality": [o, c, e, a, n], "setup": { Setup.json overrides },
+*   "choices": [1, 2, ...], "output": "run.csv", "memoryOutput": "run-memory.csv" }
+* </pre>
+* The Setup.json overrides are applied before any character is created, the
+* choices replace the console input of the behavior trees.
+*/
+bool readRunConfig(const std::string& path, Personality& personality, std::istringstream& choices)
+{
+	json run;
+	ifstream runFile{ path };
+	if (!runFile)
+	{
+		cerr << "Failed to open '" << path << "'." << endl;
+		return false;
+	}
+	runFile >> run;
+
+	const json& traits = run["personality"];
+	personality = Personality(traits[0].get<double>(), traits[1].get<double>(), traits[2].get<double>(),
+		traits[3].get<double>(), traits[4].get<double>());
+
+	json setup;
+	ifstream setupFile{ "Setup.json" };
+	setupFile >> setup;
+	if (run.find("setup") != run.end())
+	{
+		for (auto it = run["setup"].begin(); it != run["setup"].end(); ++it)
+			setup[it.key()] = it.value();
+	}
+	CharacterManager::setSetup(setup);
+
+	std::string script;
+	for (auto& choice : run["choices"])
+		script += std::to_string(choice.get<int>()) + " ";
+	choices.str(script);
+
+	filename = run["output"].get<std::string>();
+	filename1 = run["memoryOutput"].get<std::string>();
+	return true;
+}
+
+/**
+* Compares the affective state of two characters: moods, the published
+* snapshot, every emotion of the history including its decay progress and
+* the payload of its elicitor, and the long term memories recalled by mood.
+* Differences are written to the report.
+*/
+bool sameAffect(CharacterManager& a, CharacterManager& b, const std::string& what, std::ostream& report)
+{
+	bool same = true;
+	auto check = [&](bool equal, const std::string& field) {
+		if (!equal)
+		{
+			report << what << ": " << field << " differs" << std::endl;
+			same = false;
+		}
+	};
+	AffectSnapshot sa = a.getAffectSnapshot();
+	AffectSnapshot sb = b.getAffectSnapshot();
+	check((sa.moodPleasure == sb.moodPleasure) && (sa.moodArousal == sb.moodArousal) &&
+		(sa.moodDominance == sb.moodDominance), "mood");
+	check((sa.tendencyPleasure == sb.tendencyPleasure) && (sa.tendencyArousal == sb.tendencyArousal) &&
+		(sa.tendencyDominance == sb.tendencyDominance), "mood tendency");
+	check(sa.dominantEmotion == sb.dominantEmotion, "dominant emotion");
+	for (size_t type = 0; type < AffectSnapshot::sEMOTIONTYPES; type++)
+	{
+		check((sa.intensities[type] == sb.intensities[type]) && (sa.baselines[type] == sb.baselines[type]),
+			"emotion " + Emotion::typeName(static_cast<EmotionType>(type)));
+	}
+	check(a.getImportance() == b.getImportance(), "importance");
+
+	EmotionHistory* ha = a.getEmotionHistory();
+	EmotionHistory* hb = b.getEmotionHistory();
+	check(ha->size() == hb->size(), "history size");
+	for (int i = 0; same && (i < ha->size()); i++)
+	{
+		auto ia = ha->get(i)->begin();
+		auto ib = hb->get(i)->begin();
+		for (; (ia != ha->get(i)->end()) && (ib != hb->get(i)->end()); ++ia, ++ib)
+		{
+			if ((*ia == nullptr) || (*ib == nullptr))
+			{
+				check(*ia == *ib, "history element " + std::to_string(i));
+				continue;
+			}
+			const Emotion& ea = **ia;
+			const Emotion& eb = **ib;
+			check((ea.getType() == eb.getType()) && (ea.intensity == eb.intensity) && (ea.baseline == eb.baseline) &&
+				(ea.mDecayStep == eb.mDecayStep) && (ea.mDecayEnd == eb.mDecayEnd) && (ea.mDecayRange == eb.mDecayRange),
+				"history element " + std::to_string(i) + " " + Emotion::typeName(ea.getType()));
+			// emotion elicitors get a new id on restore, only their payload is compared
+			ElicitorRegistry::Entry pa = ElicitorRegistry::getInstance().get(ea.getElicitor());
+			ElicitorRegistry::Entry pb = ElicitorRegistry::getInstance().get(eb.getElicitor());
+			check((pa.type == pb.type) && (pa.name == pb.name) && (pa.traits == pb.traits) &&
+				((pa.emotion == nullptr) == (pb.emotion == nullptr)) &&
+				((pa.emotion == nullptr) || (pa.emotion->intensity == pb.emotion->intensity)),
+				"history element " + std::to_string(i) + " " + Emotion::typeName(ea.getType()) + " elicitor");
+		}
+		check((ia == ha->get(i)->end()) && (ib == hb->get(i)->end()), "history element " + std::to_string(i));
+	}
+
+	std::vector<longTermMem*> ma = a.recallByMood(64);
+	std::vector<longTermMem*> mb = b.recallByMood(64);
+	check(ma.size() == mb.size(), "long term memory size");
+	for (size_t i = 0; same && (i < ma.size()); i++)
+	{
+		check((ma[i]->name == mb[i]->name) && (ma[i]->emotion == mb[i]->emotion) &&
+			(ma[i]->intensity == mb[i]->intensity) && (ma[i]->time == mb[i]->time), "long term memory " + std::to_string(i));
+	}
+	return same;
+}
+
+/**
+* Checks that checkpoints reproduce the affective state: a character with
+* decaying emotions, elicited by situations and by an emotion, and a
+* pending short term memory is written
+* and read back, forked and restored as part of
+* a population, and every copy must equal the original before and after a
+* further affect step and a memory consolidation. Saving must not change the
+* original, which is compared with an equal character that is never saved.
+* Returns the exit code of <code>ALMA --check-checkpoint</code>.
+*/
+int checkCheckpoint(AffectConsts* ac, DecayFunction* decayFunction, const std::list<EmotionType>& emotions)
+{
+	auto prepare = [](CharacterManager& character) {
+		character.pauseAffectComputation();
+		character.addEEC(EEC::appraiseEvent(Emotion::elicitorOf("gift"), Desirability(0.7)));
+		character.addEEC(EEC::appraiseAction(Emotion::elicitorOf("insult"), Praiseworthiness(-0.6), false));
+		character.addEEC(EEC::appraiseObject(Emotion::elicitorOf(Emotion(EmotionType::Joy, 0.5, 0.0, "gift")), Appealingness(0.4)));
+		character.inferEmotions();
+		for (int i = 0; i < 5; i++)
+			character.stepwiseAffectComputation();
+		character.sendToMem("Joy", "player", "gift", character.getCurrentMood(), 0.7, "gift");
+	};
+	CharacterManager original("original", Personality(0.3, -0.2, 0.5, 0.1, -0.4), ac, false, decayFunction, emotions);
+	prepare(original);
+	CharacterManager unsaved("original", Personality(0.3, -0.2, 0.5, 0.1, -0.4), ac, false, decayFunction, emotions);
+	prepare(unsaved);
+
+	std::stringstream buffer(std::ios::in | std::ios::out | std::ios::binary);
+	original.saveCheckpoint(buffer);
+	std::unique_ptr<CharacterManager> restored(CharacterManager::restoreCheckpoint(buffer, ac, decayFunction));
+	std::unique_ptr<CharacterManager> forked(original.fork("forked"));
+	std::stringstream population(std::ios::in | std::ios::out | std::ios::binary);
+	CharacterManager::savePopulation(population, { &original, restored.get() });
+	std::vector<CharacterManager*> members = CharacterManager::restorePopulation(population, ac, decayFunction);
+
+	std::vector<std::pair<CharacterManager*, std::string>> copies = {
+		{ &unsaved, "unsaved" }, { restored.get(), "restored" }, { forked.get(), "forked" },
+		{ members[0], "population 0" }, { members[1], "population 1" }
+	};
+	bool same = true;
+	for (auto& copy : copies)
+	{
+		copy.first->pauseAffectComputation();
+		same = sameAffect(original, *copy.first, copy.second, cerr) && same;
+	}
+	original.stepwiseAffectComputation();
+	original.incermentTime();
+	for (auto& copy : copies)
+	{
+		copy.first->stepwiseAffectComputation();
+		copy.first->incermentTime();
+		same = sameAffect(original, *copy.first, copy.second + " after a step", cerr) && same;
+	}
+	for (CharacterManager* member : members)
+		delete member;
+	std::cout << "checkpoint round trip: " << (same ? "ok" : "FAILED") << std::endl;
+	return same ? 0 : 1;
+}
+
+/**
+* Checks that the batched emotion inference agrees with the scalar one: the
+* same Emotion Eliciting Conditions are inferred through
+* <code>EmotionEngine::inferEmotions</code> for an emotion vector and through
+* the batched jobs for fixed slots, for several moods and sets of emotion
+* types, and both must yield the same emotions. The conditions of one
+* elicitor only meet compound rules if a type of the pair is not used, as the
+* scalar path builds no compound emotions from the emotions of one call.
+* Returns the exit code of <code>ALMA --check-inference</code>.
+*/
+int checkInference(DecayFunction* decayFunction)
+{
+	EmotionEngine engine(Personality(0.3, -0.2, 0.5, 0.1, -0.4), decayFunction);
+	std::uint32_t gift = Emotion::elicitorOf("gift");
+	std::uint32_t insult = Emotion::elicitorOf("insult");
+	std::uint32_t rival = Emotion::elicitorOf("rival");
+	const std::vector<std::vector<EEC>> conditions = {
+		{ EEC::appraiseEvent(gift, Desirability(0.7)), EEC::appraiseAction(insult, Praiseworthiness(-0.6), false),
+			EEC::appraiseObject(rival, Appealingness(-0.4)) },
+		{ EEC::appraiseEvent(gift, Desirability(-0.5), Likelihood(0.8)), EEC::appraiseAction(gift, Praiseworthiness(0.3), false) },
+		{ EEC::appraiseEvent(rival, Desirability(0.6), Likin(-0.9)), EEC::appraiseObject(insult, Appealingness(0.2)) },
+		{ EEC::appraiseEvent(gift, Desirability(0.4)), EEC::appraiseAction(gift, Praiseworthiness(0.9), true) }
+	};
+	const std::uint32_t all = EmotionSlots::sALLTYPES;
+	const std::vector<std::uint32_t> typeSets = {
+		all & ~(1u << EmotionType::Pride) & ~(1u << EmotionType::Admiration),
+		all & ~(1u << EmotionType::Joy) & ~(1u << EmotionType::Distress),
+		all & ~(1u << EmotionType::Joy) & ~(1u << EmotionType::Fear) & ~(1u << EmotionType::Disliking)
+	};
+	const Mood moods[] = { Mood(0.0, 0.0, 0.0), Mood(0.6, -0.3, 0.2), Mood(-0.7, 0.5, -0.4) };
+
+	std::vector<std::vector<EECValues>> values;
+	for (const std::vector<EEC>& eecs : conditions)
+	{
+		values.emplace_back();
+		for (const EEC& eec : eecs)
+			values.back().push_back(eec.values);
+	}
+	std::vector<InferenceJob> jobs;
+	for (Mood mood : moods)
+	{
+		for (std::uint32_t types : typeSets)
+		{
+			for (const std::vector<EECValues>& eecs : values)
+			{
+				InferenceJob job;
+				job.engine = &engine;
+				job.eecs = eecs.data();
+				job.count = eecs.size();
+				job.pleasure = mood.getPleasure();
+				job.arousal = mood.getArousal();
+				job.dominance = mood.getDominance();
+				job.types = types;
+				jobs.push_back(job);
+			}
+		}
+	}
+	std::vector<EmotionSlots> slots(jobs.size());
+	EmotionEngine::inferEmotions(jobs.data(), jobs.size(), slots.data());
+
+	bool same = true;
+	size_t job = 0;
+	for (Mood mood : moods)
+	{
+		for (std::uint32_t types : typeSets)
+		{
+			for (const std::vector<EEC>& eecs : conditions)
+			{
+				engine.clearEEC();
+				for (const EEC& eec : eecs)
+					engine.addEEC(eec);
+				EmotionHistory history;
+				std::shared_ptr<EmotionVector> scalar = engine.inferEmotions(std::make_shared<EmotionVector>(types), &history, mood);
+				const EmotionSlots& batched = slots[job];
+				for (size_t type = 1; type < EmotionSlots::sSLOTS; type++)
+				{
+					EmotionType emotionType = static_cast<EmotionType>(type);
+					const std::shared_ptr<Emotion>& emotion = scalar->get(emotionType);
+					bool equal = (emotion != nullptr) == batched.has(emotionType);
+					// emotions keep their intensity and baseline in single precision
+					if (equal && (emotion != nullptr))
+						equal = (emotion->getIntensity() == static_cast<float>(batched.intensity[type])) &&
+							(emotion->getBaseline() == static_cast<float>(batched.baseline[type])) &&
+							(emotion->getElicitor() == batched.elicitor[type]);
+					if (!equal)
+					{
+						cerr << "job " << job << ": " << Emotion::typeName(emotionType) << " differs" << std::endl;
+						same = false;
+					}
+				}
+				job++;
+			}
+		}
+	}
+	engine.clearEEC();
+	std::cout << "batched inference: " << (same ? "ok" : "FAILED") << std::endl;
+	return same ? 0 : 1;
+}
+
+/**
+* Checks that the emotional state follows the history while it decays: two
+* emotions of one type are elicited a few ticks apart and decayed by the
+* engine's decay loop with every decay function, and after every tick the
+* state must hold the most intense emotion of the history. The decay steps
+* are those of Setup.json. Returns the exit code of
+* <code>ALMA --check-decay</code>.
+*/
+int checkDecay(AffectConsts* ac, DecayFunction* decayFunction, const std::list<EmotionType>& emotions)
+{
+	// the first character reads Setup.json into the affect constants
+	CharacterManager setup("setup", Personality(0.0, 0.0, 0.0, 0.0, 0.0), ac, false, decayFunction, emotions);
+	setup.pauseAffectComputation();
+	int decaySteps = ac->emotionDecaySteps;
+	LinearDecayFunction linear(decaySteps);
+	ExponentialDecayFunction exponential(decaySteps);
+	TangensHyperbolicusDecayFunction hyperbolic(decaySteps);
+	const std::pair<DecayFunction*, std::string> functions[] = {
+		{ &linear, "linear" }, { &exponential, "exponential" }, { &hyperbolic, "tangens hyperbolicus" }
+	};
+	const std::uint32_t types = 1u << EmotionType::Joy;
+	bool same = true;
+	for (const auto& function : functions)
+	{
+		EmotionEngine engine(Personality(0.3, -0.2, 0.5, 0.1, -0.4), function.first);
+		EmotionHistory history;
+		std::shared_ptr<EmotionVector> state = std::make_shared<EmotionVector>(types);
+		for (int tick = 0; tick < 2 * decaySteps; tick++)
+		{
+			if ((tick == 0) || (tick == 3))
+			{
+				std::shared_ptr<EmotionVector> elicited = std::make_shared<EmotionVector>(types);
+				elicited->add(std::make_shared<Emotion>(EmotionType::Joy, (tick == 0) ? 0.9 : 0.85, 0.0, Emotion::elicitorOf("gift")));
+				history.add(elicited);
+			}
+			std::shared_ptr<EmotionVector> defaults = std::make_shared<EmotionVector>(types);
+			state = engine.decay(&history, state, defaults, 1);
+			double maximum = 0.0;
+			for (int i = 0; i < history.size(); i++)
+			{
+				const std::shared_ptr<Emotion>& emotion = history.get(i)->get(EmotionType::Joy);
+				if (emotion != nullptr)
+					maximum = (std::max)(maximum, static_cast<double>(emotion->getIntensity()));
+			}
+			const std::shared_ptr<Emotion>& joy = state->get(EmotionType::Joy);
+			double intensity = (joy == nullptr) ? 0.0 : joy->getIntensity();
+			if ((maximum > 0.0) && (intensity != maximum))
+			{
+				cerr << function.second << " decay, tick " << tick << ": state " << intensity << ", history maximum " << maximum << std::endl;
+				same = false;
+			}
+		}
+	}
+	std::cout << "decaying history: " << (same ? "ok" : "FAILED") << std::endl;
+	return same ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
 {	
 	Narrator narrator= Narrator();
 	Personality personality = Personality(0.04,0.02,0.05,0.01,0.01);//ocean
+	// ALMA --run config.json runs the story without console interaction
+	bool headless = (argc == 3) && (std::string(argv[1]) == "--run");
+	std::istringstream scriptedChoices;
+	if (headless)
+	{
+		if (!readRunConfig(argv[2], personality, scriptedChoices))
+			return 1;
+		PlayerChoice::setInput(&scriptedChoices);
+	}
 	AffectConsts* affectconstant =new AffectConsts();
 //	affectconstant->moodStabilityControlledByNeurotism = true;
 	DecayFunction* decayfunction = new LinearDecayFunction();
 
-	std::list<EmotionType> emotionlist = { Joy, Distress, HappyFor, Gloating, Resentment, Pity, Hope, Fear,
-		Satisfaction, Relief, FearsConfirmed, Disappointment, Pride, Admiration,
-		Shame, Reproach, Liking, Disliking, Gratitude, Anger, Gratification,
-		Remorse, Love, Hate, Physical };
+	// the emotion types of this build, see ALMA_ENABLED_EMOTIONS
+	std::list<EmotionType> emotionlist = EnabledEmotions::toList();
+
+	// ALMA --check-checkpoint verifies that checkpoints reproduce the affective state
+	if ((argc == 2) && (std::string(argv[1]) == "--check-checkpoint"))
+		return checkCheckpoint(affectconstant, decayfunction, emotionlist);
+	// ALMA --check-inference verifies that the batched emotion inference agrees with the scalar one
+	if ((argc == 2) && (std::string(argv[1]) == "--check-inference"))
+		return checkInference(decayfunction);
+	// ALMA --check-decay verifies that the emotional state follows a decaying history
+	if ((argc == 2) && (std::string(argv[1]) == "--check-decay"))
+		return checkDecay(affectconstant, decayfunction, emotionlist);
 	
 	CharacterManager shakir ("shakir", personality, affectconstant, false, decayfunction, emotionlist);
 	CharacterManager notshakir("notshakir", Personality(-0.1, -0.1, -0.1, -0.1, -0.1), affectconstant, false, decayfunction, emotionlist);
+	shakir.setOutputFiles(filename, filename1);
 
 	ofstream outputFile;
 	outputFile.open(filename);
@@ -190,7 +496,7 @@ int main()
 	std::cout << "Shakir is feeling " << shakir.getCurrentMood().getMoodWord() << std::endl;
 	narrator.Story(5);
 	shakir.runTree("finalbattle");
-	/*shakir.addEEC(EEC::appraiseEvent(std::make_shared<Emotion::Elicit>(personality), new Desirability(0.5)));
+	/*shakir.addEEC(EEC::appraiseEvent(Emotion::elicitorOf(personality), Desirability(0.5)));
 	std::shared_ptr<EmotionVector> test = shakir.inferEmotions();
 	std::shared_ptr<Emotion> hello=test->getDominantEmotion();
 	std::thread ever_lasting([]() {
@@ -199,6 +505,9 @@ int main()
 	});
 	
 	ever_lasting.join();*/
-	system("pause");
+	// the logs are written in the background, make them complete before waiting
+	Telemetry::getInstance().flush();
+	if (!headless)
+		system("pause");
 	return 0;
 }
\ No newline at end of file
@@ -541,7 +541,7 @@
 		// KillTimer(0, 1);
 	}
 
-	 void addEEC(EEC* eec) {
+	 void addEEC(const EEC& eec) {
 		fEmotionEngine->addEEC(eec);
 	}
 
@@ -588,6 +588,7 @@
 		disableEmotionDecay();
 		disableMoodComputation();
 		fPersonality = personality;
+		invalidateDefaultEmotions();
 		//fEmotionVector = createEmotionVector();
 		//fEmotionHistory = new EmotionHistory();
 
@@ -619,6 +620,7 @@
 		perEmoRels->setPersonalityEmotionInfluence(ac->personalityEmotionInfluence);
 		perEmoRels->setEmotionMaxBaseline(ac->emotionMaxBaseline);
 		fPersonality.setPersonalityEmotionsRelations(perEmoRels);
+		invalidateDefaultEmotions();
 		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
 		enableMoodComputation();
 		enableEmotionDecay();
@@ -634,7 +636,7 @@
 	// synchronized 
 	 std::shared_ptr<EmotionVector> inferEmotions() {
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		 std::shared_ptr<EmotionVector> result = createEmotionVector();
+		 std::shared_ptr<EmotionVector> result = createEmotionDelta();
 		result = fEmotionEngine->inferEmotions(result, fEmotionHistory, fCurrentMood);
 		fEmotionEngine->clearEEC();
 		fEmotionHistory->add(result);
@@ -711,16 +713,12 @@
 		EmotionType changedEmotionType = e.emotionType();
 		// only add the emotion to the right character :-)
 		if (e.getCharacterName()==fName) {
-			std::shared_ptr<EmotionVector> emotions = createEmotionVector();
-			std::list<std::shared_ptr<Emotion>> freshDummyEmotions = emotions->getEmotions();
-			for (const auto& it : freshDummyEmotions) {
-				std::shared_ptr<Emotion> emotion = it;
-				EmotionType emotionType = emotion->getType();
-				if (changedEmotionType==emotionType) {
-					double intensity = (e.intensity() < emotion->getBaseline()) ? emotion->getBaseline() : e.intensity();
-					std::shared_ptr<Emotion> newEmotion = std::make_shared<Emotion>(emotionType, intensity, emotion->getBaseline(), "User maintenance");
-					emotions->add(newEmotion);
-				}
+			std::shared_ptr<EmotionVector> emotions = createEmotionDelta();
+			if (emotions->hasType(changedEmotionType)) {
+				double baseline = getEmotionBaseline(changedEmotionType);
+				double intensity = (e.intensity() < baseline) ? baseline : e.intensity();
+				std::shared_ptr<Emotion> newEmotion = std::make_shared<Emotion>(changedEmotionType, intensity, baseline, "User maintenance");
+				emotions->add(newEmotion);
 			}
 			fEmotionHistory->add(emotions);
 			fEmotionVector = fEmotionHistory->getEmotionalState(fEmotionVector);
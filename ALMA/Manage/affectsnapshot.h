@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "../Emotions/EmotionType.h"
+
+/**
+* The class <code>AffectSnapshot</code> is a flat, self-contained copy of the
+* affective state of a character: current mood, mood tendency, dominant emotion
+* and the intensity and baseline of every emotion type. Snapshots are cheap to
+* copy and are meant to be read by render or AI threads that must not touch the
+* character's locks.
+*
+* @version 1.0
+*/
+struct AffectSnapshot {
+	static const size_t sEMOTIONTYPES = EmotionType::Physical + 1;
+
+	/** incremented on every publication, 0 means nothing was published yet */
+	std::uint64_t version = 0;
+
+	double moodPleasure = 0.0;
+	double moodArousal = 0.0;
+	double moodDominance = 0.0;
+
+	double tendencyPleasure = 0.0;
+	double tendencyArousal = 0.0;
+	double tendencyDominance = 0.0;
+
+	/** emotion with the highest intensity above its baseline, Undefined if none */
+	std::uint64_t dominantEmotion = EmotionType::Undefined;
+
+	/** indexed by EmotionType, 0.0 for types the character does not have */
+	double intensities[sEMOTIONTYPES] = {};
+	double baselines[sEMOTIONTYPES] = {};
+
+	EmotionType getDominantEmotion() const {
+		return static_cast<EmotionType>(dominantEmotion);
+	}
+
+	double getIntensity(EmotionType type) const {
+		return intensities[type];
+	}
+
+	double getBaseline(EmotionType type) const {
+		return baselines[type];
+	}
+};
+
+/**
+* The class <code>AffectSnapshotBuffer</code> publishes
+* <code>AffectSnapshot</code> objects from a single writer to any number of
+* readers without locks.
+* <br>
+* Two slots are used alternately. The writer always fills the slot readers are
+* not pointed at and flips the index afterwards, so a reader only has to retry
+* when the writer laps it twice during one copy. Each slot carries a sequence
+* counter (odd while being written) which lets a reader detect that case and
+* guarantees that a torn snapshot is never returned. The payload is copied
+* word-wise through relaxed atomics so the concurrent copy is well defined.
+* <br>
+* publish() must be called by one thread at a time, e.g. with the owner's lock
+* held; read() may be called from any thread at any time.
+*
+* @version 1.0
+*/
+class AffectSnapshotBuffer {
+	typedef std::uint32_t Word;
+	static const size_t sWORDS = sizeof(AffectSnapshot) / sizeof(Word);
+	static_assert(sizeof(AffectSnapshot) % sizeof(Word) == 0, "AffectSnapshot must be word aligned");
+
+	struct Slot {
+		std::atomic<std::uint32_t> sequence{ 0 };
+		std::atomic<Word> words[sWORDS];
+	};
+
+	Slot fSlots[2];
+	std::atomic<std::uint32_t> fCurrent{ 0 };
+	std::uint64_t fVersion = 0;
+
+public:
+	AffectSnapshotBuffer() {
+		for (Slot& slot : fSlots)
+			for (std::atomic<Word>& w : slot.words)
+				w.store(0, std::memory_order_relaxed);
+	}
+
+	AffectSnapshotBuffer(const AffectSnapshotBuffer&) = delete;
+	AffectSnapshotBuffer& operator=(const AffectSnapshotBuffer&) = delete;
+
+	/**
+	* Publishes a new snapshot. The version field of the given snapshot is
+	* overwritten with the next version number.
+	*
+	* @param snapshot the affective state to publish
+	* @return the version assigned to the published snapshot
+	*/
+	std::uint64_t publish(AffectSnapshot snapshot) {
+		snapshot.version = ++fVersion;
+		Word buffer[sWORDS];
+		std::memcpy(buffer, &snapshot, sizeof(AffectSnapshot));
+
+		std::uint32_t target = fCurrent.load(std::memory_order_relaxed) ^ 1u;
+		Slot& slot = fSlots[target];
+		std::uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+		slot.sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < sWORDS; i++)
+			slot.words[i].store(buffer[i], std::memory_order_relaxed);
+		slot.sequence.store(seq + 2, std::memory_order_release);
+		fCurrent.store(target, std::memory_order_release);
+		return snapshot.version;
+	}
+
+	/**
+	* Returns the most recently published snapshot. Never blocks; a snapshot
+	* with version 0 is returned if nothing was published yet.
+	*
+	* @return a consistent copy of the last published affective state
+	*/
+	AffectSnapshot read() const {
+		Word buffer[sWORDS];
+		for (;;) {
+			const Slot& slot = fSlots[fCurrent.load(std::memory_order_acquire)];
+			std::uint32_t before = slot.sequence.load(std::memory_order_acquire);
+			if (before & 1u)
+				continue;
+			for (size_t i = 0; i < sWORDS; i++)
+				buffer[i] = slot.words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == before)
+				break;
+		}
+		AffectSnapshot result;
+		std::memcpy(&result, buffer, sizeof(AffectSnapshot));
+		return result;
+	}
+};
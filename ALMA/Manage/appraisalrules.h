@@ -13,7 +13,7 @@ class RuleSet {
 public:
 std::unordered_map<std::string, std::string> types;
 		
-std::unordered_map<std::string, AppraisalVariables*> rules;
+std::unordered_map<std::string, AppraisalVariables> rules;
 
 
 		RuleSet() {	}
@@ -22,24 +22,23 @@ std::unordered_map<std::string, AppraisalVariables*> rules;
 class AppraisalRules {
 
 private:
-	std::unordered_map<std::string, RuleSet*> entityRelatedRules;
+	std::unordered_map<std::string, RuleSet> entityRelatedRules;
 
-	
+	RuleSet* getRuleSet(const std::string& entity) {
+		auto it = entityRelatedRules.find(entity);
+		return (it == entityRelatedRules.end()) ? nullptr : &it->second;
+	}
 	
 public:
-	AppraisalRules() { entityRelatedRules = std::unordered_map<std::string, RuleSet*>(); }
+	AppraisalRules() {}
 
 	 
 
-	 void add(std::string entity, std::string key, std::string type, AppraisalVariables appraisalVariables[]) {
-		 RuleSet* ruleSet= nullptr;
-		 //= entityRelatedRules.at(entity);
-		if (ruleSet == nullptr) { // add a new rule set for a new entity
-			entityRelatedRules.emplace(entity, new RuleSet());
-			ruleSet = entityRelatedRules.at(entity);
-		}
-		ruleSet->types.emplace(key, type);
-		ruleSet->rules.emplace(key, appraisalVariables);
+	 void add(std::string entity, std::string key, std::string type, const AppraisalVariables& appraisalVariables) {
+		 // a new rule set for a new entity
+		RuleSet& ruleSet = entityRelatedRules[entity];
+		ruleSet.types.emplace(key, type);
+		ruleSet.rules.emplace(key, appraisalVariables);
 	}
 
 	 void removeEntityRelatedRules(std::string entity) {
@@ -47,25 +46,49 @@ public:
 	}
 
 	 void removeKey(std::string entity, std::string key) {
-		RuleSet* ruleSet = entityRelatedRules.at(entity);
+		RuleSet* ruleSet = getRuleSet(entity);
 		if (ruleSet != nullptr) {
 			ruleSet->types.erase(key);
 			ruleSet->rules.erase(key);
 		}
 	}
 
+	/**
+	* Returns the rule of an entity for a key. The rule stays owned by the
+	* rules.
+	*
+	* @return the rule, nullptr if there is none.
+	*/
 	AppraisalVariables* getAppraisalVariables(std::string entity, std::string key) {
-		RuleSet* ruleSet = entityRelatedRules.at(entity);
-		return (ruleSet == nullptr) ? nullptr : ruleSet->rules.at(key);
+		RuleSet* ruleSet = getRuleSet(entity);
+		if (ruleSet == nullptr)
+			return nullptr;
+		auto it = ruleSet->rules.find(key);
+		return (it == ruleSet->rules.end()) ? nullptr : &it->second;
+	}
+
+	/**
+	* Returns the rule of an entity for a key if it has the specified type.
+	*
+	* @return the rule, nullptr if there is none.
+	*/
+	AppraisalVariables* getAppraisalVariables(std::string entity, std::string key, std::string type) {
+		RuleSet* ruleSet = getRuleSet(entity);
+		if (ruleSet == nullptr)
+			return nullptr;
+		auto it = ruleSet->types.find(key);
+		if ((it == ruleSet->types.end()) || (it->second != type))
+			return nullptr;
+		return getAppraisalVariables(entity, key);
 	}
 
 	 AppraisalRules getAppraisalRulesByType(std::string entity, std::string type) {
 		AppraisalRules ruleSubSet =  AppraisalRules();
-		RuleSet* ruleSet = entityRelatedRules.at(entity);
+		RuleSet* ruleSet = getRuleSet(entity);
 		if (ruleSet != nullptr)
 			for (const auto& e : ruleSet->types) {
 				std::string key = e.first;
-				if (type==(ruleSet->types.at(key)))
+				if (type==(e.second))
 					ruleSubSet.add(entity, key, type, ruleSet->rules.at(key));
 			}
 		return ruleSubSet;
@@ -74,7 +97,7 @@ public:
 	 std::string* getKeys(std::string entity) {
 		 std::string* a;
 		std::vector<std::string> keyList;
-		RuleSet* ruleSet = entityRelatedRules.at(entity);
+		RuleSet* ruleSet = getRuleSet(entity);
 		if (ruleSet != nullptr) {
 			for (const auto& e : ruleSet->rules)
 				keyList.push_back(e.first);
@@ -86,7 +109,7 @@ public:
 
 	 std::string tostring(std::string entity) {
 		 std::string sb;
-		RuleSet* ruleSet = entityRelatedRules.at(entity);
+		RuleSet* ruleSet = getRuleSet(entity);
 		if (ruleSet != nullptr) {
 			for (const auto& keyEnum : ruleSet->rules) {
 				std::string key = keyEnum.first;
@@ -18,6 +18,7 @@
 #include "asynctimerqueue.hh"
 #include "Memory.h"
 #include "MemStructs.h"
+#include "Data/Telemetry.h"
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
@@ -31,6 +32,8 @@ gui.AffectMonitorFrame
 */
 #include "timer_manager.h"
 #include"Data/AffectConsts.h"
+#include"Data/AffectArena.h"
+#include"Data/BinaryStream.h"
 #include"Emotions/EmotionType.h"
 #include"Emotions/PADEmotion.h"
 #include<mutex>
@@ -58,7 +61,21 @@ using namespace std;
  class CharacterManager :public EntityManager  {
 	 friend class EmotionDecayTask;
 	//public static Logger sLog = Logger.getLogger("Alma");
+ public:
+	/**
+	* Level of detail of the affect simulation. Below <code>Full</code> the
+	* emotion decay and mood computation ticks of a character are deferred and
+	* integrated in batches, see <code>setImportance</code>.
+	*/
+	 enum class AffectLOD : int { Full = 0, Reduced, Distant, Background };
+
  private:
+	 enum class AffectTick : unsigned char { EmotionDecay = 0, MoodComputation };
+	 static const int sLODCOUNT = 4;
+	 /** lowest importance score for each level of detail */
+	 static const double sLODMINIMPORTANCE[sLODCOUNT];
+	 /** number of timer ticks integrated per batch for each level of detail */
+	 static const int sLODTICKFACTOR[sLODCOUNT];
 
 
 	 std::recursive_mutex _mutex;
@@ -77,6 +94,17 @@ using namespace std;
 	bool fAffectComputationPaused = false;
 	int emotionDecayId;
 	int moodDecayId;
+	/** the affect constants restored from a checkpoint, owned by this character */
+	std::shared_ptr<AffectConsts> fOwnAffectConsts;
+	/** this character's decay and mood timers, null while not running */
+	timer_manager::timer_ptr_t fEmotionTimer;
+	timer_manager::timer_ptr_t fMoodTimer;
+	double fImportance = 1.0;
+	AffectLOD fAffectLOD = AffectLOD::Full;
+	/** decay and mood ticks not yet integrated, in firing order; consecutive
+	* ticks of one kind share an entry with their number */
+	std::vector<std::pair<AffectTick, int>> fDeferredTicks;
+	int fDeferredTickCount[2] = { 0, 0 };
 	double memDecayTime;
 	BehaviorTree Btree;
 	Memory memory;
@@ -84,12 +112,106 @@ using namespace std;
 	AppraisalManager* appraisalManagerInstance;
 	std::unordered_map<std::string, BehaviorTree*> treeHolder;
 	static PersonalityMoodRelations* instance;
+	/** constants of Setup.json, read when the first character is created */
+	static json sSetup;
+	static std::mutex sSetupMutex;
+	/** CSV files the behavior trees and the memory log write to */
+	std::string fMoodLogFile = "./output/HighNegAgreeNoMem.csv";
+	std::string fMemoryLogFile = "./test/negativemed-Memorycapture.csv";
+	/** telemetry channels of the log files, opened on first use */
+	int fMoodChannel = -1;
+	int fMemoryChannel = -1;
+	/** initial size of the character's arena, fits engines plus a few emotion vectors */
+	static const size_t sARENABLOCKSIZE = 64 * 1024;
 	PersonalityMoodRelations* getInstance();
 	PersonalityMoodRelations* getInstance(Mood OpennessRelation, Mood ConscientiousnessRelation, Mood ExtraversionRelation, Mood AgreeablenessRelation, Mood NeurotismRelation
 		, Personality PleasureRelation, Personality ArousalRelation, Personality DominanceRelation);
 	
 
 	float random();
+
+	/**
+	* Copies mood, mood tendency and emotions into the lock-free affect
+	* snapshot. Must be called with the character lock held after every change
+	* of the affective state.
+	*/
+	void publishAffectSnapshot();
+
+	/**
+	* One emotion decay step and one mood computation step, without snapshot
+	* publication. Must be called with the character lock held.
+	*
+	* @param steps the number of consecutive decay ticks integrated in this
+	* step, the result equals that many single steps
+	*/
+	void decayStep(int steps = 1);
+	void moodStep();
+
+	/**
+	* Returns true if decay and mood ticks cannot change the affective state:
+	* no emotion is in the history and the mood rests at the default mood
+	* without neurotic mood changes.
+	*/
+	bool isAffectAtRest();
+
+	/**
+	* Entry point of the decay and mood timers. Runs the tick immediately at
+	* full level of detail, otherwise defers it and integrates all deferred
+	* ticks once enough of them have been collected.
+	*
+	* @param tick the kind of tick that fired
+	*/
+	void tickAffect(AffectTick tick);
+
+	/**
+	* Registers this character's emotion decay or mood computation timer,
+	* replacing the one that is running.
+	*
+	* @param repeat true if the timer fires periodically
+	*/
+	void startEmotionTimer(bool repeat);
+	void startMoodTimer(bool repeat);
+
+	/**
+	* Unregisters this character's emotion decay or mood computation timer, if
+	* running. The timers of other characters keep running.
+	*/
+	void stopEmotionTimer();
+	void stopMoodTimer();
+
+	 /** identifies a character checkpoint ("ALMC") and a population ("ALMP") */
+	 static const std::uint32_t sCHECKPOINTMAGIC = 0x434D4C41;
+	 static const std::uint32_t sPOPULATIONMAGIC = 0x504D4C41;
+	 static const std::uint32_t sCHECKPOINTVERSION = 7;
+
+	 /**
+	 * The constructor arguments stored at the start of a checkpoint.
+	 */
+	 struct CheckpointIdentity {
+		 std::string name;
+		 bool derivedPersonality = false;
+		 double traits[5] = {};
+		 std::list<EmotionType> emotions;
+	 };
+
+	 /**
+	 * Writes identity and affective state of this character. Must be called
+	 * with the character lock held and no deferred ticks.
+	 */
+	 void writeCheckpoint(BinaryWriter& out);
+
+	 static CheckpointIdentity readCheckpointIdentity(BinaryReader& in);
+
+	 /**
+	 * Replaces the affective state of this character by the state that
+	 * follows the identity in a checkpoint.
+	 */
+	 void readCheckpoint(BinaryReader& in, const CheckpointIdentity& identity);
+
+	 /**
+	 * Reads the header of a checkpoint and returns its payload.
+	 */
+	 static std::string readCheckpointPayload(std::istream& in);
 	/**
 	* The
 	* <code>EmotionDecayTask</code> class manages the emotion decay process.
@@ -102,8 +224,14 @@ using namespace std;
 		CharacterManager* character;
 	public:
 		//synchronized 
-		void  run() {			
-				character->fEmotionEngine->decay(character->fEmotionHistory, character->fEmotionVector, character->createEmotionVector());
+		void  run() {
+				std::unique_lock<std::recursive_mutex> lock(character->_mutex);
+				character->decayStep();
+				character->publishAffectSnapshot();
+		}
+
+		void tick() {
+			character->tickAffect(AffectTick::EmotionDecay);
 		}
 	};
 
@@ -124,13 +252,18 @@ using namespace std;
 	public:
 		//synchronized 
 		void  run() {
-			character->fCurrentMood = character->fMoodEngine->compute(character->fCurrentMood, character->fEmotionVector);
-			character->fCurrentMoodTendency = character->fMoodEngine->getCurrentMoodTendency();
+			std::unique_lock<std::recursive_mutex> lock(character->_mutex);
+			character->moodStep();
+			character->publishAffectSnapshot();
 		/*	if ((fAffectMonitor != nullptr) && fShowAffectMonitor) {
 				fAffectMonitor.updateMoodDisplay(fName, fEmotionVector, fMoodEngine.getEmotionsCenter(),
 					fDefaultMood, fCurrentMood, fCurrentMoodTendency);
 			}*/
 		}
+
+		void tick() {
+			character->tickAffect(AffectTick::MoodComputation);
+		}
 	};
 
  public:
@@ -144,12 +277,52 @@ using namespace std;
 	 bool runTree(std::string treename);
 
 	 void configSetup();
+
+	/**
+	* Replaces the constants otherwise read from Setup.json, e.g. for a run of
+	* a parameter sweep. Must be called before the first character is created.
+	*
+	* @param setup a document with the same fields as Setup.json
+	*/
+	 static void setSetup(const json& setup);
+
+	/**
+	* Sets the CSV files the character's mood log (written by the behavior
+	* tree) and memory log are appended to.
+	*
+	* @param moodLogFile path of the mood log
+	* @param memoryLogFile path of the memory log
+	*/
+	 void setOutputFiles(std::string moodLogFile, std::string memoryLogFile);
+
+	 std::string getMoodLogFile();
+
+	 std::string getMemoryLogFile();
+
+	/**
+	* Returns the telemetry channel of the mood log, opening it on first use.
+	*
+	* @return the channel id for <code>Telemetry::submit</code>
+	*/
+	 int getMoodChannel();
+
+	/**
+	* Returns the telemetry channel of the memory log, opening it on first use.
+	*
+	* @return the channel id for <code>Telemetry::submit</code>
+	*/
+	 int getMemoryChannel();
 	
 
 	 CharacterManager(std::string name, Personality personality,
 		 AffectConsts* ac, bool derivedPersonality,
 		 DecayFunction* decayFunction,
 		 std::list<EmotionType> emotions);
+
+	/**
+	* Stops the character's timers and releases all its affect objects at once.
+	*/
+	 ~CharacterManager();
 		
  
 	 void incermentTime();
@@ -159,6 +332,25 @@ using namespace std;
 
 	 void 
 		 emotionAffector(std::string memoryName);
+
+	/**
+	* Returns the k long term memories made in the moods closest to the
+	* character's current mood, the closest first.
+	*
+	* @param k the maximal number of memories
+	* @return the memories, owned by the character's memory
+	*/
+	 std::vector<longTermMem*> recallByMood(size_t k);
+
+	/**
+	* Persists the character's long term memory in the specified append-only
+	* log. Memories already in the file are loaded, so a campaign continues
+	* with what the character remembered at the end of the last session.
+	*
+	* @param path the log file
+	* @throws std::invalid_argument if the file is not a memory log
+	*/
+	 void setMemoryLog(std::string path);
 	/**
 	* Starts emotion decay, if not running.
 	*/
@@ -312,7 +504,7 @@ using namespace std;
 	*/
 	 void disableMoodComputation();
 
-	 void addEEC(EEC* eec);
+	 void addEEC(const EEC& eec);
 
 	/**
 	* Sets a new emotion decay function and decaySteps and reinitialize the
@@ -344,7 +536,10 @@ using namespace std;
 	 EmotionHistory* getEmotionHistory();
 
 	/**
-	* Returns the character's emotion engine
+	* Returns the character's emotion engine. The engines live in the
+	* character's arena and are rebuilt in place, so the pointer stays valid
+	* for the lifetime of the character; pointers into an engine's members do
+	* not survive a rebuild.
 	*
 	* @return an EmotionEngine object
 	*/
@@ -352,6 +547,12 @@ using namespace std;
 	 EmotionEngine* getEmotionEngine();
 
 	 MoodEngine* getMoodEngine();
+
+	/**
+	* Returns a copy of the PAD center of the active emotions the mood engine
+	* computed last.
+	*/
+	 EmotionPADCentroid getEmotionsCenter();
 	/**
 	* Sets a new personality for this character and reinitialize the character's
 	* emotion computation engine.
@@ -415,6 +616,106 @@ using namespace std;
 
 
 	 void computeMood();
+
+	/**
+	* Sets how relevant this character currently is (e.g. derived from the
+	* distance to the camera or player) and selects the level of detail of
+	* its affect simulation:
+	* <ul>
+	* <li>&gt;= 0.75 <code>Full</code>: every decay and mood tick is computed</li>
+	* <li>&gt;= 0.5 <code>Reduced</code>: ticks are integrated every 4th tick</li>
+	* <li>&gt;= 0.25 <code>Distant</code>: every 16th tick</li>
+	* <li>otherwise <code>Background</code>: every 64th tick</li>
+	* </ul>
+	* Deferred ticks are replayed in their original order, so the state after
+	* integration is the same as with full-rate simulation; only consecutive
+	* decay ticks are integrated in one step. Ticks that fire
+	* while the character is at rest are no-ops and are dropped. Promotion to
+	* <code>Full</code> and every appraisal integrates pending ticks first.
+	*
+	* @param importance importance score, usually in [0,1]
+	*/
+	 void setImportance(double importance);
+
+	 double getImportance();
+
+	 AffectLOD getAffectLOD();
+
+	/**
+	* Integrates all deferred decay and mood ticks in their firing order.
+	* Consecutive decay ticks are integrated in a single decay step, every
+	* mood tick is computed on its own, as the mood depends on the emotions
+	* of its tick.
+	*/
+	 void catchUpAffect();
+
+	/**
+	* Writes a binary checkpoint of the character: personality, affect
+	* constants, moods, emotion vector and history, the mood engine state, the
+	* decay progress of all decaying emotions, memories and the level of
+	* detail. Pending emotion eliciting conditions and timers are not part of
+	* a checkpoint. The format is machine dependent (byte order and type
+	* sizes of the build).
+	*
+	* @param out the binary output stream
+	*/
+	 void saveCheckpoint(std::ostream& out);
+
+	/**
+	* Replaces the state of this character by a checkpoint written by
+	* <code>saveCheckpoint</code>. The character takes over the name,
+	* personality and emotion types stored in the checkpoint. The affect
+	* constants and emotion relations of the checkpoint are restored into
+	* copies owned by this character; objects it shared with other
+	* characters are left unchanged.
+	*
+	* @param in the binary input stream
+	* @throws invalid_argument if the stream does not contain a valid checkpoint
+	*/
+	 void loadCheckpoint(std::istream& in);
+
+	/**
+	* Creates a new character with the affective state of this one, e.g. to
+	* evaluate alternative decisions. The copy has its own copy of the affect
+	* constants and shares the decay function of this character.
+	*
+	* @param name the name of the new character
+	* @return the new character, owned by the caller
+	*/
+	 CharacterManager* fork(std::string name);
+
+	/**
+	* Creates a new character from a checkpoint written by
+	* <code>saveCheckpoint</code>.
+	*
+	* @param in the binary input stream
+	* @param ac the affect constants the new character is created with, the
+	*        ones of the checkpoint are restored into a copy
+	* @param decayFunction the decay function of the new character
+	* @return the new character, owned by the caller
+	* @throws invalid_argument if the stream does not contain a valid checkpoint
+	*/
+	 static CharacterManager* restoreCheckpoint(std::istream& in, AffectConsts* ac, DecayFunction* decayFunction);
+
+	/**
+	* Writes the checkpoints of several characters as one population.
+	*
+	* @param out the binary output stream
+	* @param characters the characters to save
+	*/
+	 static void savePopulation(std::ostream& out, const std::vector<CharacterManager*>& characters);
+
+	/**
+	* Creates all characters of a population written by
+	* <code>savePopulation</code>.
+	*
+	* @param in the binary input stream
+	* @param ac the affect constants of the new characters
+	* @param decayFunction the decay function of the new characters
+	* @return the new characters in saved order, owned by the caller
+	* @throws invalid_argument if the stream does not contain a valid population
+	*/
+	 static std::vector<CharacterManager*> restorePopulation(std::istream& in, AffectConsts* ac, DecayFunction* decayFunction);
 	 
 };
 
@@ -6,6 +6,10 @@
 #include "Personality/Personality.h"
 #include "Data/AffectConsts.h"
 #include "Emotions/EmotionType.h"
+#include "affectsnapshot.h"
+#include "Data/AffectArena.h"
+#include <cmath>
+#include <cstdint>
 
 #include"Personality/PersonalityMoodRelations.h"
 
@@ -33,6 +37,25 @@ protected:
 	std::shared_ptr<EmotionVector> fEmotionVector = nullptr;
 	std::list<EmotionType> fAvailEmotions ;
 	AffectConsts* fAc = nullptr;
+	/** memory for the entity's emotions, nullptr allocates on the heap */
+	std::shared_ptr<AffectArena> fArena = nullptr;
+	/** lock-free copy of the affective state for other threads */
+	AffectSnapshotBuffer fAffectSnapshot;
+	/** handed out for unknown rule keys, so callers can adjust it like a rule */
+	AppraisalVariables fNoAppraisal;
+	/** the default emotions, rebuilt only when mood or personality moved */
+	std::shared_ptr<EmotionVector> fDefaultEmotions = nullptr;
+	/** the mood, traits and emotion types the default emotions were built for */
+	Mood fDefaultEmotionsMood;
+	double fDefaultEmotionsTraits[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	std::uint32_t fDefaultEmotionsTypes = 0;
+	/** counts the rebuilds of the default emotions */
+	std::uint64_t fDefaultEmotionsVersion = 0;
+
+	AppraisalVariables* noAppraisal() {
+		fNoAppraisal = AppraisalVariables();
+		return &fNoAppraisal;
+	}
 	//private Logger log = Logger.getLogger(Logger.GLOBAL_LOGGER_NAME);;
 
 public:
@@ -119,8 +142,7 @@ public:
 	 AppraisalVariables* getAppraisalVariables(std::string key) {
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
 		AppraisalVariables* appVars = fAppraisalRules->getAppraisalVariables(fName, key);
-		appVars = (appVars == nullptr) ? new AppraisalVariables() : appVars;
-		return appVars;
+		return (appVars == nullptr) ? noAppraisal() : appVars;
 	}
 
 	/**
@@ -135,10 +157,8 @@ public:
 	*/
 	 AppraisalVariables* getAppraisalVariables(std::string key, std::string type) {
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		AppraisalVariables* appVars =
-			fAppraisalRules->getAppraisalRulesByType(fName, type).getAppraisalVariables(fName, key);
-		appVars = (appVars == nullptr) ? new AppraisalVariables[0] : appVars;
-		return appVars;
+		AppraisalVariables* appVars = fAppraisalRules->getAppraisalVariables(fName, key, type);
+		return (appVars == nullptr) ? noAppraisal() : appVars;
 	}
 
 	/**
@@ -154,8 +174,7 @@ public:
 	 AppraisalVariables* getAppraisalVariables(EntityManager entity, std::string key) {
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
 		AppraisalVariables* appVars = fAppraisalRules->getAppraisalVariables(entity.getName(), key);
-		appVars = (appVars == nullptr) ? new AppraisalVariables[0] : appVars;
-		return appVars;
+		return (appVars == nullptr) ? noAppraisal() : appVars;
 	}
 
 	/**
@@ -171,10 +190,8 @@ public:
 	*/
 	 AppraisalVariables* getAppraisalVariables(EntityManager entity, std::string key, std::string type) {
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		AppraisalVariables* appVars =
-			fAppraisalRules->getAppraisalRulesByType(entity.getName(), type).getAppraisalVariables(entity.getName(), key);
-		appVars = (appVars == nullptr) ? new AppraisalVariables[0] : appVars;
-		return appVars;
+		AppraisalVariables* appVars = fAppraisalRules->getAppraisalVariables(entity.getName(), key, type);
+		return (appVars == nullptr) ? noAppraisal() : appVars;
 	}
 
 	/**
@@ -256,14 +273,96 @@ public:
 		return fEmotionVector;
 	}
 
+	/**
+	* Returns the last published snapshot of this entity's affective state.
+	* This method takes no lock and can be called from any thread, e.g. by
+	* render or AI code running alongside the affect computation.
+	*
+	* @return a consistent copy of mood, mood tendency and emotions
+	*/
+	 AffectSnapshot getAffectSnapshot() const {
+		return fAffectSnapshot.read();
+	}
+
 	 AffectConsts* getAffectConsts() {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		return fAc;
 	}
 
+	/**
+	* Returns a new emotion vector holding the default emotions of the
+	* available types, every emotion at its baseline for the current
+	* personality and mood.
+	* <br>
+	* The default emotions are cached and only rebuilt when a trait or the
+	* mood moved by more than <code>AffectConsts::defaultEmotionsEpsilon</code>
+	* or the available emotion types changed. The returned vector is a copy
+	* sharing the cached emotions; emotions at their baseline are never
+	* changed in place, callers replace them.
+	*/
 	 std::shared_ptr<EmotionVector> createEmotionVector() {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		return std::make_shared< EmotionVector>(fPersonality, fCurrentMood, fAvailEmotions);
+		double traits[5];
+		fPersonality.getTraits(traits);
+		std::uint32_t types = 0;
+		for (EmotionType type : fAvailEmotions)
+			types |= (1u << type);
+		double epsilon = (fAc != nullptr) ? fAc->defaultEmotionsEpsilon : 0.0;
+		bool moved = (fDefaultEmotions == nullptr) || (types != fDefaultEmotionsTypes)
+			|| (std::fabs(fCurrentMood.getPleasure() - fDefaultEmotionsMood.getPleasure()) > epsilon)
+			|| (std::fabs(fCurrentMood.getArousal() - fDefaultEmotionsMood.getArousal()) > epsilon)
+			|| (std::fabs(fCurrentMood.getDominance() - fDefaultEmotionsMood.getDominance()) > epsilon);
+		for (int i = 0; !moved && (i < 5); i++)
+			moved = std::fabs(traits[i] - fDefaultEmotionsTraits[i]) > epsilon;
+		if (moved) {
+			fDefaultEmotions = AffectArena::makeShared<EmotionVector>(fArena, fPersonality, fCurrentMood, fAvailEmotions, fArena);
+			fDefaultEmotionsMood = fCurrentMood;
+			for (int i = 0; i < 5; i++)
+				fDefaultEmotionsTraits[i] = traits[i];
+			fDefaultEmotionsTypes = types;
+			fDefaultEmotionsVersion++;
+		}
+		return AffectArena::makeShared<EmotionVector>(fArena, *fDefaultEmotions);
+	}
+
+	/**
+	* Drops the cached default emotions, needed when the baselines change
+	* without a change of mood or traits, e.g. new personality emotion
+	* relations.
+	*/
+	 void invalidateDefaultEmotions() {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		fDefaultEmotions = nullptr;
+	}
+
+	/**
+	* Returns the number of times the default emotions were built.
+	*/
+	 std::uint64_t getDefaultEmotionsVersion() {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return fDefaultEmotionsVersion;
+	}
+
+	/**
+	* Returns an empty emotion vector for the available emotion types. The
+	* emotion history stores such deltas, holding only the emotions an event
+	* changed.
+	*/
+	 std::shared_ptr<EmotionVector> createEmotionDelta() {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		std::uint32_t types = 0;
+		for (EmotionType type : fAvailEmotions)
+			types |= (1u << type);
+		return AffectArena::makeShared<EmotionVector>(fArena, types);
+	}
+
+	/**
+	* Returns the baseline of an emotion of the specified type for the
+	* current personality and mood.
+	*/
+	 double getEmotionBaseline(EmotionType type) {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return EmotionVector::getBaseline(fPersonality, fCurrentMood, type);
 	}
 
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include"Mood/Mood.h"
+#include<cstdint>
 
 struct longTermMem
 {
@@ -9,6 +10,18 @@ struct longTermMem
 	std::string reaction;
 	double intensity;
 	std::string trigger;
+	/** memory clock values of the creation and of the last lookup, used for eviction */
+	unsigned long created = 0;
+	unsigned long lastUsed = 0;
+	/** time the memory was made, <code>intensity</code> is the intensity at that time */
+	double time = 0.0;
+	/**
+	* time invariant ordering key, log|intensity| + time / decay time; the
+	* memory with the larger key has the larger intensity at any later time
+	*/
+	double strength = 0.0;
+	/** id of the memory in the character's memory log */
+	std::uint64_t id = 0;
 
 	longTermMem(std::string emo, std::string Name, std::string Trigger,  Mood theMood, double Intensity)//std::string Reaction,
 	{
@@ -34,12 +47,20 @@ struct shortTermMem
 	std::string reaction;
 	double intensity; 
 	std::string trigger;
+	/** memory clock values of the creation and of the last lookup, used for eviction */
+	unsigned long created = 0;
+	unsigned long lastUsed = 0;
+	/** time the memory was made */
+	double time = 0.0;
+	/** true once the memory has been consolidated into the long term memory */
+	bool promoted = false;
 
 	shortTermMem(std::string emo, std::string Name,  std::string Trigger,  Mood theMood, double Intensity)//std::string Reaction,
 	{
 		mood = theMood;
 		emotion = emo;
 		name = Name;
+		trigger = Trigger;
 		//reaction = Reaction;
 		intensity = Intensity;
 	}
@@ -5,89 +5,631 @@
 #include"Emotions/EmotionType.h"
 #include <unordered_map>
 #include "MemStructs.h"
+#include "MemoryMoodIndex.h"
+#include "MemoryLog.h"
 #include "Apprasial/apprasialvariables.h"
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_set>
+#include <memory>
+#include <cstdint>
 
+/**
+* Capacities and eviction policy of a character's memory.
+*/
+struct MemoryPolicy
+{
+	/**
+	* Which memories are dropped when a tier is full: the weakest (lowest
+	* absolute intensity), the oldest, or the least recently recalled ones.
+	*/
+	enum Eviction { Intensity, Recency, LRU };
+
+	/** maximal number of short term memories, 0 is unbounded */
+	size_t shortCapacity = 64;
+	/** maximal number of long term memories, 0 is unbounded */
+	size_t longCapacity = 1024;
+	/** number of new short term memories that triggers a consolidation */
+	size_t consolidationBatch = 8;
+	/**
+	* time after which a long term memory has decayed to 1/e of its intensity,
+	* in units of the memory time, 0 disables the decay
+	*/
+	double decayTime = 50.0;
+	Eviction eviction = Intensity;
+
+	/**
+	* Returns the eviction policy with the specified name ("intensity",
+	* "recency" or "lru").
+	*
+	* @param name the name of the policy
+	* @return the policy
+	* @throws std::invalid_argument if the name is unknown
+	*/
+	static Eviction evictionByName(const std::string& name)
+	{
+		if (name == "intensity")
+			return Intensity;
+		if (name == "recency")
+			return Recency;
+		if (name == "lru")
+			return LRU;
+		throw std::invalid_argument("Unknown memory eviction policy '" + name + "'");
+	}
+};
+
+/**
+* The episodic memory of a character. Long term memories are kept in the order
+* they were made and are additionally indexed by the entity they are about and
+* by their emotion, and the strongest memory about every entity is tracked, so
+* the memory driven affect lookups do not depend on the number of memories.
+* <br>
+* Long term memories decay exponentially from the time they were made. A
+* memory stores its initial intensity and time, its current intensity is
+* evaluated in closed form when it is asked for (<code>getIntensity</code>).
+* Since all memories share the decay time, their order by intensity never
+* changes over time and the strongest memory of an entity stays valid without
+* touching the other memories.
+* <br>
+* New memories go to the short term memory and are consolidated into the long
+* term memory in batches, either when enough of them are pending or when
+* <code>consolidate</code> is called (once per simulation step). Both tiers are
+* bounded by the capacities of the <code>MemoryPolicy</code>; when a tier
+* overflows the memories ranked lowest by the eviction policy are dropped in
+* one pass, so the footprint of a character stays bounded over long sessions.
+* <br>
+* The memory owns its entries. <code>Short</code> and <code>Long</code> may be
+* read directly but must only be changed through the methods of this class.
+*/
 class Memory
 {
 private:
-	
+	typedef std::vector<longTermMem*> Bucket;
+
+	/** long term memories by the entity (name) they are about, in insertion order */
+	std::unordered_map<std::string, Bucket> fByName;
+	/** long term memories by emotion, in insertion order */
+	std::unordered_map<std::string, Bucket> fByEmotion;
+	/** the memory with the highest absolute intensity of every entity */
+	std::unordered_map<std::string, longTermMem*> fStrongest;
+	/** long term memories by their mood at encoding time */
+	MemoryMoodIndex fMoodIndex;
+	MemoryPolicy fPolicy;
+	/** short term memories not consolidated yet */
+	size_t fPending = 0;
+	/** logical clock stamping creation and recall of memories */
+	unsigned long fClock = 0;
+	/** the current memory time */
+	double fTime = 0.0;
+	/** id of the last long term memory */
+	std::uint64_t fLastId = 0;
+	/** the file the long term memory is persisted to, nullptr if none */
+	std::shared_ptr<MemoryLog> fLog = nullptr;
+
+	static const Bucket& emptyBucket()
+	{
+		static const Bucket empty;
+		return empty;
+	}
+
+	/**
+	* Returns the memory with the highest absolute intensity of a bucket; on
+	* equal intensities the most recent one wins.
+	*/
+	static longTermMem* strongestOf(const Bucket& bucket)
+	{
+		longTermMem* strongest = nullptr;
+		for (longTermMem* m : bucket)
+		{
+			if ((strongest == nullptr) || (m->strength >= strongest->strength))
+				strongest = m;
+		}
+		return strongest;
+	}
+
+	double strengthOf(const longTermMem* m) const
+	{
+		double strength = log(fabs(m->intensity));
+		if (fPolicy.decayTime > 0.0)
+			strength += m->time / fPolicy.decayTime;
+		return strength;
+	}
+
+	void index(longTermMem* m)
+	{
+		m->strength = strengthOf(m);
+		fByName[m->name].push_back(m);
+		fByEmotion[m->emotion].push_back(m);
+		fMoodIndex.insert(m);
+		longTermMem*& strongest = fStrongest[m->name];
+		if ((strongest == nullptr) || (m->strength >= strongest->strength))
+			strongest = m;
+	}
+
+	static double rankingIntensity(const shortTermMem* m)
+	{
+		return fabs(m->intensity);
+	}
+
+	static double rankingIntensity(const longTermMem* m)
+	{
+		return m->strength;
+	}
+
+	static void unindex(std::unordered_map<std::string, Bucket>& buckets, const std::string& key, longTermMem* m)
+	{
+		auto it = buckets.find(key);
+		if (it == buckets.end())
+			return;
+		it->second.erase(std::remove(it->second.begin(), it->second.end(), m), it->second.end());
+		if (it->second.empty())
+			buckets.erase(it);
+	}
+
+	template<class T>
+	T* touch(T* m)
+	{
+		if (m != nullptr)
+			m->lastUsed = ++fClock;
+		return m;
+	}
+
+	/**
+	* Returns true if the policy keeps <code>a</code> rather than <code>b</code>.
+	*/
+	template<class T>
+	bool ranksHigher(const T* a, const T* b) const
+	{
+		switch (fPolicy.eviction)
+		{
+		case MemoryPolicy::Intensity:
+			if (rankingIntensity(a) != rankingIntensity(b))
+				return rankingIntensity(a) > rankingIntensity(b);
+			return a->created > b->created;
+		case MemoryPolicy::LRU:
+			if (a->lastUsed != b->lastUsed)
+				return a->lastUsed > b->lastUsed;
+			return a->created > b->created;
+		default:
+			return a->created > b->created;
+		}
+	}
+
+	/**
+	* Selects the entries that are dropped to shrink a tier to the specified
+	* size. A single selection pass, the order of the tier is not changed.
+	*/
+	template<class T>
+	std::unordered_set<T*> selectEvicted(const std::vector<T*>& entries, size_t size) const
+	{
+		std::unordered_set<T*> evicted;
+		if (entries.size() <= size)
+			return evicted;
+		std::vector<T*> ranked(entries);
+		std::nth_element(ranked.begin(), ranked.begin() + size, ranked.end(),
+			[this](const T* a, const T* b) { return ranksHigher(a, b); });
+		evicted.insert(ranked.begin() + size, ranked.end());
+		return evicted;
+	}
+
+	void evictShort()
+	{
+		if ((fPolicy.shortCapacity == 0) || (Short.size() <= fPolicy.shortCapacity))
+			return;
+		// never drop a memory before it reached the long term memory
+		if (fPending > 0)
+			promotePending();
+		std::unordered_set<shortTermMem*> evicted = selectEvicted(Short, fPolicy.shortCapacity);
+		Short.erase(std::remove_if(Short.begin(), Short.end(), [&evicted](shortTermMem* m) {
+			if (evicted.count(m) == 0)
+				return false;
+			delete m;
+			return true;
+		}), Short.end());
+	}
+
+	void evictLong()
+	{
+		if ((fPolicy.longCapacity == 0) || (Long.size() <= fPolicy.longCapacity))
+			return;
+		std::unordered_set<longTermMem*> evicted = selectEvicted(Long, fPolicy.longCapacity);
+		std::unordered_set<std::string> entities;
+		for (longTermMem* m : evicted)
+		{
+			unindex(fByName, m->name, m);
+			unindex(fByEmotion, m->emotion, m);
+			fMoodIndex.remove(m);
+			entities.insert(m->name);
+			if (fLog)
+				fLog->remove(m->id);
+		}
+		for (const std::string& name : entities)
+		{
+			auto it = fByName.find(name);
+			if (it == fByName.end())
+				fStrongest.erase(name);
+			else
+				fStrongest[name] = strongestOf(it->second);
+		}
+		Long.erase(std::remove_if(Long.begin(), Long.end(), [&evicted](longTermMem* m) {
+			if (evicted.count(m) == 0)
+				return false;
+			delete m;
+			return true;
+		}), Long.end());
+	}
+
+	void promotePending()
+	{
+		for (shortTermMem* m : Short)
+		{
+			if (m->promoted)
+				continue;
+			m->promoted = true;
+			longTermMem* promoted = new longTermMem(m->emotion, m->name, m->trigger, m->mood, m->intensity);
+			promoted->reaction = m->reaction;
+			promoted->time = m->time;
+			promoted->created = m->created;
+			promoted->lastUsed = m->lastUsed;
+			store(promoted);
+		}
+		fPending = 0;
+	}
+
+	/**
+	* Adds a complete long term memory to the memory, its indexes and the log.
+	*/
+	void store(longTermMem* m)
+	{
+		m->id = ++fLastId;
+		Long.push_back(m);
+		index(m);
+		if (fLog)
+			fLog->append(*m);
+	}
+
+	void clear()
+	{
+		for (shortTermMem* m : Short)
+			delete m;
+		for (longTermMem* m : Long)
+			delete m;
+		Short.clear();
+		Long.clear();
+		fByName.clear();
+		fByEmotion.clear();
+		fStrongest.clear();
+		fMoodIndex.clear();
+		fPending = 0;
+	}
+
 public:
 
 	typedef EmotionType Type;
-   
-	
+
+
 	std::vector<shortTermMem*> Short;
 	std::vector<longTermMem*> Long;
 
+	Memory()
+	{
+	}
+
+	Memory(const Memory&) = delete;
+	Memory& operator=(const Memory&) = delete;
+
+	~Memory()
+	{
+		// pending memories would be lost otherwise
+		if (fLog)
+		{
+			try
+			{
+				consolidate();
+			}
+			catch (const std::exception&)
+			{
+				// the log keeps its old file, a destructor must not throw
+				fLog->flush();
+			}
+		}
+		clear();
+	}
+
+	/**
+	* Sets the capacities and the eviction policy. Tiers above the new
+	* capacities are shrunk immediately.
+	*
+	* @param policy the new policy
+	*/
+	void setPolicy(const MemoryPolicy& policy)
+	{
+		bool rekey = (policy.decayTime != fPolicy.decayTime);
+		fPolicy = policy;
+		if (rekey)
+		{
+			for (longTermMem* m : Long)
+				m->strength = strengthOf(m);
+			for (auto& entry : fByName)
+				fStrongest[entry.first] = strongestOf(entry.second);
+		}
+		evictShort();
+		evictLong();
+	}
+
+	const MemoryPolicy& getPolicy() const
+	{
+		return fPolicy;
+	}
+
+	/**
+	* Adds a short term memory. It becomes part of the long term memory with
+	* the next consolidation.
+	*/
 	void addShortMemory(std::string emo, std::string Name, std::string Trigger, Mood theMood, double intensity, std::string memname)// std::string Reaction,
 	{
 		Short.emplace_back( new shortTermMem(emo, Name,Trigger,  theMood, intensity));		// find a way to name differciate between the memories Reaction,
-		addLongMemory(emo, Name, Trigger, theMood, intensity, memname);
+		Short.back()->created = Short.back()->lastUsed = ++fClock;
+		Short.back()->time = fTime;
+		fPending++;
+		if (fPending >= fPolicy.consolidationBatch)
+			consolidate();
+		else
+			evictShort();
 	}
-	
+
 	void addLongMemory(std::string emo, std::string Name, std::string Trigger,  Mood theMood, double intensity, std::string memname)//std::string Reaction,
 	{
-		Long.emplace_back(new longTermMem(emo, Name, Trigger,  theMood, intensity));//Reaction,
+		longTermMem* m = new longTermMem(emo, Name, Trigger,  theMood, intensity);//Reaction,
+		m->created = m->lastUsed = ++fClock;
+		m->time = fTime;
+		store(m);
 	}
 
-	void removeShortTermMemory(std::string key)
+	/**
+	* Moves all pending short term memories into the long term memory and
+	* applies the capacities of both tiers.
+	*/
+	void consolidate()
 	{
-		for (int i = 0; i < Short.size(); i++)
+		if (fPending > 0)
+			promotePending();
+		evictShort();
+		evictLong();
+		if (fLog)
 		{
-			if (Short[i]->name == key)
-				Short.erase(Short.begin() + i);
+			if (fLog->needsCompaction())
+				fLog->compact(Long);
+			fLog->flush();
 		}
 	}
 
-	void removeLongTermMemory(std::string key)
+	/**
+	* Persists the long term memory to the specified log file. If the file holds
+	* memories they replace the current long term memory (a character resuming
+	* a campaign), otherwise the current long term memories are written to it.
+	* The memory time is advanced to the latest memory of the file.
+	*
+	* @param log the log
+	* @throws std::invalid_argument if the file is not a memory log
+	*/
+	void attachLog(std::shared_ptr<MemoryLog> log)
 	{
-		for (int i = 0; i < Long.size(); i++)
+		double time = fTime;
+		std::vector<longTermMem*> replayed = log->replay(time);
+		fLog = nullptr;
+		if (!replayed.empty())
+		{
+			for (longTermMem* m : Long)
+			{
+				unindex(fByName, m->name, m);
+				unindex(fByEmotion, m->emotion, m);
+				fMoodIndex.remove(m);
+				delete m;
+			}
+			Long.clear();
+			fStrongest.clear();
+			fTime = time;
+			for (longTermMem* m : replayed)
+			{
+				m->created = m->lastUsed = ++fClock;
+				fLastId = (std::max)(fLastId, m->id);
+				Long.push_back(m);
+				index(m);
+			}
+			fLog = log;
+			if (fLog->needsCompaction())
+				fLog->compact(Long);
+		}
+		else
 		{
-			if (Long[i]->name == key)
-				Long.erase(Long.begin()+i);
+			fLog = log;
+			fLog->compact(Long);
 		}
+		consolidate();
 	}
-	longTermMem* getMemorybyEmotion(std::string emo)
+
+	std::shared_ptr<MemoryLog> getLog() const
+	{
+		return fLog;
+	}
+
+	size_t getPendingCount() const
+	{
+		return fPending;
+	}
+
+	/**
+	* Advances the memory time. New memories are stamped with it and the
+	* intensities of long term memories are evaluated at it.
+	*
+	* @param time the new memory time
+	*/
+	void setTime(double time)
+	{
+		fTime = time;
+	}
+
+	double getTime() const
+	{
+		return fTime;
+	}
+
+	/**
+	* Returns the intensity of a long term memory at the current memory time.
+	*
+	* @param m a long term memory
+	* @return the decayed intensity
+	*/
+	double getIntensity(const longTermMem* m) const
 	{
-		for (int i = 0; i < Long.size(); i++)
+		if (fPolicy.decayTime <= 0.0)
+			return m->intensity;
+		return m->intensity * exp(-(fTime - m->time) / fPolicy.decayTime);
+	}
+
+	/**
+	* Replaces all memories, e.g. when a checkpoint is restored. The memory takes
+	* ownership of the specified entries. Short term memories that are not
+	* <code>promoted</code> stay pending until the next consolidation.
+	*
+	* @param shortMemories the new short term memories
+	* @param longMemories the new long term memories, oldest first
+	*/
+	void assign(std::vector<shortTermMem*> shortMemories, std::vector<longTermMem*> longMemories)
+	{
+		clear();
+		Short = std::move(shortMemories);
+		Long = std::move(longMemories);
+		for (shortTermMem* m : Short)
 		{
-			if (Long[i]->emotion == emo)
-				return Long[i];
+			m->created = m->lastUsed = ++fClock;
+			if (!m->promoted)
+				fPending++;
+		}
+		for (longTermMem* m : Long)
+		{
+			m->created = m->lastUsed = ++fClock;
+			m->id = ++fLastId;
+			index(m);
+		}
+		if (fLog)
+			fLog->compact(Long);
+		if (fPending >= fPolicy.consolidationBatch)
+			consolidate();
+		else
+		{
+			evictShort();
+			evictLong();
 		}
 	}
 
-	longTermMem* getMemorybyName(std::string name)
+	void removeShortTermMemory(std::string key)
+	{
+		auto last = std::remove_if(Short.begin(), Short.end(), [this, &key](shortTermMem* m) {
+			if (m->name != key)
+				return false;
+			if (!m->promoted)
+				fPending--;
+			delete m;
+			return true;
+		});
+		Short.erase(last, Short.end());
+	}
+
+	void removeLongTermMemory(std::string key)
 	{
-		for(int i = 0; i<Long.size(); i++)
+		auto it = fByName.find(key);
+		if (it == fByName.end())
+			return;
+		for (longTermMem* m : it->second)
 		{
-			if (Long[i]->name == name)
-				return Long[i];
+			unindex(fByEmotion, m->emotion, m);
+			fMoodIndex.remove(m);
 		}
+		fByName.erase(it);
+		fStrongest.erase(key);
+		auto last = std::remove_if(Long.begin(), Long.end(), [this, &key](longTermMem* m) {
+			if (m->name != key)
+				return false;
+			if (fLog)
+				fLog->remove(m->id);
+			delete m;
+			return true;
+		});
+		Long.erase(last, Long.end());
 	}
 
-	void decay( double time)
+	/**
+	* Returns the oldest long term memory with the specified emotion.
+	*
+	* @param emo the name of the emotion
+	* @return the memory, nullptr if there is none
+	*/
+	longTermMem* getMemorybyEmotion(std::string emo)
 	{
-		for (int i = 0; i < Long.size(); i++)
-		{
-			if (Long[i]->intensity > 0)
-			{
-				double temp = Long[i]->intensity* pow(1 + time/(Long.size() - i), 0.2);
-				if (temp <= 0.0)
-					Long[i]->intensity = 0.000000001;
-				else
-					Long[i]->intensity = temp;
-			}
-			else if (Long[i]->intensity < 0)
-			{
-				double temp = Long[i]->intensity* pow(1 + time/(Long.size() - i), -0.2);
-				if (temp >= 0)
-					Long[i]->intensity = -0.000000001;
-				else
-					Long[i]->intensity = temp;
-			}
+		auto it = fByEmotion.find(emo);
+		return (it == fByEmotion.end()) ? nullptr : touch(it->second.front());
+	}
 
-		}
-		
+	/**
+	* Returns the oldest long term memory about the specified entity.
+	*
+	* @param name the name of the entity
+	* @return the memory, nullptr if there is none
+	*/
+	longTermMem* getMemorybyName(std::string name)
+	{
+		auto it = fByName.find(name);
+		return (it == fByName.end()) ? nullptr : touch(it->second.front());
+	}
+
+	/**
+	* Returns the long term memory about the specified entity with the highest
+	* absolute intensity. On equal intensities the most recent one is returned.
+	*
+	* @param name the name of the entity
+	* @return the memory, nullptr if there is none
+	*/
+	longTermMem* getStrongestMemory(const std::string& name)
+	{
+		auto it = fStrongest.find(name);
+		return (it == fStrongest.end()) ? nullptr : touch(it->second);
+	}
+
+	/**
+	* Returns the k long term memories made in the moods most similar to the
+	* specified one (mood congruent recall), the most similar first.
+	*
+	* @param mood the mood, usually the character's current mood
+	* @param k the maximal number of memories
+	* @return the memories
+	*/
+	std::vector<longTermMem*> recallByMood(Mood mood, size_t k)
+	{
+		std::vector<longTermMem*> memories = fMoodIndex.nearest(mood.getPleasure(), mood.getArousal(), mood.getDominance(), k);
+		for (longTermMem* m : memories)
+			touch(m);
+		return memories;
+	}
+
+	/**
+	* Returns all long term memories about the specified entity, oldest first.
+	*/
+	const std::vector<longTermMem*>& getMemoriesbyName(const std::string& name)
+	{
+		auto it = fByName.find(name);
+		return (it == fByName.end()) ? emptyBucket() : it->second;
+	}
+
+	/**
+	* Returns all long term memories with the specified emotion, oldest first.
+	*/
+	const std::vector<longTermMem*>& getMemoriesbyEmotion(const std::string& emo)
+	{
+		auto it = fByEmotion.find(emo);
+		return (it == fByEmotion.end()) ? emptyBucket() : it->second;
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,269 @@
+#pragma once
+#include "MemStructs.h"
+#include "Data/BinaryStream.h"
+#include "Data/MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* The class <code>MemoryLog</code> persists the long term memories of one
+* character in an append-only binary file. Every new memory is appended as a
+* record, every dropped memory as a tombstone, so a change never rewrites the
+* file. When tombstones make up half of the file it is compacted, i.e.
+* rewritten with the live memories only.
+* <br>
+* On load the file is memory mapped and replayed in place. A record cut off
+* by a crash ends the replay; the damaged tail is removed by the compaction
+* that follows.
+* <br>
+* Layout: a header (magic, version) followed by records of the form
+* <code>[u32 size][u8 type][payload]</code>.
+*
+* @version 1.0
+*/
+class MemoryLog
+{
+	static const std::uint32_t sMAGIC = 0x4D4D4C41;
+	static const std::uint32_t sVERSION = 1;
+	/** the file is only compacted once it holds this many tombstones */
+	static const size_t sMINTOMBSTONES = 256;
+
+	enum RecordType : std::uint8_t { Add = 1, Remove = 2 };
+
+	std::string fPath;
+	std::ofstream fOut;
+	size_t fRecords = 0;
+	size_t fTombstones = 0;
+	bool fDamaged = false;
+
+	void writeHeader(std::ofstream& out)
+	{
+		std::uint32_t header[2] = { sMAGIC, sVERSION };
+		out.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+
+	static void encode(BinaryWriter& out, const longTermMem& m)
+	{
+		BinaryWriter payload;
+		payload.write<std::uint8_t>(Add);
+		payload.write<std::uint64_t>(m.id);
+		Mood mood = m.mood;
+		payload.write<double>(mood.getPleasure());
+		payload.write<double>(mood.getArousal());
+		payload.write<double>(mood.getDominance());
+		payload.write<double>(m.intensity);
+		payload.write<double>(m.time);
+		payload.writeString(m.emotion);
+		payload.writeString(m.name);
+		payload.writeString(m.reaction);
+		payload.writeString(m.trigger);
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(payload.size()));
+		out.writeBytes(payload.data().data(), payload.size());
+	}
+
+	void openForAppend()
+	{
+		fOut.open(fPath, std::ios::out | std::ios::binary | std::ios::app);
+		if (!fOut)
+			throw std::invalid_argument("Cannot open memory log '" + fPath + "'");
+	}
+
+public:
+	/**
+	* Creates a log for the specified file. Nothing is read or written before
+	* <code>replay</code>.
+	*
+	* @param path the file name
+	*/
+	explicit MemoryLog(std::string path) : fPath(std::move(path))
+	{
+	}
+
+	MemoryLog(const MemoryLog&) = delete;
+	MemoryLog& operator=(const MemoryLog&) = delete;
+
+	const std::string& getPath() const
+	{
+		return fPath;
+	}
+
+	/**
+	* Reads the live memories of the file, oldest first, and opens the file for
+	* appending. A missing file is created.
+	*
+	* @param time receives the latest memory time found in the file
+	* @return the memories, owned by the caller
+	* @throws std::invalid_argument if the file is not a memory log
+	*/
+	std::vector<longTermMem*> replay(double& time)
+	{
+		std::vector<longTermMem*> memories;
+		std::unordered_map<std::uint64_t, size_t> positions;
+		bool exists = false;
+		{
+			MappedFile file(fPath);
+			exists = (file.data() != nullptr);
+			if (exists)
+			{
+				BinaryReader in(file.data(), file.size());
+				std::uint32_t magic = in.read<std::uint32_t>();
+				std::uint32_t version = in.read<std::uint32_t>();
+				if ((magic != sMAGIC) || (version != sVERSION))
+					throw std::invalid_argument("'" + fPath + "' is not a memory log of this version");
+				try
+				{
+					while (!in.atEnd())
+					{
+						std::uint32_t size = in.read<std::uint32_t>();
+						size_t offset = in.position();
+						in.skip(size);
+						BinaryReader record(file.data() + offset, size);
+						std::uint8_t type = record.read<std::uint8_t>();
+						std::uint64_t id = record.read<std::uint64_t>();
+						fRecords++;
+						if (type == Remove)
+						{
+							fTombstones++;
+							auto it = positions.find(id);
+							if (it != positions.end())
+							{
+								delete memories[it->second];
+								memories[it->second] = nullptr;
+								positions.erase(it);
+							}
+							continue;
+						}
+						double p = record.read<double>();
+						double a = record.read<double>();
+						double d = record.read<double>();
+						double intensity = record.read<double>();
+						double created = record.read<double>();
+						std::string emotion = record.readString();
+						std::string name = record.readString();
+						std::string reaction = record.readString();
+						std::string trigger = record.readString();
+						longTermMem* m = new longTermMem(emotion, name, trigger, Mood(p, a, d), intensity);
+						m->reaction = reaction;
+						m->time = created;
+						m->id = id;
+						positions[id] = memories.size();
+						memories.push_back(m);
+						if (created > time)
+							time = created;
+					}
+				}
+				catch (const std::invalid_argument&)
+				{
+					// cut off while appending, everything before is intact
+					fDamaged = true;
+				}
+			}
+		}
+		std::vector<longTermMem*> live;
+		live.reserve(positions.size());
+		for (longTermMem* m : memories)
+		{
+			if (m != nullptr)
+				live.push_back(m);
+		}
+		if (!exists)
+		{
+			std::ofstream out(fPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			writeHeader(out);
+		}
+		openForAppend();
+		return live;
+	}
+
+	/**
+	* Appends a new memory.
+	*/
+	void append(const longTermMem& m)
+	{
+		BinaryWriter out;
+		encode(out, m);
+		fOut.write(out.data().data(), out.size());
+		fRecords++;
+	}
+
+	/**
+	* Appends the tombstone of a dropped memory.
+	*
+	* @param id the id of the memory
+	*/
+	void remove(std::uint64_t id)
+	{
+		BinaryWriter out;
+		out.write<std::uint32_t>(sizeof(std::uint8_t) + sizeof(std::uint64_t));
+		out.write<std::uint8_t>(Remove);
+		out.write<std::uint64_t>(id);
+		fOut.write(out.data().data(), out.size());
+		fRecords++;
+		fTombstones++;
+	}
+
+	void flush()
+	{
+		fOut.flush();
+	}
+
+	/**
+	* Returns true if the file should be compacted.
+	*/
+	bool needsCompaction() const
+	{
+		return fDamaged || ((fTombstones >= sMINTOMBSTONES) && (2 * fTombstones >= fRecords));
+	}
+
+	/**
+	* Rewrites the file with the specified memories only. The new file is
+	* written next to the old one and then replaces it. If it cannot be
+	* written or cannot replace the old file, the old file is kept and stays
+	* open for appending.
+	*
+	* @param live the current long term memories, oldest first
+	* @throws std::invalid_argument if the file could not be replaced
+	*/
+	void compact(const std::vector<longTermMem*>& live)
+	{
+		std::string temporary = fPath + ".tmp";
+		bool written = false;
+		{
+			std::ofstream out(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out)
+				throw std::invalid_argument("Cannot write memory log '" + temporary + "'");
+			writeHeader(out);
+			BinaryWriter records;
+			for (const longTermMem* m : live)
+				encode(records, *m);
+			out.write(records.data().data(), records.size());
+			out.close();
+			written = !out.fail();
+		}
+		fOut.flush();
+		fOut.close();
+		bool replaced = false;
+		if (written)
+		{
+#ifdef _WIN32
+			replaced = (MoveFileExA(temporary.c_str(), fPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+			replaced = (std::rename(temporary.c_str(), fPath.c_str()) == 0);
+#endif
+		}
+		if (!replaced)
+		{
+			std::remove(temporary.c_str());
+			openForAppend();
+			throw std::invalid_argument("Cannot replace memory log '" + fPath + "'");
+		}
+		openForAppend();
+		fRecords = live.size();
+		fTombstones = 0;
+		fDamaged = false;
+	}
+};
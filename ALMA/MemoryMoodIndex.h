@@ -0,0 +1,168 @@
+#pragma once
+#include "MemStructs.h"
+#include <vector>
+#include <array>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+
+/**
+* The class <code>MemoryMoodIndex</code> is a uniform grid over the PAD mood
+* space [-1,1]^3 that finds the long term memories whose mood at encoding time
+* is nearest to a given mood. Memories are inserted and removed one by one as
+* the memory changes; a query only visits the cells around the mood until the
+* k nearest memories are known.
+* <br>
+* The index does not own the memories.
+*
+* @version 1.0
+*/
+class MemoryMoodIndex
+{
+public:
+	/** number of cells per axis */
+	static const int sCELLS = 8;
+
+private:
+	struct Entry
+	{
+		longTermMem* memory;
+		double p;
+		double a;
+		double d;
+	};
+
+	std::array<std::vector<Entry>, sCELLS * sCELLS * sCELLS> fCells;
+	size_t fSize = 0;
+
+	static double cellSize()
+	{
+		return 2.0 / sCELLS;
+	}
+
+	static int cellOf(double value)
+	{
+		int cell = static_cast<int>((value + 1.0) / cellSize());
+		if (cell < 0)
+			return 0;
+		return (cell < sCELLS) ? cell : sCELLS - 1;
+	}
+
+	static int slot(int p, int a, int d)
+	{
+		return (p * sCELLS + a) * sCELLS + d;
+	}
+
+	static int slotOf(longTermMem* m)
+	{
+		return slot(cellOf(m->mood.getPleasure()), cellOf(m->mood.getArousal()), cellOf(m->mood.getDominance()));
+	}
+
+public:
+	void insert(longTermMem* m)
+	{
+		fCells[slotOf(m)].push_back({ m, m->mood.getPleasure(), m->mood.getArousal(), m->mood.getDominance() });
+		fSize++;
+	}
+
+	void remove(longTermMem* m)
+	{
+		std::vector<Entry>& cell = fCells[slotOf(m)];
+		for (size_t i = 0; i < cell.size(); i++)
+		{
+			if (cell[i].memory == m)
+			{
+				cell[i] = cell.back();
+				cell.pop_back();
+				fSize--;
+				return;
+			}
+		}
+	}
+
+	void clear()
+	{
+		for (std::vector<Entry>& cell : fCells)
+			cell.clear();
+		fSize = 0;
+	}
+
+	size_t size() const
+	{
+		return fSize;
+	}
+
+	/**
+	* Returns the k memories whose mood is nearest (euclidean distance in PAD
+	* space) to the specified mood, nearest first.
+	*
+	* @param p the pleasure of the mood
+	* @param a the arousal of the mood
+	* @param d the dominance of the mood
+	* @param k the maximal number of memories
+	* @return the memories
+	*/
+	std::vector<longTermMem*> nearest(double p, double a, double d, size_t k) const
+	{
+		// max heap of the best k candidates by squared distance
+		std::vector<std::pair<double, longTermMem*>> best;
+		if (k == 0)
+			return {};
+		best.reserve(k);
+		int cp = cellOf(p);
+		int ca = cellOf(a);
+		int cd = cellOf(d);
+		for (int ring = 0; ring < sCELLS; ring++)
+		{
+			// the cells of this and all later rings are at least (ring - 1) cells away
+			if ((best.size() == k) && (ring > 0))
+			{
+				double bound = (ring - 1) * cellSize();
+				if (best.front().first <= bound * bound)
+					break;
+			}
+			for (int ip = cp - ring; ip <= cp + ring; ip++)
+			{
+				if ((ip < 0) || (ip >= sCELLS))
+					continue;
+				for (int ia = ca - ring; ia <= ca + ring; ia++)
+				{
+					if ((ia < 0) || (ia >= sCELLS))
+						continue;
+					for (int id = cd - ring; id <= cd + ring; id++)
+					{
+						if ((id < 0) || (id >= sCELLS))
+							continue;
+						// only the shell of the ring, the inside was visited before
+						if ((std::abs(ip - cp) != ring) && (std::abs(ia - ca) != ring) && (std::abs(id - cd) != ring))
+							continue;
+						for (const Entry& entry : fCells[slot(ip, ia, id)])
+						{
+							double dp = entry.p - p;
+							double da = entry.a - a;
+							double dd = entry.d - d;
+							double distance = dp * dp + da * da + dd * dd;
+							if (best.size() < k)
+							{
+								best.emplace_back(distance, entry.memory);
+								std::push_heap(best.begin(), best.end());
+							}
+							else if (distance < best.front().first)
+							{
+								std::pop_heap(best.begin(), best.end());
+								best.back() = std::make_pair(distance, entry.memory);
+								std::push_heap(best.begin(), best.end());
+							}
+						}
+					}
+				}
+			}
+		}
+		std::sort_heap(best.begin(), best.end());
+		std::vector<longTermMem*> result;
+		result.reserve(best.size());
+		for (const auto& candidate : best)
+			result.push_back(candidate.second);
+		return result;
+	}
+};
@@ -16,13 +16,20 @@ class Mood {
 	 enum Moodtype : size_t {
 		 Neutral, Exuberant, Dependent, Relaxed, Docile, Hostile, Anxious, Disdainful, Bored
 	 };
-	 const std::vector<std::string> MoodtypeNames = {
-		 "Neutral", "Exuberant", "Dependent", "Relaxed", "Docile", "Hostile", "Anxious", "Disdainful", "Bored"
-	 };
+	 /** the names are shared by all moods, a mood only holds its PAD values */
+	 static const std::string& moodtypeName(size_t index) {
+		 static const std::string names[] = {
+			 "Neutral", "Exuberant", "Dependent", "Relaxed", "Docile", "Hostile", "Anxious", "Disdainful", "Bored"
+		 };
+		 return names[index];
+	 }
 
-	 const std::vector<std::string> MoodIntensityNames = {
-		 "neutral", "slightly", "moderate", "fully"
-	 };
+	 static const std::string& moodIntensityName(size_t index) {
+		 static const std::string names[] = {
+			 "neutral", "slightly", "moderate", "fully"
+		 };
+		 return names[index];
+	 }
 	 
 	 double pleasure;
 
@@ -116,13 +123,13 @@ class Mood {
 
 	 std::string getMoodWord() {
 		if ((pleasure == 0.0) && (arousal == 0.0) && (dominance == 0.0))
-			return MoodtypeNames[Moodtype::Neutral];
+			return moodtypeName(Moodtype::Neutral);
 		int index = 0;
 		index = (pleasure < 0.0) ? 4 : index;
 		index = (arousal < 0.0) ? index + 2 : index;
 		index = (dominance < 0.0) ? index + 1 : index;
 		index++;
-		return MoodtypeNames[index];
+		return moodtypeName(index);
 	}
 
 	 double getIntensity() {
@@ -137,7 +144,7 @@ class Mood {
 		int index = 0;
 		index = (normOfMood > 0.50) ? 1 : index;
 		index = (normOfMood > 1.00) ? 2 : index;
-		return MoodIntensityNames[index + 1];
+		return moodIntensityName(index + 1);
 	}
 
 	 bool equals(Mood m) {
@@ -140,6 +140,20 @@ public:
 	*/
 	double getNeurotism() const { return neurotism; }
 
+	/**
+	* Writes the personality traits into an array.
+	*
+	* @param traits receives openness, conscientiousness, extraversion,
+	*        agreeableness and neurotism
+	*/
+	void getTraits(double traits[5]) const {
+		traits[0] = openness;
+		traits[1] = conscientiousness;
+		traits[2] = extraversion;
+		traits[3] = agreeableness;
+		traits[4] = neurotism;
+	}
+
 	/**
 	* Returns a concise representation of this personality
 	* consisting of the values for each personality trait.
@@ -1,17 +1,9 @@
 #include "PersonalityEmotionsRelations.h"
 #include "Personality.h"
-
- double PersonalityEmotionsRelations::getPersonalityInfluence( const Personality& personality, EmotionType type) const {
-	Influence influence = getInfluence(type);
-	return  (fPersonalityEmotionInfluence *
-		personality.getOpenness() * influence.opennessInfluence +
-			personality.getConscientiousness() * influence.conscientiousnessInfluence +
-			personality.getExtraversion() * influence.extraversionInfluence +
-			personality.getAgreeableness() * influence.agreeablenessInfluence +
-			personality.getNeurotism() * influence.neurotismInfluence);
-}
-
-
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define ALMA_SSE2
+#include <emmintrin.h>
+#endif
 
 static const std::unordered_map<EmotionType, Influence> Relations = {
 	{ EmotionType::Undefined, Influence(Null, Null, Null, Null, Null) },
@@ -44,4 +36,86 @@ static const std::unordered_map<EmotionType, Influence> Relations = {
 Influence getInfluence(EmotionType type)
 {
 	return Relations.at(type);
-}
\ No newline at end of file
+}
+
+/**
+* The influence table as a dense matrix, stored by trait so that one trait
+* of a personality scales a whole column of emotion types at once. Physical
+* emotions have no relation and keep a row of zeros.
+*/
+struct InfluenceMatrix
+{
+	alignas(16) double column[PersonalityEmotionsRelations::sTRAITS][PersonalityEmotionsRelations::sTYPES];
+
+	InfluenceMatrix()
+	{
+		for (size_t t = 0; t < PersonalityEmotionsRelations::sTYPES; t++)
+		{
+			auto it = Relations.find(static_cast<EmotionType>(t));
+			Influence influence = (it == Relations.end()) ? Influence() : it->second;
+			column[0][t] = influence.opennessInfluence;
+			column[1][t] = influence.conscientiousnessInfluence;
+			column[2][t] = influence.extraversionInfluence;
+			column[3][t] = influence.agreeablenessInfluence;
+			column[4][t] = influence.neurotismInfluence;
+		}
+	}
+};
+
+static const InfluenceMatrix& influenceMatrix()
+{
+	static const InfluenceMatrix matrix;
+	return matrix;
+}
+
+ double PersonalityEmotionsRelations::getPersonalityInfluence( const Personality& personality, EmotionType type) const {
+	double traits[sTRAITS];
+	personality.getTraits(traits);
+	return getPersonalityInfluence(traits, type);
+}
+
+ double PersonalityEmotionsRelations::getPersonalityInfluence(const double traits[5], EmotionType type) const {
+	const InfluenceMatrix& matrix = influenceMatrix();
+	// only the openness term is scaled by the personality emotion influence
+	return  (fPersonalityEmotionInfluence *
+		traits[0] * matrix.column[0][type] +
+			traits[1] * matrix.column[1][type] +
+			traits[2] * matrix.column[2][type] +
+			traits[3] * matrix.column[3][type] +
+			traits[4] * matrix.column[4][type]);
+}
+
+ void PersonalityEmotionsRelations::getInfluences(const double* traits, size_t count, double* influences, double* baselines) const {
+	const InfluenceMatrix& matrix = influenceMatrix();
+	for (size_t p = 0; p < count; p++) {
+		const double* row = traits + p * sTRAITS;
+		double weight[sTRAITS] = { fPersonalityEmotionInfluence * row[0], row[1], row[2], row[3], row[4] };
+		double* influence = (influences != nullptr) ? influences + p * sTYPES : nullptr;
+		double* baseline = (baselines != nullptr) ? baselines + p * sTYPES : nullptr;
+		size_t t = 0;
+#ifdef ALMA_SSE2
+		const __m128d zero = _mm_setzero_pd();
+		const __m128d maxBaseline = _mm_set1_pd(fEmotionMaxBaseline);
+		for (; t + 2 <= sTYPES; t += 2) {
+			__m128d sum = _mm_mul_pd(_mm_set1_pd(weight[0]), _mm_load_pd(&matrix.column[0][t]));
+			for (size_t k = 1; k < sTRAITS; k++)
+				sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(weight[k]), _mm_load_pd(&matrix.column[k][t])));
+			if (influence != nullptr)
+				_mm_storeu_pd(influence + t, sum);
+			if (baseline != nullptr)
+				_mm_storeu_pd(baseline + t, _mm_max_pd(_mm_min_pd(sum, maxBaseline), zero));
+		}
+#endif
+		for (; t < sTYPES; t++) {
+			double sum = weight[0] * matrix.column[0][t];
+			for (size_t k = 1; k < sTRAITS; k++)
+				sum = sum + weight[k] * matrix.column[k][t];
+			if (influence != nullptr)
+				influence[t] = sum;
+			if (baseline != nullptr) {
+				double value = (sum > fEmotionMaxBaseline) ? fEmotionMaxBaseline : sum;
+				baseline[t] = (value < 0.0) ? 0.0 : value;
+			}
+		}
+	}
+}
@@ -75,12 +75,20 @@ private:
 	// static std::unique_ptr< PersonalityEmotionsRelations> instance;
 	double fPersonalityEmotionInfluence = 0.5;
 	double fEmotionMaxBaseline = 0.40;
+	/** changes whenever a setting changes, so cached results can be checked */
+	unsigned fVersion = 0;
 
 public:
+	/** the number of emotion types, the rows of the influence matrix */
+	static const size_t sTYPES = EmotionType::Physical + 1;
+	/** the number of personality traits, the columns of the influence matrix */
+	static const size_t sTRAITS = 5;
+
 	PersonalityEmotionsRelations() {
 	}
 	void setPersonalityEmotionInfluence(double personalityEmotionInfluence) {
 		fPersonalityEmotionInfluence = personalityEmotionInfluence;
+		fVersion++;
 	}
 
 	void setUp(double EmoInfluence, double Emobaseline )
@@ -91,6 +99,11 @@ public:
 
 	void setEmotionMaxBaseline(double emotionMaxBaseline) {
 		fEmotionMaxBaseline = emotionMaxBaseline;
+		fVersion++;
+	}
+
+	unsigned getVersion() const {
+		return fVersion;
 	}
 
 	/**
@@ -103,6 +116,32 @@ public:
 	*/
 	 double getPersonalityInfluence(const Personality& personality, EmotionType type) const;
 
+	/**
+	* Returns the combined influence of the specified personality traits for
+	* the specified emotion type, without a <code>Personality</code> object.
+	*
+	* @param traits openness, conscientiousness, extraversion, agreeableness
+	*        and neurotism
+	* @param type the emotion type
+	* @return the combined influence.
+	*/
+	 double getPersonalityInfluence(const double traits[5], EmotionType type) const;
+
+	/**
+	* Computes the combined influence and the baseline of every emotion type
+	* for a batch of personalities in one pass over the influence matrix.
+	*
+	* @param traits <code>count</code> rows of openness, conscientiousness,
+	*        extraversion, agreeableness and neurotism
+	* @param count the number of personalities
+	* @param influences receives <code>count</code> rows of
+	*        <code>sTYPES</code> influences indexed by the emotion type,
+	*        nullptr if not needed
+	* @param baselines receives <code>count</code> rows of
+	*        <code>sTYPES</code> baselines, nullptr if not needed
+	*/
+	 void getInfluences(const double* traits, size_t count, double* influences, double* baselines) const;
+
 	/**
 	* Returns the baseline for the specified emotion type. The baseline
 	* depends on the character's personality.
@@ -121,6 +160,23 @@ public:
 		return value;
 	}
 
+	/**
+	* Returns the baseline for the specified emotion type and personality
+	* traits.
+	*
+	* @param traits openness, conscientiousness, extraversion, agreeableness
+	*        and neurotism
+	* @param type the emotion type
+	* @return the emotion baseline.
+	*/
+	double getEmotionBaseline(const double traits[5], EmotionType type) const
+	{
+		double value = getPersonalityInfluence(traits, type);
+		value = (value > fEmotionMaxBaseline) ? fEmotionMaxBaseline : value;
+		value = (value < 0.0) ? 0.0 : value;
+		return value;
+	}
+
 
 };
 
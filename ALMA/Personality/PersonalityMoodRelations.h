@@ -2,6 +2,7 @@
 
 #include"../Mood/Mood.h"
 #include"Personality.h"
+#include<cmath>
 
 class PersonalityMoodRelations {
 public:
@@ -22,6 +23,8 @@ private:
 	 static Personality pleasureRelation;
 	 static Personality arousalRelation;
 	 static Personality dominanceRelation;
+	 /** changes whenever the relations change */
+	 static unsigned sVersion;
 	 // static Logger log = AffectManager.sLog;
 
 
@@ -47,6 +50,11 @@ public:
 		pleasureRelation = PleasureRelation;
 		arousalRelation = ArousalRelation;
 		dominanceRelation = DominanceRelation;
+		sVersion++;
+	}
+
+	static unsigned getVersion() {
+		return sVersion;
 	}
 	static PersonalityMoodRelations*
 		createPersonalityMoodRelations(Mood opennessRelation,Mood conscientiousnessRelation,
@@ -125,99 +133,60 @@ public:
 			
 		}
 		else {
-			double pleasure =mood.getPleasure();
-			double arousal =mood.getArousal();
-			double dominance =mood.getDominance();
-			double openness = 0.0;
-			double conscientiousness = 0.0;
-			double extraversion = 0.0;
-			double agreeableness = 0.0;
-			double neurotism = 0.0;
-			if (mood.isPleasureDominant()) {
-				// computed (temporal) personality traits related to pleasure
-				openness = (opennessRelation.isPleasureDominant()) ?
-					opennessRelation.getPleasure()*pleasure +
-					opennessRelation.getArousal()*arousal +
-					opennessRelation.getDominance()*dominance : 0.0;
-				conscientiousness = (conscientiousnessRelation.isPleasureDominant()) ?
-					conscientiousnessRelation.getPleasure()*pleasure +
-					conscientiousnessRelation.getArousal()*arousal +
-					conscientiousnessRelation.getDominance()*dominance : 0.0;
-				extraversion = (extraversionRelation.isPleasureDominant()) ?
-					extraversionRelation.getPleasure()*pleasure +
-					extraversionRelation.getArousal()*arousal +
-					extraversionRelation.getDominance()*dominance : 0.0;
-				agreeableness = (agreeablenessRelation.isPleasureDominant()) ?
-					agreeablenessRelation.getPleasure()*pleasure +
-					agreeablenessRelation.getArousal()*arousal +
-					agreeablenessRelation.getDominance()*dominance : 0.0;
-				/*neurotism = (neurotismRelation->isPleasureDominant()) ?
-					neurotismRelation->getPleasure()*pleasure +
-					neurotismRelation->getArousal()*arousal +
-					neurotismRelation->getDominance()*dominance : 0.0;*/
-			}
-			if (mood.isArousalDominant()) {
-				// compute (temporal) personality traits related to arousal
-				openness = (opennessRelation.isArousalDominant()) ?
-					opennessRelation.getPleasure()*pleasure +
-					opennessRelation.getArousal()*arousal +
-					opennessRelation.getDominance()*dominance : 0.0;
-				conscientiousness = (conscientiousnessRelation.isArousalDominant()) ?
-					conscientiousnessRelation.getPleasure()*pleasure +
-					conscientiousnessRelation.getArousal()*arousal +
-					conscientiousnessRelation.getDominance()*dominance : 0.0;
-				extraversion = (extraversionRelation.isArousalDominant()) ?
-					extraversionRelation.getPleasure()*pleasure +
-					extraversionRelation.getArousal()*arousal +
-					extraversionRelation.getDominance()*dominance : 0.0;
-				agreeableness = (agreeablenessRelation.isArousalDominant()) ?
-					agreeablenessRelation.getPleasure()*pleasure +
-					agreeablenessRelation.getArousal()*arousal +
-					agreeablenessRelation.getDominance()*dominance : 0.0;
-			/*	neurotism = (neurotismRelation->isArousalDominant()) ?
-					neurotismRelation->getPleasure()*pleasure +
-					neurotismRelation->getArousal()*arousal +
-					neurotismRelation->getDominance()*dominance : 0.0;*/
-			}
-			if (mood.isDominanceDominant()) {
-				// compute (temporal) personality traits related to dominance
-				openness = (opennessRelation.isDominanceDominant()) ?
-					opennessRelation.getPleasure()*pleasure +
-					opennessRelation.getArousal()*arousal +
-					opennessRelation.getDominance()*dominance : 0.0;
-				conscientiousness = (conscientiousnessRelation.isDominanceDominant()) ?
-					conscientiousnessRelation.getPleasure()*pleasure +
-					conscientiousnessRelation.getArousal()*arousal +
-					conscientiousnessRelation.getDominance()*dominance : 0.0;
-				extraversion = (extraversionRelation.isDominanceDominant()) ?
-					extraversionRelation.getPleasure()*pleasure +
-					extraversionRelation.getArousal()*arousal +
-					extraversionRelation.getDominance()*dominance : 0.0;
-				agreeableness = (agreeablenessRelation.isDominanceDominant()) ?
-					agreeablenessRelation.getPleasure()*pleasure +
-					agreeablenessRelation.getArousal()*arousal +
-					agreeablenessRelation.getDominance()*dominance : 0.0;
-				/*neurotism = (neurotismRelation->isDominanceDominant()) ?
-					neurotismRelation->getPleasure()*pleasure +
-					neurotismRelation->getArousal()*arousal +
-					neurotismRelation->getDominance()*dominance : 0.0;*/
-			}
-			// just for being on the safe side ...
-			openness = (openness > 1.0) ? 1.0 : openness;
-			conscientiousness = (conscientiousness > 1.0) ? 1.0 : conscientiousness;
-			extraversion = (extraversion > 1.0) ? 1.0 : extraversion;
-			agreeableness = (agreeableness > 1.0) ? 1.0 : agreeableness;
-			neurotism = (neurotism > 1.0) ? 1.0 : neurotism;
-			// just for being on the safe side ...
-			openness = (openness < -1.0) ? -1.0 : openness;
-			conscientiousness = (conscientiousness < -1.0) ? -1.0 : conscientiousness;
-			extraversion = (extraversion < -1.0) ? -1.0 : extraversion;
-			agreeableness = (agreeableness < -1.0) ? -1.0 : agreeableness;
-			neurotism = (neurotism < -1.0) ? -1.0 : neurotism;
-			Personality p = Personality(openness, conscientiousness, extraversion, agreeableness, neurotism);
+			double traits[5];
+			getMoodyTraits(mood.getPleasure(), mood.getArousal(), mood.getDominance(), traits);
+			Personality p = Personality(traits[0], traits[1], traits[2], traits[3], traits[4]);
 			return p;
 		}
 	}
+
+	/**
+	* Computes the personality traits according to a given mood like
+	* <code>getMoodyPersonalityTraits</code>, but writes them into an array
+	* instead of creating a <code>Personality</code>, so it does not allocate.
+	*
+	* @param pleasure the pleasure of the mood
+	* @param arousal the arousal of the mood
+	* @param dominance the dominance of the mood
+	* @param traits receives openness, conscientiousness, extraversion,
+	*        agreeableness and neurotism
+	*/
+	static void getMoodyTraits(double pleasure, double arousal, double dominance, double traits[5]) {
+		for (int i = 0; i < 5; i++)
+			traits[i] = 0.0;
+		Mood* relations[4] = { &opennessRelation, &conscientiousnessRelation, &extraversionRelation, &agreeablenessRelation };
+		double absPleasure = std::fabs(pleasure);
+		double absArousal = std::fabs(arousal);
+		double absDominance = std::fabs(dominance);
+		// the neurotism relation is not used, neurotism stays 0.0
+		if ((absPleasure > absArousal) && (absPleasure > absDominance)) {
+			// computed (temporal) personality traits related to pleasure
+			for (int i = 0; i < 4; i++)
+				traits[i] = relations[i]->isPleasureDominant() ? relate(*relations[i], pleasure, arousal, dominance) : 0.0;
+		}
+		if ((absArousal > absPleasure) && (absArousal > absDominance)) {
+			// compute (temporal) personality traits related to arousal
+			for (int i = 0; i < 4; i++)
+				traits[i] = relations[i]->isArousalDominant() ? relate(*relations[i], pleasure, arousal, dominance) : 0.0;
+		}
+		if ((absDominance > absPleasure) && (absDominance > absArousal)) {
+			// compute (temporal) personality traits related to dominance
+			for (int i = 0; i < 4; i++)
+				traits[i] = relations[i]->isDominanceDominant() ? relate(*relations[i], pleasure, arousal, dominance) : 0.0;
+		}
+		// just for being on the safe side ...
+		for (int i = 0; i < 5; i++) {
+			traits[i] = (traits[i] > 1.0) ? 1.0 : traits[i];
+			traits[i] = (traits[i] < -1.0) ? -1.0 : traits[i];
+		}
+	}
+
+private:
+	static double relate(Mood& relation, double pleasure, double arousal, double dominance) {
+		return relation.getPleasure()*pleasure +
+			relation.getArousal()*arousal +
+			relation.getDominance()*dominance;
+	}
 };
 
  std::shared_ptr<PersonalityMoodRelations> PersonalityMoodRelations::instance = nullptr;
@@ -228,4 +197,5 @@ public:
  Mood PersonalityMoodRelations::neurotismRelation = Mood();
 Personality PersonalityMoodRelations::pleasureRelation = Personality();
 Personality PersonalityMoodRelations::arousalRelation =  Personality();
-Personality PersonalityMoodRelations::dominanceRelation =Personality();
\ No newline at end of file
+Personality PersonalityMoodRelations::dominanceRelation =Personality();
+unsigned PersonalityMoodRelations::sVersion = 0;
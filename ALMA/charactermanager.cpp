@@ -20,6 +20,7 @@
 #include "MemStructs.h"
 #include"AppraisalManager.h"
 #include<math.h>
+#include<sstream>
 #include "timer_manager.h"
 #include"Data/AffectConsts.h"
 #include"Emotions/EmotionType.h"
@@ -42,8 +43,6 @@ using json = nlohmann::json;
 using namespace std;
 
 
-ofstream outputFile;
-std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 	
 	PersonalityMoodRelations* CharacterManager::getInstance()
@@ -69,6 +68,681 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 	float CharacterManager::random() { return static_cast <float> (rand()) / static_cast <float> (RAND_MAX); }
 
+	void CharacterManager::publishAffectSnapshot()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		AffectSnapshot snapshot;
+		snapshot.moodPleasure = fCurrentMood.getPleasure();
+		snapshot.moodArousal = fCurrentMood.getArousal();
+		snapshot.moodDominance = fCurrentMood.getDominance();
+		snapshot.tendencyPleasure = fCurrentMoodTendency.getPleasure();
+		snapshot.tendencyArousal = fCurrentMoodTendency.getArousal();
+		snapshot.tendencyDominance = fCurrentMoodTendency.getDominance();
+
+		double dominance = 0.0;
+		for (const std::shared_ptr<Emotion>& emotion : *fEmotionVector)
+		{
+			if (emotion == nullptr)
+				continue;
+			EmotionType type = emotion->getType();
+			snapshot.intensities[type] = emotion->getIntensity();
+			snapshot.baselines[type] = emotion->getBaseline();
+			// same ordering as EmotionVector::compare, relative to the baseline
+			double relative = emotion->getIntensity() - emotion->getBaseline();
+			if (relative > dominance)
+			{
+				dominance = relative;
+				snapshot.dominantEmotion = type;
+			}
+		}
+		fAffectSnapshot.publish(snapshot);
+	}
+
+	void CharacterManager::decayStep(int steps)
+	{
+		fEmotionEngine->decay(fEmotionHistory, fEmotionVector, createEmotionVector(), steps);
+	}
+
+	void CharacterManager::moodStep()
+	{
+		fCurrentMood = fMoodEngine->compute(fCurrentMood, fEmotionVector);
+		fCurrentMoodTendency = fMoodEngine->getCurrentMoodTendency();
+	}
+
+	bool CharacterManager::isAffectAtRest()
+	{
+		return (fEmotionHistory->size() == 0) && fCurrentMood.equals(fDefaultMood) &&
+			!fAc->moodStabilityControlledByNeurotism;
+	}
+
+	void CharacterManager::tickAffect(AffectTick tick)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		bool pending = !fDeferredTicks.empty();
+		if ((fAffectLOD == AffectLOD::Full) && !pending) {
+			(tick == AffectTick::EmotionDecay) ? decayStep() : moodStep();
+			publishAffectSnapshot();
+			return;
+		}
+		// while nothing is pending, ticks of a resting character change nothing
+		if (!pending && isAffectAtRest())
+			return;
+		if (!fDeferredTicks.empty() && (fDeferredTicks.back().first == tick))
+			fDeferredTicks.back().second++;
+		else
+			fDeferredTicks.emplace_back(tick, 1);
+		int& count = fDeferredTickCount[static_cast<int>(tick)];
+		if (++count >= sLODTICKFACTOR[static_cast<int>(fAffectLOD)])
+			catchUpAffect();
+	}
+
+	void CharacterManager::catchUpAffect()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		if (fDeferredTicks.empty())
+			return;
+		for (const std::pair<AffectTick, int>& run : fDeferredTicks) {
+			if (run.first == AffectTick::EmotionDecay) {
+				decayStep(run.second);
+				continue;
+			}
+			for (int i = 0; i < run.second; i++)
+				moodStep();
+		}
+		fDeferredTicks.clear();
+		fDeferredTickCount[0] = fDeferredTickCount[1] = 0;
+		publishAffectSnapshot();
+	}
+
+	void CharacterManager::setImportance(double importance)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		fImportance = importance;
+		int level = 0;
+		while ((level < sLODCOUNT - 1) && (importance < sLODMINIMPORTANCE[level]))
+			level++;
+		fAffectLOD = static_cast<AffectLOD>(level);
+		if (fAffectLOD == AffectLOD::Full)
+			catchUpAffect();
+	}
+
+	double CharacterManager::getImportance()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return fImportance;
+	}
+
+	CharacterManager::AffectLOD CharacterManager::getAffectLOD()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return fAffectLOD;
+	}
+
+	static void writeMood(BinaryWriter& out, Mood mood)
+	{
+		out.write<bool>(mood.getEmpty());
+		out.write<double>(mood.getPleasure());
+		out.write<double>(mood.getArousal());
+		out.write<double>(mood.getDominance());
+	}
+
+	static Mood readMood(BinaryReader& in)
+	{
+		bool empty = in.read<bool>();
+		double p = in.read<double>();
+		double a = in.read<double>();
+		double d = in.read<double>();
+		return empty ? Mood() : Mood(p, a, d);
+	}
+
+	static void writeTraits(BinaryWriter& out, const Personality& personality)
+	{
+		out.write<double>(personality.getOpenness());
+		out.write<double>(personality.getConscientiousness());
+		out.write<double>(personality.getExtraversion());
+		out.write<double>(personality.getAgreeableness());
+		out.write<double>(personality.getNeurotism());
+	}
+
+	static void writeTraits(BinaryWriter& out, const double* traits)
+	{
+		for (int i = 0; i < 5; i++)
+			out.write<double>(traits[i]);
+	}
+
+	static void readTraits(BinaryReader& in, double* traits)
+	{
+		for (int i = 0; i < 5; i++)
+			traits[i] = in.read<double>();
+	}
+
+	/**
+	* Emotions and elicitors are shared between the emotion vector, the
+	* history vectors and compound emotions. Both are written once into a
+	* table and referenced by index, so the restored objects are shared the
+	* same way. Elicitors are written with their payload from the
+	* <code>ElicitorRegistry</code>, their ids are only valid within one
+	* process.
+	*/
+	class CheckpointTables {
+	public:
+		static const std::uint32_t sNONE = 0xFFFFFFFF;
+		std::vector<std::shared_ptr<Emotion>> emotions;
+		/** the registry ids of the elicitors */
+		std::vector<std::uint32_t> elicitors;
+		std::unordered_map<const Emotion*, std::uint32_t> emotionIndex;
+		std::unordered_map<std::uint32_t, std::uint32_t> elicitorIndex;
+
+		std::uint32_t addEmotion(const std::shared_ptr<Emotion>& emotion)
+		{
+			if (emotion == nullptr)
+				return sNONE;
+			auto it = emotionIndex.find(emotion.get());
+			if (it != emotionIndex.end())
+				return it->second;
+			std::uint32_t index = static_cast<std::uint32_t>(emotions.size());
+			emotionIndex.emplace(emotion.get(), index);
+			emotions.push_back(emotion);
+			return index;
+		}
+
+		std::uint32_t addElicitor(std::uint32_t elicitor)
+		{
+			if (elicitor == ElicitorRegistry::sNONE)
+				return sNONE;
+			auto it = elicitorIndex.find(elicitor);
+			if (it != elicitorIndex.end())
+				return it->second;
+			std::uint32_t index = static_cast<std::uint32_t>(elicitors.size());
+			elicitorIndex.emplace(elicitor, index);
+			elicitors.push_back(elicitor);
+			return index;
+		}
+
+		void addVector(const std::shared_ptr<EmotionVector>& vector)
+		{
+			for (const std::shared_ptr<Emotion>& emotion : *vector)
+				addEmotion(emotion);
+		}
+
+		/** adds elicitors and the emotions they refer to until nothing new is found */
+		void close()
+		{
+			for (size_t i = 0; i < emotions.size(); i++) {
+				std::uint32_t elicitor = emotions[i]->getElicitor();
+				if (addElicitor(elicitor) == sNONE)
+					continue;
+				ElicitorRegistry::Entry entry = ElicitorRegistry::getInstance().get(elicitor);
+				if (entry.type == Emotion::ElicitType::Emotion)
+					addEmotion(std::const_pointer_cast<Emotion>(entry.emotion));
+			}
+		}
+
+		void writeVector(BinaryWriter& out, const std::shared_ptr<EmotionVector>& vector)
+		{
+			// the history holds deltas, only the emotions present are written
+			std::uint32_t count = 0;
+			for (std::uint32_t mask = vector->getMask(); mask != 0; mask &= mask - 1)
+				count++;
+			out.write<std::uint32_t>(count);
+			for (const std::shared_ptr<Emotion>& emotion : *vector) {
+				out.write<std::uint32_t>(static_cast<std::uint32_t>(emotion->getType()));
+				out.write<std::uint32_t>(addEmotion(emotion));
+			}
+		}
+
+		std::shared_ptr<EmotionVector> readVector(BinaryReader& in)
+		{
+			std::uint32_t count = in.readCount(2 * sizeof(std::uint32_t));
+			std::vector<std::pair<Emotion::Type, std::shared_ptr<Emotion>>> entries;
+			entries.reserve(count);
+			for (std::uint32_t i = 0; i < count; i++) {
+				std::uint32_t type = in.read<std::uint32_t>();
+				std::uint32_t index = in.read<std::uint32_t>();
+				if (type > EmotionType::Physical)
+					throw std::invalid_argument("Invalid emotion type in checkpoint");
+				if ((index != sNONE) && (index >= emotions.size()))
+					throw std::invalid_argument("Invalid emotion reference in checkpoint");
+				entries.emplace_back(static_cast<Emotion::Type>(type), (index == sNONE) ? nullptr : emotions[index]);
+			}
+			return std::make_shared<EmotionVector>(entries);
+		}
+	};
+
+	void CharacterManager::writeCheckpoint(BinaryWriter& out)
+	{
+		// identity
+		out.writeString(fName);
+		out.write<bool>(fDerivedPersonality);
+		writeTraits(out, fPersonality);
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(fAvailEmotions.size()));
+		for (EmotionType type : fAvailEmotions)
+			out.write<std::uint32_t>(static_cast<std::uint32_t>(type));
+
+		// affect constants, moods and level of detail
+		out.write<double>(fAc->emotionMaxBaseline);
+		out.write<double>(fAc->personalityEmotionInfluence);
+		out.write<std::int64_t>(fAc->emotionDecayOverallTime);
+		out.write<std::int32_t>(fAc->emotionDecayPeriod);
+		out.write<std::int32_t>(fAc->emotionDecaySteps);
+		out.write<std::int32_t>(fAc->emotionHistoryLength);
+		out.write<double>(fAc->defaultEmotionsEpsilon);
+		out.write<std::int64_t>(fAc->moodReturnOverallTime);
+		out.write<std::int32_t>(fAc->moodReturnPeriod);
+		out.write<std::int32_t>(fAc->moodReturnSteps);
+		out.write<bool>(fAc->moodStabilityControlledByNeurotism);
+		writeMood(out, fDefaultMood);
+		writeMood(out, fCurrentMood);
+		writeMood(out, fCurrentMoodTendency);
+		out.write<double>(fImportance);
+
+		// elicitors and emotions
+		CheckpointTables tables;
+		tables.addVector(fEmotionVector);
+		for (int i = 0; i < fEmotionHistory->size(); i++)
+			tables.addVector(fEmotionHistory->get(i));
+		tables.close();
+
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(tables.elicitors.size()));
+		for (std::uint32_t elicitor : tables.elicitors) {
+			ElicitorRegistry::Entry entry = ElicitorRegistry::getInstance().get(elicitor);
+			out.write<std::uint8_t>(static_cast<std::uint8_t>(entry.type));
+			out.writeString(entry.name);
+			out.write<std::uint32_t>(tables.addEmotion(std::const_pointer_cast<Emotion>(entry.emotion)));
+			writeTraits(out, entry.traits.data());
+		}
+
+		// ticks are process relative, emotions store their age at the time of
+		// the checkpoint
+		std::uint32_t now = Emotion::currentTick();
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(tables.emotions.size()));
+		for (const auto& emotion : tables.emotions) {
+			EmotionAppraisalVars vars = emotion->getAppraisalVariables();
+			out.write<std::uint32_t>(static_cast<std::uint32_t>(emotion->getType()));
+			out.write<double>(emotion->getIntensity());
+			out.write<double>(emotion->getBaseline());
+			out.write<double>(vars.desirability);
+			out.write<double>(vars.praiseworthy);
+			out.write<double>(vars.appealingness);
+			out.write<double>(vars.likelihood);
+			out.write<double>(vars.liking);
+			out.write<bool>(vars.realization);
+			out.write<bool>(vars.agency);
+			out.write<std::uint32_t>(now - emotion->mTimeOfElicitation);
+			out.write<std::uint32_t>(tables.addElicitor(emotion->getElicitor()));
+			if (emotion->getType() == EmotionType::Physical)
+				writeMood(out, emotion->getPADValues());
+			DecayFunction::DecayProgress progress;
+			bool decaying = fDecayFunction->getProgress(emotion, progress);
+			out.write<bool>(decaying);
+			if (decaying)
+				out.write<DecayFunction::DecayProgress>(progress);
+		}
+
+		// emotion vector and history
+		tables.writeVector(out, fEmotionVector);
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(fEmotionHistory->size()));
+		for (int i = 0; i < fEmotionHistory->size(); i++)
+			tables.writeVector(out, fEmotionHistory->get(i));
+
+		// mood engine, length prefixed so it can be applied after parsing
+		BinaryWriter moodState;
+		fMoodEngine->saveState(moodState);
+		out.writeString(moodState.data());
+
+		// memory, pending short term memories stay pending
+		out.write<double>(memDecayTime);
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(MemoryNames.size()));
+		for (const std::string& name : MemoryNames)
+			out.writeString(name);
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(memory.getPendingCount()));
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(memory.Short.size()));
+		for (shortTermMem* m : memory.Short) {
+			writeMood(out, m->mood);
+			out.writeString(m->emotion);
+			out.writeString(m->name);
+			out.writeString(m->reaction);
+			out.write<double>(m->intensity);
+			out.write<double>(m->time);
+			out.writeString(m->trigger);
+			out.write<bool>(m->promoted);
+		}
+		out.write<std::uint32_t>(static_cast<std::uint32_t>(memory.Long.size()));
+		for (longTermMem* m : memory.Long) {
+			writeMood(out, m->mood);
+			out.writeString(m->emotion);
+			out.writeString(m->name);
+			out.writeString(m->reaction);
+			out.write<double>(m->intensity);
+			out.write<double>(m->time);
+			out.writeString(m->trigger);
+		}
+	}
+
+	CharacterManager::CheckpointIdentity CharacterManager::readCheckpointIdentity(BinaryReader& in)
+	{
+		CheckpointIdentity identity;
+		identity.name = in.readString();
+		identity.derivedPersonality = in.read<bool>();
+		readTraits(in, identity.traits);
+		std::uint32_t count = in.readCount(sizeof(std::uint32_t));
+		for (std::uint32_t i = 0; i < count; i++) {
+			std::uint32_t type = in.read<std::uint32_t>();
+			if (type > EmotionType::Physical)
+				throw std::invalid_argument("Invalid emotion type in checkpoint");
+			identity.emotions.push_back(static_cast<EmotionType>(type));
+		}
+		return identity;
+	}
+
+	void CharacterManager::readCheckpoint(BinaryReader& in, const CheckpointIdentity& identity)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		// affect constants and emotion relations may be shared with other
+		// characters, the restored ones are copies owned by this character
+		std::shared_ptr<PersonalityEmotionsRelations> perEmoRels =
+			std::make_shared<PersonalityEmotionsRelations>(*fPersonality.getPersonalityEmotionsRelations());
+		const double* t = identity.traits;
+		Personality personality(t[0], t[1], t[2], t[3], t[4], perEmoRels);
+
+		// parse everything first, the character is left unchanged if the data is invalid
+		AffectConsts ac;
+		ac.emotionMaxBaseline = in.read<double>();
+		ac.personalityEmotionInfluence = in.read<double>();
+		ac.emotionDecayOverallTime = static_cast<long>(in.read<std::int64_t>());
+		ac.emotionDecayPeriod = in.read<std::int32_t>();
+		ac.emotionDecaySteps = in.read<std::int32_t>();
+		ac.emotionHistoryLength = in.read<std::int32_t>();
+		if (ac.emotionHistoryLength <= 0)
+			throw std::invalid_argument("Invalid emotion history length in checkpoint");
+		ac.defaultEmotionsEpsilon = in.read<double>();
+		if (!(ac.defaultEmotionsEpsilon >= 0.0))
+			throw std::invalid_argument("Invalid default emotions epsilon in checkpoint");
+		ac.moodReturnOverallTime = static_cast<long>(in.read<std::int64_t>());
+		ac.moodReturnPeriod = in.read<std::int32_t>();
+		ac.moodReturnSteps = in.read<std::int32_t>();
+		ac.moodStabilityControlledByNeurotism = in.read<bool>();
+		Mood defaultMood = readMood(in);
+		Mood currentMood = readMood(in);
+		Mood currentMoodTendency = readMood(in);
+		double importance = in.read<double>();
+
+		CheckpointTables tables;
+		std::vector<std::uint32_t> elicitorEmotions;
+		std::uint32_t count = in.readCount(sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t));
+		ElicitorRegistry& registry = ElicitorRegistry::getInstance();
+		for (std::uint32_t i = 0; i < count; i++) {
+			std::uint8_t type = in.read<std::uint8_t>();
+			if (type > static_cast<std::uint8_t>(Emotion::ElicitType::Personality))
+				throw std::invalid_argument("Invalid elicitor type in checkpoint");
+			std::string name = in.readString();
+			elicitorEmotions.push_back(in.read<std::uint32_t>());
+			double traits[5];
+			readTraits(in, traits);
+			// ids are not checkpointed, they are only valid within one process
+			std::uint32_t elicitor = ElicitorRegistry::sNONE;
+			switch (static_cast<Emotion::ElicitType>(type))
+			{
+			case Emotion::ElicitType::String:
+				elicitor = registry.intern(name);
+				break;
+			case Emotion::ElicitType::Personality:
+				elicitor = registry.intern(traits);
+				break;
+			case Emotion::ElicitType::Emotion:
+				// the eliciting emotion is set once the emotions are read
+				elicitor = registry.create();
+				break;
+			default:
+				break;
+			}
+			tables.elicitors.push_back(elicitor);
+		}
+
+		std::vector<std::pair<std::shared_ptr<Emotion>, DecayFunction::DecayProgress>> decaying;
+		// the ages are rebased onto the ticks of this process
+		std::uint32_t now = Emotion::currentTick();
+		count = in.readCount(sizeof(std::uint32_t));
+		for (std::uint32_t i = 0; i < count; i++) {
+			std::uint32_t type = in.read<std::uint32_t>();
+			if (type > EmotionType::Physical)
+				throw std::invalid_argument("Invalid emotion type in checkpoint");
+			double intensity = in.read<double>();
+			double baseline = in.read<double>();
+			EmotionAppraisalVars vars;
+			vars.desirability = static_cast<float>(in.read<double>());
+			vars.praiseworthy = static_cast<float>(in.read<double>());
+			vars.appealingness = static_cast<float>(in.read<double>());
+			vars.likelihood = static_cast<float>(in.read<double>());
+			vars.liking = static_cast<float>(in.read<double>());
+			vars.realization = in.read<bool>();
+			vars.agency = in.read<bool>();
+			std::uint32_t age = in.read<std::uint32_t>();
+			std::uint32_t elicitor = in.read<std::uint32_t>();
+			if ((elicitor != CheckpointTables::sNONE) && (elicitor >= tables.elicitors.size()))
+				throw std::invalid_argument("Invalid elicitor reference in checkpoint");
+
+			std::shared_ptr<Emotion> emotion;
+			if (type == EmotionType::Physical)
+				emotion = AffectArena::makeShared<PADEmotion>(fArena, readMood(in), intensity, std::string());
+			else
+				emotion = AffectArena::makeShared<Emotion>(fArena);
+			emotion->type = static_cast<std::uint8_t>(type);
+			emotion->intensity = static_cast<float>(intensity);
+			emotion->baseline = static_cast<float>(baseline);
+			emotion->mApraisalVars = vars;
+			emotion->mTimeOfElicitation = now - age;
+			emotion->elicitor = (elicitor == CheckpointTables::sNONE) ? ElicitorRegistry::sNONE : tables.elicitors[elicitor];
+			tables.emotions.push_back(emotion);
+			if (in.read<bool>())
+				decaying.emplace_back(emotion, in.read<DecayFunction::DecayProgress>());
+		}
+		for (size_t i = 0; i < elicitorEmotions.size(); i++) {
+			std::uint32_t index = elicitorEmotions[i];
+			if ((index != CheckpointTables::sNONE) && (index >= tables.emotions.size()))
+				throw std::invalid_argument("Invalid emotion reference in checkpoint");
+			if ((index != CheckpointTables::sNONE) && (tables.elicitors[i] != ElicitorRegistry::sNONE))
+				registry.setEmotion(tables.elicitors[i], std::make_shared<const Emotion>(*tables.emotions[index]));
+		}
+
+		std::shared_ptr<EmotionVector> emotionVector = tables.readVector(in);
+		std::vector<std::shared_ptr<EmotionVector>> history;
+		count = in.readCount(sizeof(std::uint32_t));
+		for (std::uint32_t i = 0; i < count; i++)
+			history.push_back(tables.readVector(in));
+
+		std::string moodState = in.readString();
+
+		double decayTime = in.read<double>();
+		std::vector<std::string> memoryNames;
+		count = in.readCount(sizeof(std::uint32_t));
+		for (std::uint32_t i = 0; i < count; i++)
+			memoryNames.push_back(in.readString());
+		std::vector<shortTermMem*> shortMemories;
+		std::vector<longTermMem*> longMemories;
+		try {
+			std::uint32_t pending = in.read<std::uint32_t>();
+			count = in.readCount(2 * sizeof(double));
+			for (std::uint32_t i = 0; i < count; i++) {
+				Mood mood = readMood(in);
+				std::string emotion = in.readString();
+				std::string name = in.readString();
+				std::string reaction = in.readString();
+				double intensity = in.read<double>();
+				double time = in.read<double>();
+				std::string trigger = in.readString();
+				bool promoted = in.read<bool>();
+				shortMemories.push_back(new shortTermMem(emotion, name, trigger, mood, intensity));
+				shortMemories.back()->reaction = reaction;
+				shortMemories.back()->time = time;
+				shortMemories.back()->promoted = promoted;
+				if (!promoted)
+					pending--;
+			}
+			if (pending != 0)
+				throw std::invalid_argument("Pending memories of the checkpoint do not match");
+			count = in.readCount(2 * sizeof(double));
+			for (std::uint32_t i = 0; i < count; i++) {
+				Mood mood = readMood(in);
+				std::string emotion = in.readString();
+				std::string name = in.readString();
+				std::string reaction = in.readString();
+				double intensity = in.read<double>();
+				double time = in.read<double>();
+				std::string trigger = in.readString();
+				longMemories.push_back(new longTermMem(emotion, name, trigger, mood, intensity));
+				longMemories.back()->reaction = reaction;
+				longMemories.back()->time = time;
+			}
+			if (!in.atEnd())
+				throw std::invalid_argument("Unexpected data at the end of the checkpoint");
+		}
+		catch (...) {
+			for (shortTermMem* m : shortMemories)
+				delete m;
+			for (longTermMem* m : longMemories)
+				delete m;
+			throw;
+		}
+
+		// apply
+		fDeferredTicks.clear();
+		fDeferredTickCount[0] = fDeferredTickCount[1] = 0;
+		fName = identity.name;
+		fDerivedPersonality = identity.derivedPersonality;
+		fAvailEmotions = identity.emotions;
+		fOwnAffectConsts = std::make_shared<AffectConsts>(ac);
+		fAc = fOwnAffectConsts.get();
+		perEmoRels->setPersonalityEmotionInfluence(ac.personalityEmotionInfluence);
+		perEmoRels->setEmotionMaxBaseline(ac.emotionMaxBaseline);
+		fPersEmoRels = perEmoRels;
+		fPersonality = personality;
+		fDefaultMood = defaultMood;
+		fCurrentMood = currentMood;
+		fCurrentMoodTendency = currentMoodTendency;
+		invalidateDefaultEmotions();
+
+		fDecayFunction->init(fAc->emotionDecaySteps);
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
+		fMoodEngine = fArena->recreate(fMoodEngine, fPersonality, fAc->moodStabilityControlledByNeurotism,
+			fDefaultMood, fAc->moodReturnOverallTime);
+		BinaryReader moodReader(moodState);
+		fMoodEngine->loadState(moodReader);
+		fEmotionHistory = fArena->recreate(fEmotionHistory, static_cast<size_t>(fAc->emotionHistoryLength));
+		for (const auto& emotions : history)
+			fEmotionHistory->add(emotions);
+		fEmotionVector = emotionVector;
+		for (const auto& entry : decaying)
+			fDecayFunction->setProgress(entry.first, entry.second);
+
+		memDecayTime = decayTime;
+		memory.setTime(memDecayTime);
+		MemoryNames = memoryNames;
+		memory.assign(shortMemories, longMemories);
+
+		setImportance(importance);
+		publishAffectSnapshot();
+	}
+
+	std::string CharacterManager::readCheckpointPayload(std::istream& in)
+	{
+		std::uint32_t header[2];
+		std::uint64_t size = 0;
+		if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+			!in.read(reinterpret_cast<char*>(&size), sizeof(size)))
+			throw std::invalid_argument("Unexpected end of checkpoint");
+		if (header[0] != sCHECKPOINTMAGIC)
+			throw std::invalid_argument("Not a character checkpoint");
+		if (header[1] != sCHECKPOINTVERSION)
+			throw std::invalid_argument("Unsupported checkpoint version " + std::to_string(header[1]));
+		std::string payload(static_cast<size_t>(size), '\0');
+		if (!in.read(&payload[0], payload.size()))
+			throw std::invalid_argument("Unexpected end of checkpoint");
+		return payload;
+	}
+
+	void CharacterManager::saveCheckpoint(std::ostream& out)
+	{
+		BinaryWriter writer;
+		{
+			std::unique_lock<std::recursive_mutex> lock(_mutex);
+			catchUpAffect();
+			writer.write<std::uint32_t>(sCHECKPOINTMAGIC);
+			writer.write<std::uint32_t>(sCHECKPOINTVERSION);
+			writer.write<std::uint64_t>(0);
+			writeCheckpoint(writer);
+		}
+		std::string data = writer.data();
+		std::uint64_t size = data.size() - 2 * sizeof(std::uint32_t) - sizeof(std::uint64_t);
+		std::memcpy(&data[2 * sizeof(std::uint32_t)], &size, sizeof(size));
+		out.write(data.data(), data.size());
+	}
+
+	void CharacterManager::loadCheckpoint(std::istream& in)
+	{
+		std::string payload = readCheckpointPayload(in);
+		BinaryReader reader(payload);
+		CheckpointIdentity identity = readCheckpointIdentity(reader);
+		readCheckpoint(reader, identity);
+	}
+
+	CharacterManager* CharacterManager::restoreCheckpoint(std::istream& in, AffectConsts* ac, DecayFunction* decayFunction)
+	{
+		std::string payload = readCheckpointPayload(in);
+		BinaryReader reader(payload);
+		CheckpointIdentity identity = readCheckpointIdentity(reader);
+		const double* t = identity.traits;
+		CharacterManager* character = new CharacterManager(identity.name, Personality(t[0], t[1], t[2], t[3], t[4]),
+			ac, identity.derivedPersonality, decayFunction, identity.emotions);
+		try {
+			character->readCheckpoint(reader, identity);
+		}
+		catch (...) {
+			delete character;
+			throw;
+		}
+		return character;
+	}
+
+	CharacterManager* CharacterManager::fork(std::string name)
+	{
+		std::stringstream buffer(std::ios::in | std::ios::out | std::ios::binary);
+		saveCheckpoint(buffer);
+		CharacterManager* character = restoreCheckpoint(buffer, fAc, fDecayFunction);
+		character->fName = name;
+		return character;
+	}
+
+	void CharacterManager::savePopulation(std::ostream& out, const std::vector<CharacterManager*>& characters)
+	{
+		std::uint32_t header[3] = { sPOPULATIONMAGIC, sCHECKPOINTVERSION, static_cast<std::uint32_t>(characters.size()) };
+		out.write(reinterpret_cast<const char*>(header), sizeof(header));
+		for (CharacterManager* character : characters)
+			character->saveCheckpoint(out);
+	}
+
+	std::vector<CharacterManager*> CharacterManager::restorePopulation(std::istream& in, AffectConsts* ac, DecayFunction* decayFunction)
+	{
+		std::uint32_t header[3];
+		if (!in.read(reinterpret_cast<char*>(header), sizeof(header)))
+			throw std::invalid_argument("Unexpected end of population");
+		if (header[0] != sPOPULATIONMAGIC)
+			throw std::invalid_argument("Not a population checkpoint");
+		if (header[1] != sCHECKPOINTVERSION)
+			throw std::invalid_argument("Unsupported checkpoint version " + std::to_string(header[1]));
+		std::vector<CharacterManager*> characters;
+		try {
+			for (std::uint32_t i = 0; i < header[2]; i++)
+				characters.push_back(restoreCheckpoint(in, ac, decayFunction));
+		}
+		catch (...) {
+			for (CharacterManager* character : characters)
+				delete character;
+			throw;
+		}
+		return characters;
+	}
+
 
 	unique_ptr<Node> CharacterManager::processBNode(const json& node)
 	{
@@ -189,7 +863,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 			exit;
 		}
 		inputFile >> behaviourFormat;
-		BehaviorTree* Behavetree = new BehaviorTree();
+		BehaviorTree* Behavetree = fArena->create<BehaviorTree>();
 
 		Behavetree->setName(behaviourFormat["title"]);
 		Behavetree->setRootChild(processBNode(behaviourFormat["root"]));
@@ -204,14 +878,21 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 	void CharacterManager::configSetup()
 	{
-		json setupFormat;
-		ifstream inputFile{ "Setup.json" };
-		if (inputFile.bad())
+		// parsed once, restored and forked characters are created in bulk
 		{
-			cerr << "Failed to open 'Setup.json'." << endl;
-			exit;
+			std::lock_guard<std::mutex> lock(sSetupMutex);
+			if (sSetup.is_null())
+			{
+				ifstream inputFile{ "Setup.json" };
+				if (inputFile.bad())
+				{
+					cerr << "Failed to open 'Setup.json'." << endl;
+					exit;
+				}
+				inputFile >> sSetup;
+			}
 		}
-		inputFile >> setupFormat;
+		const json& setupFormat = sSetup;
 
 		Mood OpennessRelation = Mood(setupFormat["OpennessRelation"][0].get<double>(), setupFormat["OpennessRelation"][1].get<double>(), setupFormat["OpennessRelation"][2].get<double>());
 		Mood ConscientiousnessRelation = Mood(setupFormat["ConscientiousnessRelation"][0].get<double>(), setupFormat["ConscientiousnessRelation"][1].get<double>(), setupFormat["ConscientiousnessRelation"][2].get<double>());
@@ -221,7 +902,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		Personality PleasureRelation = Personality(setupFormat["PleasureRelation"][0].get<double>(), setupFormat["PleasureRelation"][1].get<double>(), setupFormat["PleasureRelation"][2].get<double>(), setupFormat["PleasureRelation"][3].get<double>(), setupFormat["PleasureRelation"][4].get<double>(), fPersEmoRels);
 		Personality ArousalRelation = Personality(setupFormat["ArousalRelation"][0].get<double>(), setupFormat["ArousalRelation"][1].get<double>(), setupFormat["ArousalRelation"][2].get<double>(), setupFormat["ArousalRelation"][3].get<double>(), setupFormat["ArousalRelation"][4].get<double>(), fPersEmoRels);
 		Personality DominanceRelation = Personality(setupFormat["DominanceRelation"][0].get<double>(), setupFormat["DominanceRelation"][1].get<double>(), setupFormat["DominanceRelation"][2].get<double>(), setupFormat["DominanceRelation"][3].get<double>(), setupFormat["DominanceRelation"][4].get<double>(), fPersEmoRels);
-		appraisalManagerInstance = new AppraisalManager();
+		appraisalManagerInstance = fArena->create<AppraisalManager>();
 
 		instance = getInstance(
 			OpennessRelation,
@@ -245,6 +926,66 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 			setupFormat["moodReturnSteps"].get<int>(),
 			setupFormat["Moodneurotismstability"].get<bool>()
 		);
+
+		// optional, older setups keep the default
+		fAc->emotionHistoryLength = setupFormat.value("emotionHistoryLength", fAc->emotionHistoryLength);
+		if (fAc->emotionHistoryLength <= 0)
+			throw std::invalid_argument("Emotion history length not positive.");
+		fAc->defaultEmotionsEpsilon = setupFormat.value("defaultEmotionsEpsilon", fAc->defaultEmotionsEpsilon);
+		if (!(fAc->defaultEmotionsEpsilon >= 0.0))
+			throw std::invalid_argument("Default emotions epsilon negative.");
+
+		// memory capacities are optional, older setups keep the defaults
+		MemoryPolicy memoryPolicy;
+		memoryPolicy.shortCapacity = setupFormat.value("memoryShortCapacity", memoryPolicy.shortCapacity);
+		memoryPolicy.longCapacity = setupFormat.value("memoryLongCapacity", memoryPolicy.longCapacity);
+		memoryPolicy.consolidationBatch = setupFormat.value("memoryConsolidationBatch", memoryPolicy.consolidationBatch);
+		memoryPolicy.decayTime = setupFormat.value("memoryDecayTime", memoryPolicy.decayTime);
+		memoryPolicy.eviction = MemoryPolicy::evictionByName(setupFormat.value("memoryEviction", std::string("intensity")));
+		memory.setPolicy(memoryPolicy);
+	}
+
+	void CharacterManager::setSetup(const json& setup)
+	{
+		std::lock_guard<std::mutex> lock(sSetupMutex);
+		sSetup = setup;
+	}
+
+	void CharacterManager::setOutputFiles(std::string moodLogFile, std::string memoryLogFile)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		fMoodLogFile = moodLogFile;
+		fMemoryLogFile = memoryLogFile;
+		fMoodChannel = -1;
+		fMemoryChannel = -1;
+	}
+
+	std::string CharacterManager::getMoodLogFile()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return fMoodLogFile;
+	}
+
+	std::string CharacterManager::getMemoryLogFile()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return fMemoryLogFile;
+	}
+
+	int CharacterManager::getMoodChannel()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		if (fMoodChannel < 0)
+			fMoodChannel = Telemetry::getInstance().openChannel(fMoodLogFile);
+		return fMoodChannel;
+	}
+
+	int CharacterManager::getMemoryChannel()
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		if (fMemoryChannel < 0)
+			fMemoryChannel = Telemetry::getInstance().openChannel(fMemoryLogFile);
+		return fMemoryChannel;
 	}
 
 	CharacterManager::CharacterManager(std::string name, Personality personality,
@@ -253,6 +994,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		std::list<EmotionType> emotions)
 		:EntityManager(name)
 	{
+		fArena = std::make_shared<AffectArena>(sARENABLOCKSIZE);
 		//appraisalManagerInstance = new AppraisalManager();
 		srand(static_cast <unsigned> (time(0)));
 		memDecayTime = 0.0;
@@ -268,31 +1010,22 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		fCurrentMood = getInstance()->getDefaultMood(personality);
 		// Setup emotion processing
 		fEmotionVector = createEmotionVector();
-		fEmotionHistory = new EmotionHistory();
+		fEmotionHistory = fArena->create<EmotionHistory>(static_cast<size_t>(fAc->emotionHistoryLength));
 		fDecayFunction->init(fAc->emotionDecaySteps);
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		fEmotionEngine = fArena->create<EmotionEngine>(fPersonality, fDecayFunction, fArena);
 		//fDecayTimer = new Timer(true);
 		//emotionDecayId = Timer::AsyncTimerQueue::Instance().create(1000, true, &new EmotionDecayTask(this)->run);
-		std::shared_ptr<EmotionDecayTask> hello(new EmotionDecayTask(this));
-		timer_manager::func_t EmoDecay = [hello](const timer_manager::timer_ptr_t&)
-		{
-			hello->run();
-		};
-		timer_manager::add_timer(fAc->emotionDecayPeriod, EmoDecay, true, "emo");
+		startEmotionTimer(true);
 		//	SetTimer(NULL,0, fAc->emotionDecayPeriod, new EmotionDecayTask(this)->run);
 			//fDecayTimer.schedule(new EmotionDecayTask(this), fAc->emotionDecayPeriod, fAc->emotionDecayPeriod);
 			// Setup mood processing	
-		fMoodEngine = new MoodEngine(fPersonality, fAc->moodStabilityControlledByNeurotism,
+		fMoodEngine = fArena->create<MoodEngine>(fPersonality, fAc->moodStabilityControlledByNeurotism,
 			fDefaultMood, fAc->moodReturnOverallTime);
-		std::shared_ptr<MoodComputationTask> bye(new MoodComputationTask(this));
-		timer_manager::func_t MooddDecay = [bye](const timer_manager::timer_ptr_t&)
-		{
-			bye->run();
-		};
-		timer_manager::add_timer(fAc->moodReturnPeriod, MooddDecay, true, "mood");
+		startMoodTimer(true);
 		//SetTimer(NULL, 1, fAc->moodReturnPeriod,  new MoodComputationTask(this)->run);
 		//fMoodComputationTimer = new Timer(true);
 		//fMoodComputationTimer.schedule(new MoodComputationTask(this), fAc->moodReturnPeriod, fAc->moodReturnPeriod);
+		publishAffectSnapshot();
 		// Setup affect monitoring
 		/*if (!sIntegratedDesktopMode) {
 			//Thread startAffectMonitor = new Thread(){
@@ -309,6 +1042,15 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 
 
+	CharacterManager::~CharacterManager()
+	{
+		// only this character's own timers; they capture this character
+		stopAll();
+		// engines, history and behavior trees go first; the arena itself is freed
+		// as soon as the last emotion handed out to other objects is released
+		fArena->destroyObjects();
+	}
+
 	void CharacterManager::sendToMem(std::string emotion, std::string name, std::string Trigger,  Mood theMood, double intensity, std::string memname)//std::string reaction,
 	{
 		MemoryNames.emplace_back(memname);	
@@ -318,35 +1060,36 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	void CharacterManager::incermentTime()
 	{
 		memDecayTime = memDecayTime + 0.5;
-		memory.decay(memDecayTime);
+		memory.setTime(memDecayTime);
+		memory.consolidate();
+	}
+
+	std::vector<longTermMem*> CharacterManager::recallByMood(size_t k)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return memory.recallByMood(fCurrentMood, k);
+	}
+
+	void CharacterManager::setMemoryLog(std::string path)
+	{
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		memory.attachLog(std::make_shared<MemoryLog>(path));
+		if (memory.getTime() > memDecayTime)
+			memDecayTime = memory.getTime();
+		memory.setTime(memDecayTime);
 	}
 
 	void CharacterManager::emotionAffector(std::string playerName)
 	{
-		std::string memoryName;
-		double intensity = 0.0;
 		std::string key;
-		bool proceed = false;
-		
-		//for each mem that the player by the name passed is a part of 
-		// compare intensities choose mem with highest intensity 
-		for (auto& currentMem : memory.Long)
-		{
-			
-			if (currentMem->name == playerName)
-			{
-				proceed = true;
-				if (fabs(currentMem->intensity) >= fabs(intensity))
-				{
-					intensity = currentMem->intensity;
-					memoryName = currentMem->emotion;
-				}
-			}
-		}
-		if (proceed)
+
+		// the memory about the player with the highest intensity
+		longTermMem* longMem = memory.getStrongestMemory(playerName);
+		if (longMem != nullptr)
 		{
-			longTermMem* longMem = memory.getMemorybyEmotion(memoryName);
-			AppraisalVariables* appvar = new AppraisalVariables();
+			double intensity = memory.getIntensity(longMem);
+			AppraisalVariables noAppraisal;
+			AppraisalVariables* appvar = &noAppraisal;
 			switch (getTypeByName(longMem->emotion))
 			{
 				case EmotionType::Admiration:
@@ -354,15 +1097,15 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Admiration";
 					appvar = getAppraisalVariables(key);
-					appvar->setPraiseworthiness(longMem->intensity);
+					appvar->setPraiseworthiness(intensity);
 					break;
 				}
 				case EmotionType::Anger:
 				{
 					key = "Anger";
 					appvar = getAppraisalVariables(key);
-					appvar->setPraiseworthiness(-longMem->intensity);
-					appvar->setDesirability(-longMem->intensity);
+					appvar->setPraiseworthiness(-intensity);
+					appvar->setDesirability(-intensity);
 					break;
 				}
 
@@ -371,7 +1114,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Joy";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
+					appvar->setDesirability(intensity);
 					break;
 				}
 
@@ -380,7 +1123,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Distress";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
+					appvar->setDesirability(-intensity);
 					break;
 				}
 
@@ -389,8 +1132,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "HappyFor";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setLiking(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setLiking(intensity);
 					break;
 				}
 
@@ -399,8 +1142,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Gloating";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setLiking(longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setLiking(intensity);
 					break;
 				}
 
@@ -409,8 +1152,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Resentment";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setLiking(-longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setLiking(-intensity);
 					break;
 				}
 
@@ -419,8 +1162,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Pity";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setDesirability(-longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setDesirability(-intensity);
 					break;
 				}
 
@@ -429,8 +1172,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Hope";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setLikelihood(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setLikelihood(intensity);
 					break;
 				}
 
@@ -439,8 +1182,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Fear";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setLikelihood(-longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setLikelihood(-intensity);
 					break;
 				}
 
@@ -449,9 +1192,9 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Satisfaction";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setRealization(longMem->intensity);
-					appvar->setLikelihood(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setRealization(intensity);
+					appvar->setLikelihood(intensity);
 					break;
 				}
 
@@ -460,9 +1203,9 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Relief";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setRealization(longMem->intensity);
-					appvar->setLikelihood(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setRealization(intensity);
+					appvar->setLikelihood(intensity);
 					break;
 				}
 
@@ -471,9 +1214,9 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "FearsConfirmed";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setRealization(longMem->intensity);
-					appvar->setLikelihood(longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setRealization(intensity);
+					appvar->setLikelihood(intensity);
 					break;
 				}
 
@@ -482,9 +1225,9 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Disappointment";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setLikelihood(longMem->intensity);
-					appvar->setRealization(longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setLikelihood(intensity);
+					appvar->setRealization(intensity);
 					break;
 				}
 
@@ -493,7 +1236,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Pride";
 					appvar = getAppraisalVariables(key);
-					appvar->setPraiseworthiness(longMem->intensity);
+					appvar->setPraiseworthiness(intensity);
 					break;
 				}
 
@@ -502,7 +1245,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Shame";
 					appvar = getAppraisalVariables(key);
-					appvar->setPraiseworthiness(-longMem->intensity);
+					appvar->setPraiseworthiness(-intensity);
 					break;
 				}
 
@@ -511,7 +1254,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Reproach";
 					appvar = getAppraisalVariables(key);
-					appvar->setPraiseworthiness(-longMem->intensity);
+					appvar->setPraiseworthiness(-intensity);
 					break;
 				}
 
@@ -520,7 +1263,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Liking";
 					appvar = getAppraisalVariables(key);
-					appvar->setAppealingness(longMem->intensity);
+					appvar->setAppealingness(intensity);
 					break;
 				}
 
@@ -529,7 +1272,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Disliking";
 					appvar = getAppraisalVariables(key);
-					appvar->setAppealingness(-longMem->intensity);
+					appvar->setAppealingness(-intensity);
 					break;
 				}
 
@@ -538,8 +1281,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Gratitude";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setPraiseworthiness(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setPraiseworthiness(intensity);
 					break;
 				}
 
@@ -548,8 +1291,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Gratification";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(longMem->intensity);
-					appvar->setPraiseworthiness(longMem->intensity);
+					appvar->setDesirability(intensity);
+					appvar->setPraiseworthiness(intensity);
 					break;
 				}
 
@@ -558,8 +1301,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Remorse";
 					appvar = getAppraisalVariables(key);
-					appvar->setDesirability(-longMem->intensity);
-					appvar->setPraiseworthiness(-longMem->intensity);
+					appvar->setDesirability(-intensity);
+					appvar->setPraiseworthiness(-intensity);
 					break;
 				}
 
@@ -568,8 +1311,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Love";
 					appvar = getAppraisalVariables(key);
-					appvar->setLiking(longMem->intensity);
-					appvar->setPraiseworthiness(longMem->intensity);
+					appvar->setLiking(intensity);
+					appvar->setPraiseworthiness(intensity);
 					break;
 				}
 
@@ -578,20 +1321,22 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 				{
 					key = "Hate";
 					appvar = getAppraisalVariables(key);
-					appvar->setLiking(-longMem->intensity);
-					appvar->setPraiseworthiness(-longMem->intensity);
+					appvar->setLiking(-intensity);
+					appvar->setPraiseworthiness(-intensity);
 					break;
 				}
 			}
-			std::shared_ptr<Emotion::Elicit> Elictor = std::make_shared<Emotion::Elicit>(longMem->trigger);
+			std::uint32_t Elictor = Emotion::elicitorOf(longMem->trigger);
 			appraisalManagerInstance->processBasicECC(appvar, this, Elictor);
 			computeMood();
 
-			outputFile.open(filename1, ios::out | ios::app);
-			//outputFile.open(filename1, ios::out | ios::app);
-			outputFile << longMem->name << ","
-				<< longMem->emotion << "," << longMem->intensity << "," <<  "," << longMem->reaction << ","  << std::endl;
-			outputFile.close();
+			TelemetryRecord record;
+			record.kind = TelemetryRecord::MemoryRecall;
+			record.setLabel(longMem->name);
+			record.setMood(longMem->emotion);
+			record.values[0] = intensity;
+			record.setDetail(longMem->reaction);
+			Telemetry::getInstance().submit(getMemoryChannel(), record);
 		}
 		
 	}
@@ -602,13 +1347,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		if (!fAffectComputationPaused) {
 			//fDecayTimer.cancel();
 			//KillTimer(0, 0);
-			timer_manager::remove_timer(timer_manager::getemo());
-			std::shared_ptr<EmotionDecayTask> hello;
-			timer_manager::func_t EmoDecay = [hello](const timer_manager::timer_ptr_t&)
-			{
-				hello->run();
-			};
-			timer_manager::add_timer(fAc->emotionDecayPeriod, EmoDecay, false, "emo");
+			startEmotionTimer(false);
 			//SetTimer(NULL, 0, fAc->emotionDecayPeriod, new EmotionDecayTask(this)->run);;
 		}
 	}
@@ -626,7 +1365,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	*/
 	void CharacterManager::disableEmotionDecay() {
 		// KillTimer(0, 0);
-		timer_manager::remove_timer(timer_manager::getemo());
+		stopEmotionTimer();
 	}
 
 	/**
@@ -657,23 +1396,12 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		if (fAffectComputationPaused) {
 			//	sLog.info(fName + " emotion computation resumed ...");
 				//SetTimer(NULL, 0, fAc->emotionDecayPeriod, new EmotionDecayTask(this)->run);
-			std::shared_ptr<EmotionDecayTask> hello;
-			timer_manager::func_t EmoDecay = [hello](const timer_manager::timer_ptr_t&)
-			{
-				hello->run();
-			};
-			timer_manager::add_timer(fAc->emotionDecayPeriod, EmoDecay, false, "emo");
+			startEmotionTimer(false);
 			//	sLog.info(fName + " mood computation resumed ...");
-			fMoodEngine = new MoodEngine(fPersonality, fAc->moodStabilityControlledByNeurotism, fDefaultMood, fAc->moodReturnOverallTime);
+			fMoodEngine = fArena->recreate(fMoodEngine, fPersonality, fAc->moodStabilityControlledByNeurotism, fDefaultMood, fAc->moodReturnOverallTime);
 			//KillTimer(0, 1);
-			timer_manager::remove_timer(timer_manager::getmood());
 			//SetTimer(NULL, 1, fAc->moodReturnPeriod, new MoodComputationTask(this)->run);
-			std::shared_ptr<MoodComputationTask> bye;
-			timer_manager::func_t MooddDecay = [bye](const timer_manager::timer_ptr_t&)
-			{
-				bye->run();
-			};
-			timer_manager::add_timer(fAc->moodReturnPeriod, MooddDecay, false, "mood");
+			startMoodTimer(false);
 			fAffectComputationPaused = false;
 			return true;
 		}
@@ -691,16 +1419,11 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	*/
 	bool CharacterManager::stepwiseAffectComputation() {
 		if (fAffectComputationPaused) {
-
-			//timer_manager::process();
-				/*
-				EmotionDecayTask ed =  EmotionDecayTask(this);
-				ed.run();
-				MoodComputationTask mc =  MoodComputationTask(this);
-				mc.run();
-
-				//sLog.info(AffectManager.sInterface.getCurrentAffect().tostd::string());
-				*/
+			std::unique_lock<std::recursive_mutex> lock(_mutex);
+			catchUpAffect();
+			decayStep();
+			moodStep();
+			publishAffectSnapshot();
 			return true;
 		}
 		else {
@@ -811,15 +1534,9 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	*/
 	void CharacterManager::enableMoodComputation() {
 		if (!fAffectComputationPaused) {
-			fMoodEngine = new MoodEngine(fPersonality, fAc->moodStabilityControlledByNeurotism, fDefaultMood, fAc->moodReturnOverallTime);
+			fMoodEngine = fArena->recreate(fMoodEngine, fPersonality, fAc->moodStabilityControlledByNeurotism, fDefaultMood, fAc->moodReturnOverallTime);
 			//KillTimer(0, 1);
-			timer_manager::remove_timer(timer_manager::getmood());
-			std::shared_ptr<MoodComputationTask> bye;
-			timer_manager::func_t MooddDecay = [bye](const timer_manager::timer_ptr_t&)
-			{
-				bye->run();
-			};
-			timer_manager::add_timer(fAc->moodReturnPeriod, MooddDecay, false, "mood");
+			startMoodTimer(false);
 			//SetTimer(NULL, 1, fAc->moodReturnPeriod, new MoodComputationTask(this)->run);
 		}
 	}
@@ -829,10 +1546,10 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	*/
 	void CharacterManager::disableMoodComputation() {
 		// KillTimer(0, 1);
-		timer_manager::remove_timer(timer_manager::getmood());
+		stopMoodTimer();
 	}
 
-	void CharacterManager::addEEC(EEC* eec) {
+	void CharacterManager::addEEC(const EEC& eec) {
 		fEmotionEngine->addEEC(eec);
 
 	}
@@ -846,26 +1563,29 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	// synchronized 
 	void CharacterManager::setDecayFunction(LinearDecayFunction* decayFunction) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		catchUpAffect();
 		disableEmotionDecay();
 		fDecayFunction = decayFunction;
 		fDecayFunction->init(fAc->emotionDecaySteps);
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
 		enableEmotionDecay();
 	}
 
 	void CharacterManager::setDecayFunction(ExponentialDecayFunction* decayFunction) {
+		catchUpAffect();
 		disableEmotionDecay();
 		fDecayFunction = decayFunction;
 		fDecayFunction->init(fAc->emotionDecaySteps);
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
 		enableEmotionDecay();
 	}
 
 	void CharacterManager::setDecayFunction(TangensHyperbolicusDecayFunction* decayFunction) {
+		catchUpAffect();
 		disableEmotionDecay();
 		fDecayFunction = decayFunction;
 		fDecayFunction->init(fAc->emotionDecaySteps);
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
 		enableEmotionDecay();
 	}
 
@@ -906,6 +1626,11 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		return fMoodEngine;
 	}
+
+	EmotionPADCentroid CharacterManager::getEmotionsCenter() {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		return *fMoodEngine->getEmotionsCenter();
+	}
 	/**
 	* Sets a new personality for this character and reinitialize the character's
 	* emotion computation engine.
@@ -915,15 +1640,18 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	// synchronized
 	void CharacterManager::setPersonality(Personality personality) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		catchUpAffect();
 		disableEmotionDecay();
 		disableMoodComputation();
 
 		fPersonality = personality;
+		invalidateDefaultEmotions();
 		fEmotionVector = createEmotionVector();
-		fEmotionHistory = new EmotionHistory();
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		fEmotionHistory = fArena->recreate(fEmotionHistory, static_cast<size_t>(fAc->emotionHistoryLength));
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
 		fDefaultMood = PersonalityMoodRelations::getDefaultMood(personality);
 		fCurrentMood = PersonalityMoodRelations::getDefaultMood(personality);
+		publishAffectSnapshot();
 
 		/*if ((fAffectMonitor != nullptr) && fShowAffectMonitor) {
 			fAffectMonitor.updateEmotionDisplay(fName, fEmotionVector);
@@ -938,6 +1666,7 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	//synchronized 
 	void CharacterManager::setAffectConsts(AffectConsts* ac) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		catchUpAffect();
 		disableEmotionDecay();
 		disableMoodComputation();
 		fAc = ac;
@@ -946,7 +1675,8 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 		perEmoRels->setPersonalityEmotionInfluence(ac->personalityEmotionInfluence);
 		perEmoRels->setEmotionMaxBaseline(ac->emotionMaxBaseline);
 		fPersonality.setPersonalityEmotionsRelations(perEmoRels);
-		fEmotionEngine = new EmotionEngine(fPersonality, fDecayFunction);
+		invalidateDefaultEmotions();
+		fEmotionEngine = fArena->recreate(fEmotionEngine, fPersonality, fDecayFunction, fArena);
 		enableMoodComputation();
 		enableEmotionDecay();
 	}
@@ -968,11 +1698,13 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	// synchronized
 	std::shared_ptr<EmotionVector> CharacterManager::inferEmotions() {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
-		std::shared_ptr<EmotionVector> result = createEmotionVector();
+		catchUpAffect();
+		std::shared_ptr<EmotionVector> result = createEmotionDelta();
 		result = fEmotionEngine->inferEmotions(result, fEmotionHistory, fCurrentMood);
 		fEmotionEngine->clearEEC();
 		fEmotionHistory->add(result);
 		fEmotionVector = fEmotionHistory->getEmotionalState(fEmotionVector);
+		publishAffectSnapshot();
 
 		/*if ((fAffectMonitor != nullptr) && fShowAffectMonitor) {
 			fAffectMonitor.updateEmotionDisplay(fName, fEmotionVector);
@@ -985,15 +1717,17 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	// synchronized 
 	std::shared_ptr<EmotionVector> CharacterManager::infuseBioSignalEmotions(std::shared_ptr<PADEmotion> e) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		catchUpAffect();
 		if (fAffectComputationPaused) {
 			// if the affect computation is paused, return the last active affect output document
 			return fEmotionHistory->getEmotionalState(fEmotionVector);
 		}
 
-		std::shared_ptr<EmotionVector> result = createEmotionVector();
+		std::shared_ptr<EmotionVector> result = createEmotionDelta();
 		result->add(e);
 		fEmotionHistory->add(result);
 		fEmotionVector = fEmotionHistory->getEmotionalState(fEmotionVector);
+		publishAffectSnapshot();
 
 		/*if ((fAffectMonitor != nullptr) && fShowAffectMonitor) {
 			fAffectMonitor.updateEmotionDisplay(fName, fEmotionVector);
@@ -1031,12 +1765,46 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 	* Stops all affect processing, decaying tasks
 	*/
 	void CharacterManager::stopAll() {
-		timer_manager::remove_timer(timer_manager::getemo());
-		timer_manager::remove_timer(timer_manager::getmood());
+		stopEmotionTimer();
+		stopMoodTimer();
 		// KillTimer(0, 0);
 		// KillTimer(0, 1);
 	}
 
+	void CharacterManager::startEmotionTimer(bool repeat) {
+		stopEmotionTimer();
+		std::shared_ptr<EmotionDecayTask> hello(new EmotionDecayTask(this));
+		timer_manager::func_t EmoDecay = [hello](const timer_manager::timer_ptr_t&)
+		{
+			hello->tick();
+		};
+		fEmotionTimer = timer_manager::add_timer(fAc->emotionDecayPeriod, EmoDecay, repeat, "emo");
+	}
+
+	void CharacterManager::startMoodTimer(bool repeat) {
+		stopMoodTimer();
+		std::shared_ptr<MoodComputationTask> bye(new MoodComputationTask(this));
+		timer_manager::func_t MooddDecay = [bye](const timer_manager::timer_ptr_t&)
+		{
+			bye->tick();
+		};
+		fMoodTimer = timer_manager::add_timer(fAc->moodReturnPeriod, MooddDecay, repeat, "mood");
+	}
+
+	void CharacterManager::stopEmotionTimer() {
+		if (fEmotionTimer != nullptr) {
+			timer_manager::remove_timer(fEmotionTimer);
+			fEmotionTimer = nullptr;
+		}
+	}
+
+	void CharacterManager::stopMoodTimer() {
+		if (fMoodTimer != nullptr) {
+			timer_manager::remove_timer(fMoodTimer);
+			fMoodTimer = nullptr;
+		}
+	}
+
 	/**
 	* Implements EmotionMaintenancestd::listener
 	*/
@@ -1048,28 +1816,28 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 		// only add the emotion to the right character :-)
 		if (e.getCharacterName() == fName) {
-			std::shared_ptr<EmotionVector> emotions = createEmotionVector();
-			std::list<std::shared_ptr<Emotion>> freshDummyEmotions = emotions->getEmotions();
-			for (const auto& it : freshDummyEmotions) {
-				EmotionType emotionType = it->getType();
-				if (changedEmotionType == emotionType) {
-					if (emotionType == EmotionType::Physical) {
-						// This is a simulation of pad values derived from physical biosensor data
-						double p = (random() - 0.5) * 2;
-						double a = (random() - 0.5) * 2;
-						double d = (random() - 0.5) * 2;
-						std::shared_ptr<PADEmotion> newEmotion = std::make_shared<PADEmotion>(Mood(p, a, d), e.intensity(), "Simulated Bio Sensor Input");
-						emotions->add(newEmotion);
-					}
-					else {
-						double intensity = (e.intensity() < it->getBaseline()) ? it->getBaseline() : e.intensity();
-						std::shared_ptr<Emotion> newEmotion = std::make_shared<Emotion>(emotionType, intensity, it->getBaseline(), "User maintenance");
-						emotions->add(newEmotion);
-					}
+			std::unique_lock<std::recursive_mutex> lock(_mutex);
+			catchUpAffect();
+			std::shared_ptr<EmotionVector> emotions = createEmotionDelta();
+			if (emotions->hasType(changedEmotionType)) {
+				if (changedEmotionType == EmotionType::Physical) {
+					// This is a simulation of pad values derived from physical biosensor data
+					double p = (random() - 0.5) * 2;
+					double a = (random() - 0.5) * 2;
+					double d = (random() - 0.5) * 2;
+					std::shared_ptr<PADEmotion> newEmotion = std::make_shared<PADEmotion>(Mood(p, a, d), e.intensity(), "Simulated Bio Sensor Input");
+					emotions->add(newEmotion);
+				}
+				else {
+					double baseline = getEmotionBaseline(changedEmotionType);
+					double intensity = (e.intensity() < baseline) ? baseline : e.intensity();
+					std::shared_ptr<Emotion> newEmotion = std::make_shared<Emotion>(changedEmotionType, intensity, baseline, "User maintenance");
+					emotions->add(newEmotion);
 				}
 			}
 			fEmotionHistory->add(emotions);
 			fEmotionVector = fEmotionHistory->getEmotionalState(fEmotionVector);
+			publishAffectSnapshot();
 
 			// show elicited emotion(s) in affect monitor even if affect computation is paused
 		/*	if ((fAffectMonitor != nullptr) && fShowAffectMonitor) {
@@ -1085,11 +1853,20 @@ std::string filename1 = "./test/negativemed-Memorycapture.csv";
 
 	void CharacterManager::computeMood()
 	{
-		fMoodEngine = new MoodEngine(fPersonality, fAc->moodStabilityControlledByNeurotism,
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		catchUpAffect();
+		fMoodEngine = fArena->recreate(fMoodEngine, fPersonality, fAc->moodStabilityControlledByNeurotism,
 			fDefaultMood, fAc->moodReturnOverallTime);
-		std::shared_ptr<MoodComputationTask> bye(new MoodComputationTask(this));
-		bye->run();
+		MoodComputationTask(this).run();
 	}
 
 
-PersonalityMoodRelations* CharacterManager::instance = nullptr;
\ No newline at end of file
+PersonalityMoodRelations* CharacterManager::instance = nullptr;
+json CharacterManager::sSetup;
+std::mutex CharacterManager::sSetupMutex;
+const double CharacterManager::sLODMINIMPORTANCE[CharacterManager::sLODCOUNT] = { 0.75, 0.5, 0.25, -1.0 };
+const int CharacterManager::sLODTICKFACTOR[CharacterManager::sLODCOUNT] = { 1, 4, 16, 64 };
+const size_t CharacterManager::sARENABLOCKSIZE;
+const std::uint32_t CharacterManager::sCHECKPOINTMAGIC;
+const std::uint32_t CharacterManager::sPOPULATIONMAGIC;
+const std::uint32_t CharacterManager::sCHECKPOINTVERSION;
\ No newline at end of file
@@ -26,7 +26,7 @@
 	}
 
 
-	EmotionEngine::EmotionEngine(Personality personality, DecayFunction* decayFunction) {
+	EmotionEngine::EmotionEngine(Personality personality, DecayFunction* decayFunction, std::shared_ptr<AffectArena> arena) {
 		fPerEmoRel = personality.getPersonalityEmotionsRelations();
 		if (personality == nullptr) {
 			throw std::invalid_argument("Personality not specified.");
@@ -36,21 +36,42 @@
 		}
 		fDecayFunction = decayFunction;
 		fPersonality = personality;
+		fArena = arena;
+		// at most one condition for events, actions and objects plus realizations
+		listOfEEC.reserve(4);
 	}
 	double EmotionEngine::adjustIntensity(double intensity, EmotionType type, Mood mood) {
-		double result = intensity * (1 + fPerEmoRel->getPersonalityInfluence(fPersonality, type));
-		Personality temporalPersonality = fPerMoodRel->getMoodyPersonalityTraits(mood);
-		//log.info("Temporal mood personality is " + temporalPersonality);
-		double moodyResult = fPerEmoRel->getPersonalityInfluence(temporalPersonality, type);
-		//log.info(type.toString() + " personality influcenced intensity= " + result + " mood influence= " + moodyResult);
-		result = result + moodyResult;
-		double baseline = fPerEmoRel->getEmotionBaseline(fPersonality, type);
-		double moodyBaseline = fPerEmoRel->getEmotionBaseline(fPerMoodRel->getMoodyPersonalityTraits(mood), type);
-		baseline = baseline + moodyBaseline;
-		result = (result > 1.0) ? 1.0 : result;
-		result = (result < baseline) ? baseline : result;
-		return result;
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		updateCoefficients(mood.getPleasure(), mood.getArousal(), mood.getDominance());
+		return adjustCached(intensity, type);
+	}
+
+	void EmotionEngine::updateCoefficients(double pleasure, double arousal, double dominance) {
+		bool personalityChanged = !fPersonalityCached || (fPerEmoRelVersion != fPerEmoRel->getVersion());
+		if (personalityChanged) {
+			double personality[PersonalityEmotionsRelations::sTRAITS];
+			fPersonality.getTraits(personality);
+			fPerEmoRel->getInfluences(personality, 1, fGain, fBaseline);
+			for (size_t i = 0; i < EmotionSlots::sSLOTS; i++)
+				fGain[i] = 1 + fGain[i];
+			fPerEmoRelVersion = fPerEmoRel->getVersion();
+			fPersonalityCached = true;
+		}
+		if (personalityChanged || !fMoodCached || (fPerMoodRelVersion != PersonalityMoodRelations::getVersion())
+			|| (pleasure != fCachedPleasure) || (arousal != fCachedArousal) || (dominance != fCachedDominance)) {
+			double moody[PersonalityEmotionsRelations::sTRAITS];
+			PersonalityMoodRelations::getMoodyTraits(pleasure, arousal, dominance, moody);
+			fPerEmoRel->getInfluences(moody, 1, fMoodInfluence, fFloor);
+			for (size_t i = 0; i < EmotionSlots::sSLOTS; i++)
+				fFloor[i] = fBaseline[i] + fFloor[i];
+			fPerMoodRelVersion = PersonalityMoodRelations::getVersion();
+			fCachedPleasure = pleasure;
+			fCachedArousal = arousal;
+			fCachedDominance = dominance;
+			fMoodCached = true;
+		}
 	}
+
 	/**
 	* Adds a new element to the list of Emotion Eliciting Conditions. This method
 	* throws an
@@ -62,31 +83,25 @@
 	*
 	* @param eec the std::make_shared<Emotion> Eliciting Condition.
 	*
-	* @throws nullptrPointerException if the Emotion Eliciting Condition is not
-	* specified.
-	*
 	* @throws IllegalStateException if an EEC for event-based emotions,
 	* action-based emotions, or Emotion::Elicit-based emotions already exists.
 	*
 	* @see EmotionVector
 	*/
-	void EmotionEngine::addEEC(EEC* eec) {
-		if (eec == nullptr) {
-			throw std::invalid_argument("Emotion Eliciting Condition not specified.");
-		}
-		if (eec->appealingness != nullptr) // appraisal of Emotion::Elicit
+	void EmotionEngine::addEEC(const EEC& eec) {
+		if (eec.has(EECValues::HasAppealingness)) // appraisal of Emotion::Elicit
 		{
-			if (ElicitEEC == nullptr) {
-				ElicitEEC = eec;
+			if (!ElicitEEC) {
+				ElicitEEC = true;
 			}
 			else {
 				throw std::invalid_argument("EEC for Emotion::Elicit-based emotions already exists: ");
 			}
 		}
-		else if (eec->praiseworthiness != nullptr) // appraisal of action
+		else if (eec.has(EECValues::HasPraiseworthiness)) // appraisal of action
 		{
-			if (actionEEC == nullptr) {
-				actionEEC = eec;
+			if (!actionEEC) {
+				actionEEC = true;
 			}
 			else {
 				throw std::invalid_argument("EEC for action-based emotions already exists: ");
@@ -94,8 +109,8 @@
 		}
 
 
-		else if (eventEEC == nullptr) { // appraisal of event
-			eventEEC = eec;
+		else if (!eventEEC) { // appraisal of event
+			eventEEC = true;
 		}
 		else // 	{
 			 //  	// THIS IS THE CASE, IF TWO Event-based EECs (second is confirmation)
@@ -116,9 +131,9 @@
 	*/
 	void EmotionEngine::clearEEC() {
 		listOfEEC.clear();
-		eventEEC = nullptr;
-		actionEEC = nullptr;
-		ElicitEEC = nullptr;
+		eventEEC = false;
+		actionEEC = false;
+		ElicitEEC = false;
 	}
 
 
@@ -139,24 +154,32 @@
 	// synchronized
 	std::shared_ptr<EmotionVector> EmotionEngine::decay(EmotionHistory* history,
 		std::shared_ptr<EmotionVector> emotions,
-		std::shared_ptr<EmotionVector> defaultEmotions) {
+		std::shared_ptr<EmotionVector> defaultEmotions, int steps) {
 		std::unique_lock<std::recursive_mutex> lock(_mutex);
 		if (history == nullptr) {
 			throw std::invalid_argument("No history specified.");
 		}
+		if (steps < 1) {
+			throw std::invalid_argument("Number of decay steps not positive.");
+		}
 		for (int i = 0; i < history->size(); i++)
 		{
-			auto& it = history->get(i);
-			for (auto& emotion = it->Getmap().begin(); emotion != it->Getmap().end(); ++emotion)
+			const std::shared_ptr<EmotionVector>& emotions = history->get(i);
+			// replacing an emotion keeps its slot, the iteration stays valid
+			for (const std::shared_ptr<Emotion>& emotion : *emotions)
 			{
 
-				if (emotion->second->getIntensity() > emotion->second->getBaseline()) {
+				if (emotion->getIntensity() > emotion->getBaseline()) {
 					//debug log.info("At emotion history " + i + " decaying " + emotion.getType() + "(" + prettyPrint(emotion->getIntensity()) + ")");
-					history->get(i)->add(fDecayFunction->decay(emotion->second));
+					// decay functions change the emotion in place
+					double intensity = emotion->getIntensity();
+					history->replace(i, fDecayFunction->decay(emotion, steps), intensity);
 				}
 			}
 		}
-		history->removeFirstIfInactive();
+		// every step removed at most one inactive element
+		for (int i = 0; (i < steps) && history->removeFirstIfInactive(); i++) {
+		}
 		emotions = history->getEmotionalState(defaultEmotions);
 		return emotions;
 	}
@@ -175,7 +198,7 @@
 		std::list<float> results;
 		results.push_back(emotion->getIntensity());
 
-		std::shared_ptr<Emotion> decayedEmotion = std::make_shared<Emotion>(emotion->getType(), emotion->getIntensity(), emotion->getBaseline(), emotion->getElicitor());
+		std::shared_ptr<Emotion> decayedEmotion = AffectArena::makeShared<Emotion>(fArena, emotion->getType(), emotion->getIntensity(), emotion->getBaseline(), emotion->getElicitor());
 		while (decayedEmotion->getIntensity() - 0.001 > decayedEmotion->getBaseline()) {
 			//log.info("At emotion history " + i + " decaying " + decayedEmotion.getType() + "(" + prettyPrint(decayedEmotion->getIntensity()) + ")");
 			fDecayFunction->decay(decayedEmotion);
@@ -209,6 +232,7 @@
 		if (mood == nullptr) {
 			throw std::invalid_argument("mood not specified.");
 		}
+		updateCoefficients(mood.getPleasure(), mood.getArousal(), mood.getDominance());
 		// temporarily generated emotions
 		std::list<std::shared_ptr<Emotion>> tempEmotions;
 		// emotions used for compound emotions
@@ -220,72 +244,72 @@
 
 			return nullptr;
 		}
-		for (auto& allEEC : listOfEEC) {
-			EEC* eec = allEEC;
-			//log.fine("EEC input " + eec->getElicitor());
+		for (const EEC& eec : listOfEEC) {
+			const EECValues& values = eec.values;
+			//log.fine("EEC input " + eec.elicitor);
 			EmotionType type = EmotionType::Undefined;
 			double intensity = 0.0;
 
 
 			// Well-being and Prospect-based Group:
-			if (eec->desirabilityForSelf != nullptr) {
+			if (values.has(EECValues::HasDesirabilityForSelf)) {
 
-				if (eec->likelihood == nullptr) {
-					type = eec->desirabilityForSelf->isDesirable()
+				if (!values.has(EECValues::HasLikelihood)) {
+					type = (values.desirabilityForSelf >= 0.0)
 						? EmotionType::Joy : EmotionType::Distress;
-					intensity = eec->desirabilityForSelf->absDegree();
+					intensity = std::fabs(values.desirabilityForSelf);
 					intensity = adjustIntensity(intensity, type, mood);
 
 					// collect all relevant appraisal variables for this emotion
 					EmotionAppraisalVars eav = EmotionAppraisalVars();
-					eav.setDesirability(eec->desirabilityForSelf->getDegree());
+					eav.setDesirability(values.desirabilityForSelf);
 					eav.setAgency(true);
-					tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-						fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, eec->elicitor));
+					tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+						fBaseline[type], eav, eec.getElicitor()));
 				}
 				else {
-					type = eec->desirabilityForSelf->isDesirable()
+					type = (values.desirabilityForSelf >= 0.0)
 						? EmotionType::Hope : EmotionType::Fear;
 					//PG: TODO: provide better intensity calculation with regrad to the likelihood in the situation
-					intensity = max(eec->desirabilityForSelf->absDegree(), eec->likelihood->absDegree());
+					intensity = max(std::fabs(values.desirabilityForSelf), std::fabs(values.likelihood));
 					intensity = adjustIntensity(intensity, type, mood);
 
 					// collect all relevant appraisal variables for this emotion
 					EmotionAppraisalVars eav = EmotionAppraisalVars();
-					eav.setDesirability(eec->desirabilityForSelf->getDegree());
-					eav.setLikelihood(eec->likelihood->absDegree());
+					eav.setDesirability(values.desirabilityForSelf);
+					eav.setLikelihood(std::fabs(values.likelihood));
 					eav.setAgency(true);
 
-					tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-						fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, eec->elicitor));
+					tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+						fBaseline[type], eav, eec.getElicitor()));
 				}
 			}
 			// Fortunes-Of-Others Group:
-			if (eec->desirabilityForOther != nullptr && eec->liking != nullptr) {
-				if (eec->liking->isLikely()) {
-					type = eec->desirabilityForOther->isDesirable()
+			if (values.has(EECValues::HasDesirabilityForOther) && values.has(EECValues::HasLiking)) {
+				if ((values.liking >= 0.0)) {
+					type = (values.desirabilityForOther >= 0.0)
 						? EmotionType::HappyFor : EmotionType::Pity;
 				}
 				else {
-					type = eec->desirabilityForOther->isDesirable()
+					type = (values.desirabilityForOther >= 0.0)
 						? EmotionType::Resentment : EmotionType::Gloating;
 				}
 
-				intensity = max(eec->desirabilityForOther->absDegree(), eec->liking->absDegree());
+				intensity = max(std::fabs(values.desirabilityForOther), std::fabs(values.liking));
 				intensity = adjustIntensity(intensity, type, mood);
 
 				// collect all relevant appraisal variables for this emotion
 				EmotionAppraisalVars eav = EmotionAppraisalVars();
-				eav.setDesirability(eec->desirabilityForOther->getDegree());
-				eav.setLikelihood(eec->liking->absDegree());
+				eav.setDesirability(values.desirabilityForOther);
+				eav.setLikelihood(std::fabs(values.liking));
 				eav.setAgency(false);
 
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eec->elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eec.getElicitor()));
 			}
 			// Confirmation Group:
-			if (eec->realization != nullptr) {
+			if (values.has(EECValues::HasRealization)) {
 				// 	// THIS IS THE CASE, IF TWO Event-based EECs (second is confirmation)
 				// 	// are given as input
 				// 	// is there a recently elicited relevant emotion hope or fear
@@ -310,79 +334,74 @@
 				// 	    }
 				// 	  }
 				// 	}
-				// traverse history in reverse order, latest element first
-				for (int i = history->size() - 1; i >= 0; i--) {
-					std::list<std::shared_ptr<Emotion>> oldEmotions = history->get(i)->getEmotions();
-					for (auto& old : oldEmotions) {
-						if (old->getElicitor() != nullptr) {
-							EmotionType oldType = old->getType();
-							if ((oldType == EmotionType::Hope || oldType == EmotionType::Fear)
-								&& old->getElicitor()->operator==(eec->getElicitor())) {
-								if (eec->realization->isConfirmed()) {
-									type = (oldType == EmotionType::Hope)
-										? EmotionType::Satisfaction : EmotionType::FearsConfirmed;
-								}
-								else {
-									type = (oldType == EmotionType::Hope)
-										? EmotionType::Disappointment : EmotionType::Relief;
-								}
-								intensity = max(old->getIntensity(), eec->realization->absDegree());
-								intensity = adjustIntensity(intensity, type, mood);
-
-								// collect all relevant appraisal variables for this emotion
-								EmotionAppraisalVars eav = EmotionAppraisalVars();
-
-								eav.setDesirability(old->getAppraisalVariables().desirability);
-								eav.setLikelihood(old->getAppraisalVariables().likelihood);
-								eav.setRealization(eec->realization->isConfirmed());
-								eav.setAgency(true);
-
-								tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-									fPerEmoRel->getEmotionBaseline(fPersonality, type),
-									eec->elicitor));
-								// set intensity of hope or fear in history to baseline
-								// if anticipated event (elicitor) has occurred (is
-								// confirmed) or has failed to occur (is disconfirmed)
-								history->get(i)->add(std::make_shared<Emotion>(oldType, old->getBaseline(), old->getBaseline(), eav,
-									old->getElicitor()));
-							}
-						}
+				// the hopes and fears of this elicitor, latest history element first
+				for (const auto& entry : history->getEmotionsByElicitor(eec.getElicitor(),
+					(1u << EmotionType::Hope) | (1u << EmotionType::Fear))) {
+					int i = entry.first;
+					const std::shared_ptr<Emotion>& old = entry.second;
+					EmotionType oldType = old->getType();
+					if ((values.realization >= 0.0)) {
+						type = (oldType == EmotionType::Hope)
+							? EmotionType::Satisfaction : EmotionType::FearsConfirmed;
 					}
+					else {
+						type = (oldType == EmotionType::Hope)
+							? EmotionType::Disappointment : EmotionType::Relief;
+					}
+					intensity = max(old->getIntensity(), std::fabs(values.realization));
+					intensity = adjustIntensity(intensity, type, mood);
+
+					// collect all relevant appraisal variables for this emotion
+					EmotionAppraisalVars eav = EmotionAppraisalVars();
+
+					eav.setDesirability(old->getAppraisalVariables().desirability);
+					eav.setLikelihood(old->getAppraisalVariables().likelihood);
+					eav.setRealization((values.realization >= 0.0));
+					eav.setAgency(true);
+
+					tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+						fBaseline[type],
+						eec.getElicitor()));
+					// set intensity of hope or fear in history to baseline
+					// if anticipated event (elicitor) has occurred (is
+					// confirmed) or has failed to occur (is disconfirmed)
+					history->replace(i, AffectArena::makeShared<Emotion>(fArena, oldType, old->getBaseline(), old->getBaseline(), eav,
+						old->getElicitor()));
 				}
 			}
 			// Attribution Group:
-			if (eec->praiseworthiness != nullptr) {
-				if (eec->praiseworthiness->isPraiseworthy()) {
-					type = (eec->character->getAgency() == Agency::SELF.getAgency()) ? EmotionType::Pride : EmotionType::Admiration;
+			if (values.has(EECValues::HasPraiseworthiness)) {
+				if ((values.praiseworthiness >= 0.0)) {
+					type = values.selfAgency ? EmotionType::Pride : EmotionType::Admiration;
 				}
 				else {
-					type = (eec->character->getAgency() == Agency::SELF.getAgency()) ? EmotionType::Shame : EmotionType::Reproach;
+					type = values.selfAgency ? EmotionType::Shame : EmotionType::Reproach;
 				}
-				intensity = eec->praiseworthiness->absDegree();
+				intensity = std::fabs(values.praiseworthiness);
 				intensity = adjustIntensity(intensity, type, mood);
 
 				// collect all relevant appraisal variables for this emotion
 				EmotionAppraisalVars eav = EmotionAppraisalVars();
 
-				eav.setPraiseworthy(eec->praiseworthiness->getDegree());
-				eav.setAgency((eec->character->getAgency() == Agency::SELF.getAgency()) ? true : false);
+				eav.setPraiseworthy(values.praiseworthiness);
+				eav.setAgency(values.selfAgency);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, eec->elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, eec.getElicitor()));
 			}
 			// Attraction Group:
-			if (eec->appealingness != nullptr) {
-				type = eec->appealingness->isAppealing() ? EmotionType::Liking : EmotionType::Disliking;
-				intensity = eec->appealingness->absDegree();
+			if (values.has(EECValues::HasAppealingness)) {
+				type = (values.appealingness >= 0.0) ? EmotionType::Liking : EmotionType::Disliking;
+				intensity = std::fabs(values.appealingness);
 				intensity = adjustIntensity(intensity, type, mood);
 
 				// collect all relevant appraisal variables for this emotion
 				EmotionAppraisalVars eav = EmotionAppraisalVars();
 
-				eav.setAppealingness(eec->appealingness->absDegree());
+				eav.setAppealingness(std::fabs(values.appealingness));
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eec->elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eec.getElicitor()));
 			}
 		} // end-for
 		  // ---------------------------------------------------
@@ -442,13 +461,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Gratification
 		histJoy = ((joy == nullptr) && (pride != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Joy, pride->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Joy, pride->getElicitor()) : nullptr;
 		histPride = ((joy != nullptr) && (pride == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Pride, joy->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Pride, joy->getElicitor()) : nullptr;
 		if ((histJoy != nullptr) || (histPride != nullptr)) {
 			EmotionType type = EmotionType::Gratification;
 			if (joy != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = joy->getElicitor();
+				std::uint32_t elicitor = joy->getElicitor();
 				double intensity = max(joy->getIntensity(), histPride->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -460,13 +479,13 @@
 				eav.setAgency(true);
 
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(joy);
 				history->removeEmotionByElicitor(histPride, elicitor);
 			}
 			if (pride != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = pride->getElicitor();
+				std::uint32_t elicitor = pride->getElicitor();
 				double intensity = max(histJoy->getIntensity(), pride->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -478,19 +497,19 @@
 				eav.setAgency(true);
 
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(pride);
 				history->removeEmotionByElicitor(histJoy, elicitor);
 			}
 		}
 
 		// current emotions elicited at the same time
-		if (joy != nullptr && pride != nullptr && joy->getElicitor() != nullptr
-			&& joy->getElicitor()->operator==(pride->getElicitor())) {
+		if (joy != nullptr && pride != nullptr && joy->getElicitor() != ElicitorRegistry::sNONE
+			&& joy->getElicitor() == pride->getElicitor()) {
 			//log.info("Build gratification out of current elicitors");
 			EmotionType type = EmotionType::Gratification;
-			std::shared_ptr<Emotion::Elicit> elicitor = pride->getElicitor();
+			std::uint32_t elicitor = pride->getElicitor();
 			double intensity = max(joy->getIntensity(), pride->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
 
@@ -502,8 +521,8 @@
 			eav.setAgency(true);
 
 
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], eav, elicitor));
 			usedEmotions.insert(joy);
 			usedEmotions.insert(pride);
 		}
@@ -512,13 +531,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Gratitude
 		histJoy = ((joy == nullptr) && (admiration != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Joy, admiration->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Joy, admiration->getElicitor()) : nullptr;
 		histAdmiration = ((joy != nullptr) && (admiration == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Admiration, joy->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Admiration, joy->getElicitor()) : nullptr;
 		if ((histJoy != nullptr) || (histAdmiration != nullptr)) {
 			EmotionType type = EmotionType::Gratitude;
 			if (joy != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = joy->getElicitor();
+				std::uint32_t elicitor = joy->getElicitor();
 				double intensity = max(joy->getIntensity(), histAdmiration->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -530,13 +549,13 @@
 				eav.setAgency(false);
 
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(joy);
 				history->removeEmotionByElicitor(histAdmiration, elicitor);
 			}
 			if (admiration != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = admiration->getElicitor();
+				std::uint32_t elicitor = admiration->getElicitor();
 				double intensity = max(admiration->getIntensity(), histJoy->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -547,21 +566,21 @@
 				eav.setPraiseworthy(histJoy->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(admiration);
 				history->removeEmotionByElicitor(histJoy, elicitor);
 			}
 		}
 		// current emotions elicited at the same time
-		if (joy != nullptr && admiration != nullptr && joy->getElicitor() != nullptr
-			&& joy->getElicitor()->operator==(admiration->getElicitor())) {
+		if (joy != nullptr && admiration != nullptr && joy->getElicitor() != ElicitorRegistry::sNONE
+			&& joy->getElicitor() == admiration->getElicitor()) {
 			EmotionType type = EmotionType::Gratitude;
-			std::shared_ptr<Emotion::Elicit> elicitor = admiration->getElicitor();
+			std::uint32_t elicitor = admiration->getElicitor();
 			double intensity = max(joy->getIntensity(), admiration->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], elicitor));
 			usedEmotions.insert(joy);
 			usedEmotions.insert(admiration);
 		}
@@ -570,13 +589,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Remorse
 		histDistress = ((distress == nullptr) && (shame != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Distress, shame->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Distress, shame->getElicitor()) : nullptr;
 		histShame = ((distress != nullptr) && (shame == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Shame, distress->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Shame, distress->getElicitor()) : nullptr;
 		if ((histDistress != nullptr) || (histShame != nullptr)) {
 			EmotionType type = EmotionType::Remorse;
 			if (distress != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = distress->getElicitor();
+				std::uint32_t elicitor = distress->getElicitor();
 				double intensity = max(distress->getIntensity(), histShame->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -587,13 +606,13 @@
 				eav.setPraiseworthy(histShame->getAppraisalVariables().praiseworthy);
 				eav.setAgency(true);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(distress);
 				history->removeEmotionByElicitor(histShame, elicitor);
 			}
 			if (shame != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = shame->getElicitor();
+				std::uint32_t elicitor = shame->getElicitor();
 				double intensity = max(shame->getIntensity(), histDistress->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -604,17 +623,17 @@
 				eav.setPraiseworthy(shame->getAppraisalVariables().praiseworthy);
 				eav.setAgency(true);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(shame);
 				history->removeEmotionByElicitor(histDistress, elicitor);
 			}
 		}
 		// current emotions elicited at the same time
-		if (distress != nullptr && shame != nullptr && distress->getElicitor() != nullptr
-			&& distress->getElicitor()->operator==(shame->getElicitor())) {
+		if (distress != nullptr && shame != nullptr && distress->getElicitor() != ElicitorRegistry::sNONE
+			&& distress->getElicitor() == shame->getElicitor()) {
 			EmotionType type = EmotionType::Remorse;
-			std::shared_ptr<Emotion::Elicit> elicitor = shame->getElicitor();
+			std::uint32_t elicitor = shame->getElicitor();
 			double intensity = max(distress->getIntensity(), shame->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
 
@@ -625,8 +644,8 @@
 			eav.setPraiseworthy(shame->getAppraisalVariables().praiseworthy);
 			eav.setAgency(true);
 
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], eav, elicitor));
 			usedEmotions.insert(distress);
 			usedEmotions.insert(shame);
 		}
@@ -635,13 +654,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Anger
 		histDistress = ((distress == nullptr) && (reproach != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Distress, reproach->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Distress, reproach->getElicitor()) : nullptr;
 		histReproach = ((distress != nullptr) && (reproach == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Reproach, distress->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Reproach, distress->getElicitor()) : nullptr;
 		if ((histDistress != nullptr) || (histReproach != nullptr)) {
 			EmotionType type = EmotionType::Anger;
 			if (distress != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = distress->getElicitor();
+				std::uint32_t elicitor = distress->getElicitor();
 				double intensity = max(distress->getIntensity(), histReproach->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -652,13 +671,13 @@
 				eav.setPraiseworthy(histReproach->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(distress);
 				history->removeEmotionByElicitor(histReproach, elicitor);
 			}
 			if (reproach != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = reproach->getElicitor();
+				std::uint32_t elicitor = reproach->getElicitor();
 				double intensity = max(reproach->getIntensity(), histDistress->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -669,18 +688,18 @@
 				eav.setPraiseworthy(reproach->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], elicitor));
 				usedEmotions.insert(reproach);
 				history->removeEmotionByElicitor(histDistress, elicitor);
 			}
 		}
 		// Current emotions elicited at the same time
-		if (distress != nullptr && reproach != nullptr && distress->getElicitor() != nullptr
-			&& distress->getElicitor()->operator==(reproach->getElicitor())) {
+		if (distress != nullptr && reproach != nullptr && distress->getElicitor() != ElicitorRegistry::sNONE
+			&& distress->getElicitor() == reproach->getElicitor()) {
 
 			EmotionType type = EmotionType::Anger;
-			std::shared_ptr<Emotion::Elicit> elicitor = reproach->getElicitor();
+			std::uint32_t elicitor = reproach->getElicitor();
 			double intensity = max(distress->getIntensity(), reproach->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
 
@@ -691,8 +710,8 @@
 			eav.setPraiseworthy(reproach->getAppraisalVariables().praiseworthy);
 			eav.setAgency(true);
 
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], elicitor));
 			usedEmotions.insert(distress);
 			usedEmotions.insert(reproach);
 		}
@@ -704,13 +723,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Love
 		histLiking = ((liking == nullptr) && (admiration != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Liking, admiration->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Liking, admiration->getElicitor()) : nullptr;
 		histAdmiration = ((liking != nullptr) && (admiration == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Admiration, liking->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Admiration, liking->getElicitor()) : nullptr;
 		if ((histLiking != nullptr) || (histAdmiration != nullptr)) {
 			EmotionType type = EmotionType::Love;
 			if (liking != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = liking->getElicitor();
+				std::uint32_t elicitor = liking->getElicitor();
 				double intensity = max(liking->getIntensity(), histAdmiration->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -721,13 +740,13 @@
 				eav.setPraiseworthy(histAdmiration->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(liking);
 				history->removeEmotionByElicitor(histAdmiration, elicitor);
 			}
 			if (admiration != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = admiration->getElicitor();
+				std::uint32_t elicitor = admiration->getElicitor();
 				double intensity = max(admiration->getIntensity(), histLiking->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -738,17 +757,17 @@
 				eav.setPraiseworthy(admiration->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], elicitor));
 				usedEmotions.insert(admiration);
 				history->removeEmotionByElicitor(histLiking, elicitor);
 			}
 		}
 		// Current emotions elicited at the same time
-		if (liking != nullptr && admiration != nullptr && liking->getElicitor() != nullptr
-			&& liking->getElicitor()->operator==(admiration->getElicitor())) {
+		if (liking != nullptr && admiration != nullptr && liking->getElicitor() != ElicitorRegistry::sNONE
+			&& liking->getElicitor() == admiration->getElicitor()) {
 			EmotionType type = EmotionType::Love;
-			std::shared_ptr<Emotion::Elicit> elicitor = admiration->getElicitor();
+			std::uint32_t elicitor = admiration->getElicitor();
 			double intensity = max(liking->getIntensity(), admiration->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
 
@@ -759,8 +778,8 @@
 			eav.setPraiseworthy(admiration->getAppraisalVariables().praiseworthy);
 			eav.setAgency(false);
 
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], elicitor));
 			usedEmotions.insert(liking);
 			usedEmotions.insert(admiration);
 		}
@@ -769,13 +788,13 @@
 		// If so, use this emotion!
 		// Compount Emotion Hate
 		histDisliking = ((disliking == nullptr) && (reproach != nullptr))
-			? history->getEmotionByElicitor(EmotionType::Disliking, reproach->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Disliking, reproach->getElicitor()) : nullptr;
 		histReproach = ((disliking != nullptr) && (reproach == nullptr))
-			? history->getEmotionByElicitor(EmotionType::Reproach, disliking->getElicitor()->Emo) : nullptr;
+			? history->getEmotionByElicitor(EmotionType::Reproach, disliking->getElicitor()) : nullptr;
 		if ((histDisliking != nullptr) || (histReproach != nullptr)) {
 			EmotionType type = EmotionType::Hate;
 			if (disliking != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = disliking->getElicitor();
+				std::uint32_t elicitor = disliking->getElicitor();
 				double intensity = max(disliking->getIntensity(), histReproach->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -786,13 +805,13 @@
 				eav.setPraiseworthy(histReproach->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(disliking);
 				history->removeEmotionByElicitor(histReproach, elicitor);
 			}
 			if (reproach != nullptr) {
-				std::shared_ptr<Emotion::Elicit> elicitor = reproach->getElicitor();
+				std::uint32_t elicitor = reproach->getElicitor();
 				double intensity = max(reproach->getIntensity(), histDisliking->getIntensity());
 				intensity = adjustIntensity(intensity, type, mood);
 
@@ -803,17 +822,17 @@
 				eav.setPraiseworthy(reproach->getAppraisalVariables().praiseworthy);
 				eav.setAgency(false);
 
-				tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-					fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+				tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+					fBaseline[type], eav, elicitor));
 				usedEmotions.insert(reproach);
 				history->removeEmotionByElicitor(histDisliking, elicitor);
 			}
 		}
 		// Current emotions elicited at the same time
-		if (disliking != nullptr && reproach != nullptr && disliking->getElicitor() != nullptr
-			&& disliking->getElicitor()->operator==(reproach->getElicitor())) {
+		if (disliking != nullptr && reproach != nullptr && disliking->getElicitor() != ElicitorRegistry::sNONE
+			&& disliking->getElicitor() == reproach->getElicitor()) {
 			EmotionType type = EmotionType::Hate;
-			std::shared_ptr<Emotion::Elicit> elicitor = reproach->getElicitor();
+			std::uint32_t elicitor = reproach->getElicitor();
 			double intensity = max(disliking->getIntensity(), reproach->getIntensity());
 			intensity = adjustIntensity(intensity, type, mood);
 
@@ -825,8 +844,8 @@
 			eav.setAgency(false);
 
 
-			tempEmotions.push_back(std::make_shared<Emotion>(type, intensity,
-				fPerEmoRel->getEmotionBaseline(fPersonality, type), eav, elicitor));
+			tempEmotions.push_back(AffectArena::makeShared<Emotion>(fArena, type, intensity,
+				fBaseline[type], eav, elicitor));
 			usedEmotions.insert(disliking);
 			usedEmotions.insert(reproach);
 		}
@@ -855,3 +874,83 @@
 		}
 		return emotions;
 	}
+
+	void EmotionEngine::inferEmotions(const EECValues* eecs, size_t count, double pleasure, double arousal, double dominance,
+		EmotionSlots& out, std::uint32_t types) {
+		std::unique_lock<std::recursive_mutex> lock(_mutex);
+		out.mask = 0;
+		updateCoefficients(pleasure, arousal, dominance);
+
+		auto elicit = [&](EmotionType type, double intensity, std::uint32_t elicitor) {
+			out.set(type, adjustCached(intensity, type), fBaseline[type], elicitor);
+		};
+		// --------------------------------------------
+		// Resolve single emotions from groups of EECs.
+		// --------------------------------------------
+		for (size_t i = 0; i < count; i++) {
+			const EECValues& eec = eecs[i];
+			// Well-being and Prospect-based Group:
+			if (eec.has(EECValues::HasDesirabilityForSelf)) {
+				bool desirable = eec.desirabilityForSelf >= 0.0;
+				if (!eec.has(EECValues::HasLikelihood))
+					elicit(desirable ? EmotionType::Joy : EmotionType::Distress, std::fabs(eec.desirabilityForSelf), eec.elicitor);
+				else
+					elicit(desirable ? EmotionType::Hope : EmotionType::Fear,
+						max(std::fabs(eec.desirabilityForSelf), std::fabs(eec.likelihood)), eec.elicitor);
+			}
+			// Fortunes-Of-Others Group:
+			if (eec.has(EECValues::HasDesirabilityForOther) && eec.has(EECValues::HasLiking)) {
+				bool desirable = eec.desirabilityForOther >= 0.0;
+				EmotionType type = (eec.liking >= 0.0)
+					? (desirable ? EmotionType::HappyFor : EmotionType::Pity)
+					: (desirable ? EmotionType::Resentment : EmotionType::Gloating);
+				elicit(type, max(std::fabs(eec.desirabilityForOther), std::fabs(eec.liking)), eec.elicitor);
+			}
+			// Attribution Group:
+			if (eec.has(EECValues::HasPraiseworthiness)) {
+				EmotionType type = (eec.praiseworthiness >= 0.0)
+					? (eec.selfAgency ? EmotionType::Pride : EmotionType::Admiration)
+					: (eec.selfAgency ? EmotionType::Shame : EmotionType::Reproach);
+				elicit(type, std::fabs(eec.praiseworthiness), eec.elicitor);
+			}
+			// Attraction Group:
+			if (eec.has(EECValues::HasAppealingness)) {
+				elicit((eec.appealingness >= 0.0) ? EmotionType::Liking : EmotionType::Disliking,
+					std::fabs(eec.appealingness), eec.elicitor);
+			}
+		}
+		// ---------------------------------------------------
+		// Resolve compound emotions according to single ones.
+		// ---------------------------------------------------
+		static const EmotionType compounds[][3] = {
+			{ EmotionType::Gratification, EmotionType::Joy, EmotionType::Pride },
+			{ EmotionType::Gratitude, EmotionType::Joy, EmotionType::Admiration },
+			{ EmotionType::Remorse, EmotionType::Distress, EmotionType::Shame },
+			{ EmotionType::Anger, EmotionType::Distress, EmotionType::Reproach },
+			{ EmotionType::Love, EmotionType::Liking, EmotionType::Admiration },
+			{ EmotionType::Hate, EmotionType::Disliking, EmotionType::Reproach }
+		};
+		// single emotions the character does not use cannot complete a compound
+		out.mask &= types;
+		std::uint32_t singles = out.mask;
+		std::uint32_t used = 0;
+		for (const auto& compound : compounds) {
+			EmotionType first = compound[1];
+			EmotionType second = compound[2];
+			std::uint32_t pair = (1u << first) | (1u << second);
+			if (((singles & pair) != pair) || (out.elicitor[first] == 0) || (out.elicitor[first] != out.elicitor[second]))
+				continue;
+			elicit(compound[0], max(out.intensity[first], out.intensity[second]), out.elicitor[first]);
+			used |= pair;
+		}
+		out.mask &= ~used & types;
+	}
+
+	void EmotionEngine::inferEmotions(const InferenceJob* jobs, size_t count, EmotionSlots* results) {
+		for (size_t i = 0; i < count; i++) {
+			const InferenceJob& job = jobs[i];
+			if (job.engine == nullptr)
+				throw std::invalid_argument("Emotion engine not specified.");
+			job.engine->inferEmotions(job.eecs, job.count, job.pleasure, job.arousal, job.dominance, results[i], job.types);
+		}
+	}
@@ -2,9 +2,11 @@
 //#include"Emotions/EmotionAppraisalVars.h"
 #include"../Emotions/EmotionAppraisalVars.h"
 #include"../Apprasial/EEC.h"
+#include"../Apprasial/EECValues.h"
 #include"../Emotions/Emotion.h"
 #include"../Emotions/Emotionhistory.h"
 #include"../Emotions/EmotionType.h"
+#include"../Emotions/EmotionSet.h"
 #include"../Emotions/EmotionVector.h"
 #include"../Apprasial/eec/Agency.h"
 //#include"AffectManager.h"
@@ -13,8 +15,57 @@
 #include"../Personality/PersonalityEmotionsRelations.h"
 #include"../Personality/PersonalityMoodRelations.h"
 #include<list>
+#include<vector>
 #include"../compute/DecayFunction.h"
+#include"../Data/AffectArena.h"
 #include<set>
+#include<cstdint>
+#include<cmath>
+
+/**
+* The <code>EmotionSlots</code> struct receives the emotions of a batched
+* inference. It has one fixed slot for each emotion type, indexed by the
+* <code>EmotionType</code>; the bit <code>1 << type</code> of the mask marks the
+* inferred ones.
+*/
+struct EmotionSlots {
+	static const size_t sSLOTS = EmotionType::Physical + 1;
+	/** every emotion type of the build except Undefined */
+	static const std::uint32_t sALLTYPES = ((1u << sSLOTS) - 2) & EnabledEmotions::sMASK;
+
+	std::uint32_t mask = 0;
+	double intensity[sSLOTS];
+	double baseline[sSLOTS];
+	std::uint32_t elicitor[sSLOTS];
+
+	bool has(EmotionType type) const {
+		return (mask & (1u << type)) != 0;
+	}
+
+	void set(EmotionType type, double Intensity, double Baseline, std::uint32_t Elicitor) {
+		intensity[type] = Intensity;
+		baseline[type] = Baseline;
+		elicitor[type] = Elicitor;
+		mask |= 1u << type;
+	}
+};
+
+class EmotionEngine;
+
+/**
+* One character's share of a batched inference.
+*/
+struct InferenceJob {
+	EmotionEngine* engine = nullptr;
+	const EECValues* eecs = nullptr;
+	size_t count = 0;
+	/** the character's current mood */
+	double pleasure = 0.0;
+	double arousal = 0.0;
+	double dominance = 0.0;
+	/** the emotion types the character uses, one bit per type */
+	std::uint32_t types = EmotionSlots::sALLTYPES;
+};
 
 /**
 * The
@@ -32,7 +83,7 @@ class EmotionEngine {
 	*/
 private:
 	std::recursive_mutex _mutex;
-	std::list<EEC*> listOfEEC;
+	std::vector<EEC> listOfEEC;
 	/**
 	* the character's personality
 	*/
@@ -43,12 +94,48 @@ private:
 	* the emotion engine's decay function
 	*/
 	DecayFunction* fDecayFunction = nullptr;
+	/*
+	* the character's arena new emotions are allocated from
+	*/
+	std::shared_ptr<AffectArena> fArena = nullptr;
 	/**
-	* the current emotion eliciting conditions
+	* flags for the current emotion eliciting conditions
 	*/
-	EEC* eventEEC = nullptr;
-	EEC* actionEEC = nullptr;
-	EEC* ElicitEEC = nullptr;
+	bool eventEEC = false;
+	bool actionEEC = false;
+	bool ElicitEEC = false;
+	/**
+	* the coefficients of <code>adjustIntensity</code> for each emotion type:
+	* the personality part is recomputed when the personality relations
+	* change, the mood part when the mood changes
+	*/
+	double fGain[EmotionSlots::sSLOTS];
+	double fBaseline[EmotionSlots::sSLOTS];
+	double fMoodInfluence[EmotionSlots::sSLOTS];
+	double fFloor[EmotionSlots::sSLOTS];
+	bool fPersonalityCached = false;
+	bool fMoodCached = false;
+	unsigned fPerEmoRelVersion = 0;
+	unsigned fPerMoodRelVersion = 0;
+	double fCachedPleasure = 0.0;
+	double fCachedArousal = 0.0;
+	double fCachedDominance = 0.0;
+
+	/**
+	* Brings the coefficient tables up to date for the specified mood.
+	*/
+	void updateCoefficients(double pleasure, double arousal, double dominance);
+
+	/**
+	* Returns the adjusted emotion intensity from the coefficient tables,
+	* which must be up to date.
+	*/
+	double adjustCached(double intensity, EmotionType type) const {
+		double result = intensity * fGain[type] + fMoodInfluence[type];
+		result = (result > 1.0) ? 1.0 : result;
+		result = (result < fFloor[type]) ? fFloor[type] : result;
+		return result;
+	}
 
 
 	/**
@@ -69,11 +156,13 @@ private:
 	*
 	* @param personality the agent's personality
 	* @param decayFunction the engine's emotion decay function
+	* @param arena the arena inferred emotions are allocated from, nullptr
+	* allocates them on the heap
 	* @throws nullptrPointerException if the personality or the decay function is
 	* not specified.
 	*/
 public:
-	EmotionEngine(Personality personality, DecayFunction* decayFunction);
+	EmotionEngine(Personality personality, DecayFunction* decayFunction, std::shared_ptr<AffectArena> arena = nullptr);
 	double adjustIntensity(double intensity, EmotionType type, Mood mood);
 	/**
 	* Adds a new element to the list of Emotion Eliciting Conditions. This method
@@ -86,15 +175,12 @@ public:
 	*
 	* @param eec the std::make_shared<Emotion> Eliciting Condition.
 	*
-	* @throws nullptrPointerException if the Emotion Eliciting Condition is not
-	* specified.
-	*
 	* @throws IllegalStateException if an EEC for event-based emotions,
 	* action-based emotions, or Emotion::Elicit-based emotions already exists.
 	*
 	* @see EmotionVector
 	*/
-	void addEEC(EEC* eec);
+	void addEEC(const EEC& eec);
 
 	/**
 	* Removes all elements from the list of Emotion Eliciting Conditions.
@@ -112,6 +198,7 @@ public:
 	*
 	* @param history the emotion history
 	* @param emotions the collection used to store the emotional state
+	* @param steps the number of decay steps, integrated in a single step
 	* @return the std::make_shared<Emotion>al state.
 	* @throws nullptrPointerException if no history is specified.
 	* @see EmotionVector getEmotionalState(EmotionVector emotions)
@@ -119,7 +206,7 @@ public:
 	// synchronized
 	std::shared_ptr<EmotionVector> decay(EmotionHistory* history,
 		std::shared_ptr<EmotionVector> emotions,
-		std::shared_ptr<EmotionVector> defaultEmotions);
+		std::shared_ptr<EmotionVector> defaultEmotions, int steps = 1);
 
 	/**
 	* Simulates the future decay of a specific emotion using the engine's decay
@@ -149,4 +236,36 @@ public:
 	*/
 	//synchronized 
 	std::shared_ptr<EmotionVector> inferEmotions(std::shared_ptr<EmotionVector> emotions, EmotionHistory* history, Mood mood);
+
+	/**
+	* Infers the emotions of a list of value Emotion Eliciting Conditions into
+	* fixed slots, without allocating. The single emotions follow the same
+	* rules as <code>inferEmotions</code>; compound emotions are built from
+	* single emotions of the same elicitor inferred in this call, and the
+	* single emotions they consume are removed from the result. Single
+	* emotions of types the character does not use are dropped before the
+	* compound emotions are built. The
+	* confirmation group and compound emotions completed from earlier emotions
+	* need the emotion history and are left to <code>inferEmotions</code>.
+	*
+	* @param eecs the Emotion Eliciting Conditions
+	* @param count the number of Emotion Eliciting Conditions
+	* @param pleasure the pleasure of the character's mood
+	* @param arousal the arousal of the character's mood
+	* @param dominance the dominance of the character's mood
+	* @param out the slots receiving the inferred emotions
+	* @param types the emotion types the character uses, one bit per type
+	*/
+	void inferEmotions(const EECValues* eecs, size_t count, double pleasure, double arousal, double dominance,
+		EmotionSlots& out, std::uint32_t types = EmotionSlots::sALLTYPES);
+
+	/**
+	* Infers the emotions of many characters in one pass.
+	*
+	* @param jobs the characters and their Emotion Eliciting Conditions
+	* @param count the number of jobs
+	* @param results receives the emotions of job <code>i</code> in
+	*        <code>results[i]</code>
+	*/
+	static void inferEmotions(const InferenceJob* jobs, size_t count, EmotionSlots* results);
 };
\ No newline at end of file
@@ -1,6 +1,67 @@
 #pragma once
+#include<algorithm>
+#include<cstdint>
+#include<vector>
 #include"../Emotions/Emotion.h"
 
+/**
+* A decay curve sampled once when its decay function is initialized. The
+* curve maps the fraction of its steps an emotion has decayed to the fraction
+* of its intensity range that remains, so a single table serves emotions of
+* every range: a decay step looks up one sample instead of evaluating the
+* curve.
+* <br>
+* The table has <code>max(decaySteps, sMINSAMPLES) + 1</code> samples. A
+* looked up sample is within a thousandth of the range of the curve it was
+* sampled from (about 7e-4 for the exponential and 3e-4 for the tangens
+* hyperbolicus curve); how far that curve is from a former per-step formula
+* is up to the decay function.
+*
+* @version 1.0
+*/
+class DecayCurve {
+	std::vector<float> fSamples;
+	/** the samples per step of a decay that ends at step <code>i</code> */
+	std::vector<float> fStride;
+	float fResolution = 0.0f;
+
+public:
+	static constexpr int sMINSAMPLES = 4096;
+
+	/**
+	* Samples a curve.
+	*
+	* @param decaySteps the number of steps of an emotion with range 1
+	* @param curve the remaining fraction of the range at a decayed fraction
+	* in <code>[0,1]</code>
+	*/
+	template<class F>
+	void init(int decaySteps, F curve) {
+		// compared by value, std::max would bind the constant by reference
+		int resolution = (decaySteps > sMINSAMPLES) ? decaySteps : sMINSAMPLES;
+		fResolution = static_cast<float>(resolution);
+		fSamples.resize(resolution + 1);
+		for (int i = 0; i <= resolution; i++)
+			fSamples[i] = static_cast<float>(curve(static_cast<double>(i) / resolution));
+		fStride.resize(decaySteps + 1);
+		fStride[0] = 0.0f;
+		for (int end = 1; end <= decaySteps; end++)
+			fStride[end] = fResolution / end;
+	}
+
+	/**
+	* Returns the remaining fraction of the range at a step of a decay.
+	*
+	* @param step the step, at most <code>end</code>
+	* @param end the step the decay ends at
+	*/
+	float at(std::uint32_t step, std::uint32_t end) const {
+		float stride = (end < fStride.size()) ? fStride[end] : fResolution / end;
+		size_t index = static_cast<size_t>(step * stride + 0.5f);
+		return fSamples[std::min(index, fSamples.size() - 1)];
+	}
+};
+
 /**
 * Interface for emotion decay functions
 *
@@ -8,6 +69,18 @@
 * @version 1.0
 */
 class DecayFunction {
+public:
+	/** Position of an emotion on its decay curve. Fields a function does not
+	* use are 0.
+	*/
+	struct DecayProgress {
+		int xValue = 0;
+		int xEndValue = 0;
+		double startValue = 0.0;
+		double operatingRange = 0.0;
+	};
+
+
 	/** Initializes the decay function. The decay function computes for each
 	* emotion in the emotion vector a decay factor based on the number of
 	* steps required to decay to the emotion baseline.
@@ -29,6 +102,16 @@ public:
 	*/
 		virtual std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion) = 0;
 
+	/** Decays an emotion by several steps at once and returns the result. The
+	* result equals <code>steps</code> calls of <code>decay(emotion)</code>
+	* but is computed in a single step.
+	*
+	* @param emotion the emotion to decay
+	* @param steps the number of steps, at least 1
+	* @return the decayed emotion
+	*/
+		virtual std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion, int steps) = 0;
+
 	/** Access the amount of decay steps.
 	*
 	* @return the number of steps to decay.
@@ -50,4 +133,59 @@ public:
 	/** Sets the additional configuration parameter
 	*/
 		virtual void setConfigParameter(double param) = 0;
+
+	/** Returns the decay progress of an emotion that is currently decaying.
+	* Used to checkpoint a character, see <code>setProgress</code>. The
+	* progress is kept in the emotion itself.
+	*
+	* @param emotion the decaying emotion
+	* @param progress receives the progress
+	* @return true if the emotion is decaying, false otherwise
+	*/
+		virtual bool getProgress(const std::shared_ptr<Emotion>& emotion, DecayProgress& progress) {
+			if (!emotion->isDecaying())
+				return false;
+			progress = DecayProgress();
+			progress.xValue = static_cast<int>(emotion->mDecayStep);
+			progress.xEndValue = static_cast<int>(emotion->mDecayEnd);
+			progress.operatingRange = emotion->mDecayRange;
+			return true;
+		}
+
+	/** Continues the decay of an emotion from a progress returned by
+	* <code>getProgress</code>, e.g. for a restored copy of the emotion.
+	*
+	* @param emotion the emotion
+	* @param progress the decay progress
+	*/
+		virtual void setProgress(const std::shared_ptr<Emotion>& emotion, const DecayProgress& progress) {
+			emotion->mDecayStep = static_cast<std::uint32_t>(std::max(progress.xValue, 0));
+			emotion->mDecayEnd = static_cast<std::uint32_t>(std::max(progress.xEndValue, 0));
+			emotion->mDecayRange = static_cast<float>(progress.operatingRange);
+		}
+
+protected:
+	/** Starts the decay of an emotion above its baseline, unless it is
+	* decaying already.
+	*
+	* @param emotion the emotion
+	* @param decaySteps the number of steps of an emotion with range 1
+	*/
+	static void startDecay(Emotion& emotion, int decaySteps) {
+		if (emotion.isDecaying())
+			return;
+		double operatingRange = emotion.getIntensity() - emotion.getBaseline();
+		emotion.mDecayRange = static_cast<float>(operatingRange);
+		emotion.mDecayStep = 0;
+		emotion.mDecayEnd = static_cast<std::uint32_t>(decaySteps * operatingRange); // maximum x
+	}
+
+	/** Ends the decay of an emotion at its baseline.
+	*/
+	static void endDecay(Emotion& emotion) {
+		emotion.intensity = emotion.baseline;
+		emotion.mDecayStep = 0;
+		emotion.mDecayEnd = 0;
+		emotion.mDecayRange = 0.0f;
+	}
 };
\ No newline at end of file
@@ -12,28 +12,15 @@
 class ExponentialDecayFunction : public DecayFunction {
 
 private:
-	class Values {
-	public:
-		int xValue;
-		int xEndValue;
-		double operatingRange;
-
-		Values(int XValue, int XEndValue, double OperatingRange) {
-			xValue = XValue;
-			xEndValue = XEndValue;
-			operatingRange = OperatingRange;
-			
-		}
-
-	};
-	  static double ZEROCONST ;
-	 std::unordered_map<std::shared_ptr<Emotion>, Values*> fDecayingEmotions;
+	/** the curve falls to this fraction of the range at the last step */
+	static constexpr double sZERO = 0.004;
+	 DecayCurve fCurve;
 	 int DecaySteps;
 	 bool isInitialised = false;
 
 	 
 public:
-		ExponentialDecayFunction() { ZEROCONST = log(0.004); }
+		ExponentialDecayFunction() {}
 
 	 ExponentialDecayFunction(int decaySteps) {
 		init(decaySteps);
@@ -41,48 +28,33 @@ public:
 
 
 
-	 void init(int DecaySteps) {
-		if (DecaySteps <= 0)
+	 void init(int decaySteps) {
+		if (decaySteps <= 0)
 			throw std::invalid_argument("Number of decay steps not positive.");
-		DecaySteps = DecaySteps;
+		if (isInitialised && (decaySteps == DecaySteps))
+			return;
+		DecaySteps = decaySteps;
+		const double zeroConst = log(sZERO);
+		fCurve.init(decaySteps, [zeroConst](double x) { return exp(x * zeroConst); });
 		isInitialised = true;
 	}
 
 	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion) {
+		return decay(emotion, 1);
+	}
+
+	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion, int steps) {
 		if (!isInitialised)
 			throw std::invalid_argument("Decay function not initialized!");
-		Values* values = nullptr;
-		double intensity = emotion->getIntensity();
-		double baseline = emotion->getBaseline();
-		double newIntensity = intensity;
-		int xValue;
-		int xEndValue;
-		double startValue;
-		double operatingRange;
-		if (intensity  > baseline) {
-			if (fDecayingEmotions.at(emotion)) {
-				values = fDecayingEmotions.at(emotion);
-				xValue = values->xValue;
-				xEndValue = values->xEndValue;
-				operatingRange = values->operatingRange;
-			}
-			else { // first time setup of variables
-				operatingRange = (intensity - baseline);
-				xValue = 0;
-				xEndValue = (int)(DecaySteps * operatingRange); // maximum x
-				values = new Values(xValue, xEndValue, operatingRange);
-				fDecayingEmotions.emplace(emotion, values);
-			}
-			xValue++;
-			newIntensity = exp(xValue * ZEROCONST / xEndValue) * (operatingRange)+baseline;
-			values->xValue = xValue;
-			fDecayingEmotions.emplace(emotion, values);
-			if ((xValue > xEndValue) || (newIntensity < baseline)) {
-				newIntensity = baseline;
-				fDecayingEmotions.erase(emotion);
-			}
+		Emotion& e = *emotion;
+		if (e.intensity > e.baseline) {
+			startDecay(e, DecaySteps);
+			e.mDecayStep += static_cast<std::uint32_t>(steps);
+			if (e.mDecayStep > e.mDecayEnd)
+				endDecay(e);
+			else
+				e.intensity = e.mDecayRange * fCurve.at(e.mDecayStep, e.mDecayEnd) + e.baseline;
 		}
-		emotion->setIntensity(newIntensity);
 		return emotion;
 	}
 
@@ -98,6 +70,7 @@ public:
 		return -1.0;
 	}
 
-	
+	 void setConfigParameter(double param) {
+	}
 
 };
\ No newline at end of file
@@ -12,20 +12,6 @@
  class LinearDecayFunction : public DecayFunction {
 
 private:
-	class Values {
-	public:
-		int xValue;
-		int xEndValue;
-		double operatingRange;
-
-		Values(int XValue, int XEndValue, double OperatingRange) {
-			xValue = XValue;
-			xEndValue = XEndValue;
-			operatingRange = OperatingRange;
-		}
-
-	};
-	std::unordered_map<std::shared_ptr<Emotion>, Values*> fDecayingEmotions;
 	 int DecaySteps;
 	 bool isInitialised = false;
 
@@ -48,40 +34,23 @@ public:
 	}
 
 	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion) {
+		return decay(emotion, 1);
+	}
+
+	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion, int steps) {
 		if (!isInitialised) {
 			throw std::invalid_argument("Decay function not initialized!");
 		}
-		Values* values = nullptr;
-		double intensity = emotion->getIntensity();
-		double baseline = emotion->getBaseline();
-		double newIntensity = intensity;
-		int xValue;
-		int xEndValue;
-		double operatingRange;
-		if (intensity > baseline) {
-			if (fDecayingEmotions.at(emotion)) {
-				values = fDecayingEmotions.at(emotion);
-				xValue = values->xValue;
-				xEndValue = values->xEndValue;
-				operatingRange = values->operatingRange;
-			}
-			else {
-				operatingRange = (intensity - baseline);
-				xValue = 0;
-				xEndValue = (int)(DecaySteps * operatingRange);
-				values = new Values(xValue, xEndValue, operatingRange);
-				fDecayingEmotions.emplace(emotion, values);
-			}
-			newIntensity = intensity - (1.0 / DecaySteps);
-			xValue++;
-			values->xValue = xValue;
-			fDecayingEmotions.emplace(emotion, values);
-			if ((xValue > xEndValue) || (newIntensity < baseline)) {
-				newIntensity = baseline;
-				fDecayingEmotions.erase(emotion);
-			}
+		Emotion& e = *emotion;
+		if (e.intensity > e.baseline) {
+			startDecay(e, DecaySteps);
+			double newIntensity = e.getIntensity() - (static_cast<double>(steps) / DecaySteps);
+			e.mDecayStep += static_cast<std::uint32_t>(steps);
+			if ((e.mDecayStep > e.mDecayEnd) || (newIntensity < e.baseline))
+				endDecay(e);
+			else
+				e.setIntensity(newIntensity);
 		}
-		emotion->setIntensity(newIntensity);
 		return emotion;
 	}
 
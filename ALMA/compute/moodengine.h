@@ -11,6 +11,7 @@
 #include"Matrix.h"
 #include"glm/glm.hpp"
 #include <random>
+#include"Data/BinaryStream.h"
 
 //import de.affect.manage.AffectManager;
 
@@ -30,7 +31,7 @@
 	 Personality fPersonality;
 	  Mood fDefaultMood ;
 	  Mood fCurrentMoodTendency ;
-	 EmotionPADCentroid* fEmotionsCenter = nullptr;
+	 EmotionPADCentroid fEmotionsCenter;
 	 bool fNeurotismMoodChanges = false;
 	 int fNeurotismMoodChangeTime = 1;
 	 int fRelativeMoodOctant = 0;
@@ -185,24 +186,24 @@
 		   double arousalEnd = signum(currentMood.getArousal());
 		   double dominanceEnd = signum(currentMood.getDominance());
 		   bool isInPleasurePart = false;
-		   if ((pleasureEnd > 0.0) && (fEmotionsCenter->getPValue() > 0.0)) {
+		   if ((pleasureEnd > 0.0) && (fEmotionsCenter.getPValue() > 0.0)) {
 			   isInPleasurePart = true;
 		   }
-		   if ((pleasureEnd < 0.0) && (fEmotionsCenter->getPValue() < 0.0)) {
+		   if ((pleasureEnd < 0.0) && (fEmotionsCenter.getPValue() < 0.0)) {
 			   isInPleasurePart = true;
 		   }
 		   bool isInArousalPart = false;
-		   if ((arousalEnd > 0.0) && (fEmotionsCenter->getAValue() > 0.0)) {
+		   if ((arousalEnd > 0.0) && (fEmotionsCenter.getAValue() > 0.0)) {
 			   isInArousalPart = true;
 		   }
-		   if ((arousalEnd < 0.0) && (fEmotionsCenter->getAValue() < 0.0)) {
+		   if ((arousalEnd < 0.0) && (fEmotionsCenter.getAValue() < 0.0)) {
 			   isInArousalPart = true;
 		   }
 		   bool isInDominancePart = false;
-		   if ((dominanceEnd > 0.0) && (fEmotionsCenter->getDValue() > 0.0)) {
+		   if ((dominanceEnd > 0.0) && (fEmotionsCenter.getDValue() > 0.0)) {
 			   isInDominancePart = true;
 		   }
-		   if ((dominanceEnd < 0.0) && (fEmotionsCenter->getDValue() < 0.0)) {
+		   if ((dominanceEnd < 0.0) && (fEmotionsCenter.getDValue() < 0.0)) {
 			   isInDominancePart = true;
 		   }
 		   if (isInPleasurePart && isInArousalPart && isInDominancePart) {
@@ -213,9 +214,9 @@
 
 	   bool isMoodAtEmotionsCenter(Mood currentMood) {
 		   bool isAtEmotionCenter = false;
-		   double pRange = (fEmotionsCenter->getPValue() - currentMood.getPleasure());
-		   double aRange = (fEmotionsCenter->getAValue() - currentMood.getArousal());
-		   double dRange = (fEmotionsCenter->getDValue() - currentMood.getDominance());
+		   double pRange = (fEmotionsCenter.getPValue() - currentMood.getPleasure());
+		   double aRange = (fEmotionsCenter.getAValue() - currentMood.getArousal());
+		   double dRange = (fEmotionsCenter.getDValue() - currentMood.getDominance());
 		   if ((abs(pRange) < 0.001) && (abs(aRange) < 0.001) && (abs(dRange) < 0.001)) {
 			   isAtEmotionCenter = true;
 		   }
@@ -224,18 +225,18 @@
 
 	   bool isMoodInEmotionsCenterSubCube(Mood currentMood) {
 		   bool isInEmotionsCenterSubCube = false;
-		   if ((((fEmotionsCenter->getPValue() >= 0.0) &&
-			   (currentMood.getPleasure() >= fEmotionsCenter->getPValue())) ||
-			   ((fEmotionsCenter->getPValue() < 0.0) &&
-			   (currentMood.getPleasure() <= fEmotionsCenter->getPValue()))) &&
-				   (((fEmotionsCenter->getAValue() >= 0.0) &&
-			   (currentMood.getArousal() >= fEmotionsCenter->getAValue())) ||
-					   ((fEmotionsCenter->getAValue() < 0.0) &&
-					   (currentMood.getArousal() <= fEmotionsCenter->getAValue()))) &&
-						   (((fEmotionsCenter->getDValue() >= 0.0) &&
-			   (currentMood.getDominance() >= fEmotionsCenter->getDValue())) ||
-							   ((fEmotionsCenter->getDValue() < 0.0) &&
-							   (currentMood.getDominance() <= fEmotionsCenter->getDValue())))) {
+		   if ((((fEmotionsCenter.getPValue() >= 0.0) &&
+			   (currentMood.getPleasure() >= fEmotionsCenter.getPValue())) ||
+			   ((fEmotionsCenter.getPValue() < 0.0) &&
+			   (currentMood.getPleasure() <= fEmotionsCenter.getPValue()))) &&
+				   (((fEmotionsCenter.getAValue() >= 0.0) &&
+			   (currentMood.getArousal() >= fEmotionsCenter.getAValue())) ||
+					   ((fEmotionsCenter.getAValue() < 0.0) &&
+					   (currentMood.getArousal() <= fEmotionsCenter.getAValue()))) &&
+						   (((fEmotionsCenter.getDValue() >= 0.0) &&
+			   (currentMood.getDominance() >= fEmotionsCenter.getDValue())) ||
+							   ((fEmotionsCenter.getDValue() < 0.0) &&
+							   (currentMood.getDominance() <= fEmotionsCenter.getDValue())))) {
 			   isInEmotionsCenterSubCube = true;
 		   }
 		   return isInEmotionsCenterSubCube;
@@ -244,7 +245,6 @@
 	 MoodEngine(Personality personality, bool neuroticMoodChanges, Mood defaultMood, double compPeriod) {
 		fPersonality = personality;
 		fDefaultMood = defaultMood;
-		fEmotionsCenter =  new EmotionPADCentroid();
 		fNeurotismMoodChanges = neuroticMoodChanges;
 		// fNeurotismMoodChangeTime is reciproc to the neurotism value.
 		// The higher neurotsim is, the lower is fNeurotismMoodChangeTime.
@@ -256,7 +256,7 @@
 	// synchronized
 		 EmotionPADCentroid* getEmotionsCenter() {
 			 std::unique_lock<std::recursive_mutex> lock(_mutex);
-		return fEmotionsCenter;
+		return &fEmotionsCenter;
 	}
 
 	
@@ -280,6 +280,51 @@
 		return (fCurrentMoodTendency.getEmpty() == false) ? fCurrentMoodTendency : fDefaultMood;
 	}
 
+	/**
+	* Writes the state the engine accumulated since its construction (mood
+	* tendency, emotions center, octants and the mood return counter).
+	*
+	* @param out the checkpoint writer
+	*/
+	 void saveState(BinaryWriter& out) {
+		 std::unique_lock<std::recursive_mutex> lock(_mutex);
+		 out.write<bool>(fCurrentMoodTendency.getEmpty());
+		 out.write<double>(fCurrentMoodTendency.getPleasure());
+		 out.write<double>(fCurrentMoodTendency.getArousal());
+		 out.write<double>(fCurrentMoodTendency.getDominance());
+		 out.write<double>(fEmotionsCenter.getPValue());
+		 out.write<double>(fEmotionsCenter.getAValue());
+		 out.write<double>(fEmotionsCenter.getDValue());
+		 out.write<double>(fEmotionsCenter.getWeight());
+		 out.write<std::int32_t>(fEmotionsCenter.getEmotionCount());
+		 out.write<std::int32_t>(fRelativeMoodOctant);
+		 out.write<std::int32_t>(fLastRelativeMoodOctant);
+		 out.write<std::int64_t>(fOverallMoodReturnCnt);
+	 }
+
+	/**
+	* Restores the state written by <code>saveState</code>. The engine must
+	* have been constructed with the same arguments as the saved one.
+	*
+	* @param in the checkpoint reader
+	*/
+	 void loadState(BinaryReader& in) {
+		 std::unique_lock<std::recursive_mutex> lock(_mutex);
+		 bool emptyTendency = in.read<bool>();
+		 double p = in.read<double>();
+		 double a = in.read<double>();
+		 double d = in.read<double>();
+		 fCurrentMoodTendency = emptyTendency ? Mood() : Mood(p, a, d);
+		 p = in.read<double>();
+		 a = in.read<double>();
+		 d = in.read<double>();
+		 double weight = in.read<double>();
+		 fEmotionsCenter.restore(p, a, d, weight, in.read<std::int32_t>());
+		 fRelativeMoodOctant = in.read<std::int32_t>();
+		 fLastRelativeMoodOctant = in.read<std::int32_t>();
+		 fOverallMoodReturnCnt = static_cast<long>(in.read<std::int64_t>());
+	 }
+
 	/**
 	* <code>compute</code> computes the new current mood based on the actual
 	* current mood and the active emotion(s) of a character.
@@ -294,31 +339,31 @@
 		 std::unique_lock<std::recursive_mutex> lock(_mutex);
 		// increment mood return counter to 0
 		fOverallMoodReturnCnt++;
-		fEmotionsCenter->clear();		
-		for (auto& it : emotions->getEmotions()) {
+		fEmotionsCenter.clear();		
+		for (const auto& it : *emotions) {
 			EmotionType eType = it->getType();
 			double eIntensity = it->getIntensity();
 			if (eIntensity > it->getBaseline()) {
 				// log.info("Active emotion " + eType + " influences current mood");
 				Mood ePAD = (eType == (EmotionType::Physical)) ? it->getPADValues() :EmotionsPADRelation::getEmotionPADMapping(eType);
 				//log.info(eType + " PAD representation is (" + ePAD.getPleasure() + ", " +  ePAD.getArousal() + " , " + ePAD.getDominance() + ")");
-				fEmotionsCenter->add(ePAD.getPleasure(), ePAD.getArousal(), ePAD.getDominance(), eIntensity);
-				//log.info(fEmotionsCenter->toString());
+				fEmotionsCenter.add(ePAD.getPleasure(), ePAD.getArousal(), ePAD.getDominance(), eIntensity);
+				//log.info(fEmotionsCenter.toString());
 			}
 		}
-		if (fEmotionsCenter->isActive()) {
+		if (fEmotionsCenter.isActive()) {
 			// reset mood return counter to 0
 			fOverallMoodReturnCnt = 0;
-			double emotionImpact = fEmotionsCenter->getWeight();
+			double emotionImpact = fEmotionsCenter.getWeight();
 			//log.info(fPersonality + " Emotion(s) impact is " + prettyPrint(emotionImpact));
 			if (isMoodAtEmotionsCenter(currentMood)) {
 				//log.info(fPersonality + " Current mood " + currentMood + " is at emotion(s) center");
-				currentMood = Mood(fEmotionsCenter->getPValue(), fEmotionsCenter->getAValue(),
-					fEmotionsCenter->getDValue());
+				currentMood = Mood(fEmotionsCenter.getPValue(), fEmotionsCenter.getAValue(),
+					fEmotionsCenter.getDValue());
 			}
-			if ((isEmotionCenterInCurrentMoodOctantCube(currentMood)) && (fEmotionsCenter->getIntensity() <= currentMood.getIntensity())) {
+			if ((isEmotionCenterInCurrentMoodOctantCube(currentMood)) && (fEmotionsCenter.getIntensity() <= currentMood.getIntensity())) {
 				//log.info(fPersonality + " current emotion(s) pushing mood deeper in mood octant");
-				Mood planePoint = getPADPlanePoint(fEmotionsCenter,  Mood(0.0, 0.0, 0.0));
+				Mood planePoint = getPADPlanePoint(&fEmotionsCenter,  Mood(0.0, 0.0, 0.0));
 				currentMood = (planePoint) ? moveMoodLinear(currentMood, emotionImpact,
 					planePoint.getPleasure(),
 					planePoint.getArousal(),
@@ -327,14 +372,14 @@
 			}
 			else if (isMoodInEmotionsCenterSubCube(currentMood)) { // PG 11.3.11: this case is obsolete
 																   //log.info(fPersonality + " Moving mood deeper in emotion(s) center sub cube");
-				Mood planePoint = getPADPlanePoint(fEmotionsCenter,  Mood(0.0, 0.0, 0.0));
+				Mood planePoint = getPADPlanePoint(&fEmotionsCenter,  Mood(0.0, 0.0, 0.0));
 				currentMood = (planePoint) ? moveMoodLinear(currentMood, emotionImpact,
 					planePoint.getPleasure(),
 					planePoint.getArousal(),
 					planePoint.getDominance()) : currentMood;
 			}
 			else {
-				Mood planePoint = getPADPlanePoint(fEmotionsCenter, currentMood);
+				Mood planePoint = getPADPlanePoint(&fEmotionsCenter, currentMood);
 				//log.info(fPersonality + " Using intersection point (" + prettyPrint(planePoint.getPleasure()) + ", " +  prettyPrint(planePoint.getArousal()) + ", " +  prettyPrint(planePoint.getDominance()) + ")");
 				
 				currentMood = (planePoint) ? moveMoodLinear(currentMood, emotionImpact,
@@ -342,7 +387,7 @@
 					planePoint.getArousal(),
 					planePoint.getDominance()) : currentMood;
 			}
-			//Mood planePoint = getPADPlanePoint(fEmotionsCenter, currentMood);
+			//Mood planePoint = getPADPlanePoint(&fEmotionsCenter, currentMood);
 		}
 		else { // back to default mood
 			if (currentMood != fDefaultMood) {
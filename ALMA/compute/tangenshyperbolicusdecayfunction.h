@@ -4,6 +4,9 @@
 
 /**
 * This class realizes emotion decay using the tangens hyperbolicus function.
+* The curve is normalized to the step a decay ends at instead of the
+* unrounded number of steps, so intensities differ from the former per-step
+* formula by up to 5e-3 at 47 decay steps.
 *
 * @author Patrick Gebhard
 *
@@ -12,29 +15,19 @@
  class TangensHyperbolicusDecayFunction : public DecayFunction {
 
  private:
-	 class Values {
-	 public:
-		 int xValue;
-		 int xEndValue;
-		 double startValue;
-		 double operatingRange;
-
-		 Values(int xValue, int xEndValue, double startValue, double operatingRange) {
-			 xValue = xValue;
-			 xEndValue = xEndValue;
-			 startValue = startValue;
-			 operatingRange = operatingRange;
-		 }
-
-	 };
 	 double TANH_CHARACTER = 0.2;
-	 //std::unordered_map<Emotion::Type, std::shared_ptr<Emotion>> emotions;
-	 std::unordered_map<std::shared_ptr<Emotion>, Values*> fDecayingEmotions;
-	// Hashtable<Emotion, Values> fDecayingEmotions = new Hashtable<Emotion, Values>();
-	 double scalingFactor = 0.0;
+	 DecayCurve fCurve;
 	 int DecaySteps;
 	 bool isInitialised = false;
 
+	 /** Samples the curve for the current decay steps and tanh character. The
+	 * curve is centered on the middle step of a decay and its slope is
+	 * normalized to the step the decay ends at. */
+	 void sampleCurve() {
+		 const double character = TANH_CHARACTER;
+		 fCurve.init(DecaySteps, [character](double x) { return 0.5 - tanh((x - 0.5) / character) * 0.5; });
+	 }
+
 public:
 		TangensHyperbolicusDecayFunction() {}
 
@@ -47,51 +40,30 @@ public:
 	 void init(int decaySteps) {
 		if (decaySteps <= 0)
 			throw std::invalid_argument("Number of decay steps not positive.");
+		if (isInitialised && (decaySteps == DecaySteps))
+			return;
 		DecaySteps = decaySteps;
-		scalingFactor = 1 / (TANH_CHARACTER * decaySteps);
+		sampleCurve();
 		isInitialised = true;
 	}
 
 	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion) {
+		return decay(emotion, 1);
+	}
+
+	 std::shared_ptr<Emotion> decay(std::shared_ptr<Emotion> emotion, int steps) {
 		if (!isInitialised)
 			throw std::invalid_argument("Decay function not initialized!");
-		Values* values = nullptr;
-		double intensity = emotion->getIntensity();
-		double baseline = emotion->getBaseline();
-		double newIntensity = intensity;
-		int xValue;
-		int xEndValue;
-		double startValue;
-		double operatingRange;
-		if (intensity > baseline) {
-			if (fDecayingEmotions.at(emotion)!=nullptr) {
-				values = fDecayingEmotions.at(emotion);
-				xValue = values->xValue;
-				xEndValue = values->xEndValue;
-				startValue = values->startValue;
-				operatingRange = values->operatingRange;
-			}
-			else { // first time setup of variables
-				operatingRange = (intensity - baseline);
-				xValue = 0;
-				xEndValue = (int)(DecaySteps * operatingRange); //maximum x
-				startValue = xEndValue * 0.5 / (operatingRange)* scalingFactor;
-				values = new Values(xValue, xEndValue, startValue, operatingRange);
-				fDecayingEmotions.emplace(emotion, values);
-			}
-			// debug log.info("Step " + xValue + "/" + xEndValue);
-			double input = -startValue + (xValue / operatingRange * scalingFactor);
-			newIntensity = operatingRange + baseline - ((tanh(input) * 0.5 + 0.5)) * operatingRange;
-			// debug log.info("Input=" + prettyPrint(input) + " new intensity=" + prettyPrint(newIntensity));
-			xValue++;
-			values->xValue = xValue;
-			fDecayingEmotions.emplace(emotion, values);
-			if (xValue > xEndValue) {
-				newIntensity = baseline;
-				fDecayingEmotions.erase(emotion);
-			}
+		Emotion& e = *emotion;
+		if (e.intensity > e.baseline) {
+			startDecay(e, DecaySteps);
+			// the curve is read before the step counter moves
+			e.mDecayStep += static_cast<std::uint32_t>(steps);
+			if (e.mDecayStep > e.mDecayEnd)
+				endDecay(e);
+			else
+				e.intensity = e.mDecayRange * fCurve.at(e.mDecayStep - 1, e.mDecayEnd) + e.baseline;
 		}
-		emotion->setIntensity(newIntensity);
 		return emotion;
 	}
 
@@ -108,7 +80,18 @@ public:
 	}
 
 	 void setConfigParameter(double param) {
+		if (param <= 0.0)
+			throw std::invalid_argument("Tanh character not positive.");
 		TANH_CHARACTER = param;
+		if (isInitialised)
+			sampleCurve();
+	}
+
+	 bool getProgress(const std::shared_ptr<Emotion>& emotion, DecayProgress& progress) {
+		if (!DecayFunction::getProgress(emotion, progress))
+			return false;
+		progress.startValue = progress.xEndValue * 0.5 / progress.operatingRange / (TANH_CHARACTER * DecaySteps);
+		return true;
 	}
 
 }
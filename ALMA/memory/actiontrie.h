@@ -0,0 +1,283 @@
+#pragma once
+#include<cstdint>
+#include<list>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+/**
+* Procedural memory as a prefix trie. Every procedure is a sequence of actions;
+* procedures starting with the same actions share the nodes of that prefix.
+* Actions are interned to small ids once, so matching compares integers
+* instead of strings.
+* <br>
+* A <code>Cursor</code> follows a sequence while it is executed: every step
+* moves it one node down, so checking a partially executed sequence costs one
+* lookup per step and no copies. A cursor started for a procedure keeps the
+* path of that procedure, so checking it against the procedure compares one
+* node per step instead of walking up the trie.
+*/
+class actiontrie
+{
+public:
+	typedef std::uint32_t ActionId;
+	static const std::uint32_t sNONE = 0xFFFFFFFF;
+
+	/**
+	* Position of a partially executed sequence in the trie.
+	*/
+	struct Cursor
+	{
+		std::uint32_t node = 0;
+		/** number of actions matched so far */
+		std::uint32_t depth = 0;
+		/** false once the sequence left the trie */
+		bool valid = true;
+		/** the nodes of the target procedure by depth, empty without a target */
+		std::vector<std::uint32_t> path;
+		/** the version of the trie the path was taken from */
+		std::uint32_t version = 0;
+	};
+
+private:
+	struct Node
+	{
+		std::uint32_t parent = sNONE;
+		ActionId action = sNONE;
+		std::uint32_t depth = 0;
+		/** number of procedures passing through this node */
+		std::uint32_t refs = 0;
+		/** (action, node) pairs, the fan-out of a procedure step is small */
+		std::vector<std::pair<ActionId, std::uint32_t>> children;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<std::uint32_t> freeNodes;
+	std::unordered_map<std::string, ActionId> actionIds;
+	std::vector<std::string> actionNames;
+	/** the last node of every procedure */
+	std::unordered_map<std::string, std::uint32_t> procedures;
+	/** changes whenever procedures are added or removed, node ids may be reused then */
+	std::uint32_t version = 0;
+
+	std::uint32_t child(std::uint32_t node, ActionId action) const
+	{
+		for (const auto& entry : nodes[node].children)
+		{
+			if (entry.first == action)
+				return entry.second;
+		}
+		return sNONE;
+	}
+
+	std::uint32_t addChild(std::uint32_t node, ActionId action)
+	{
+		std::uint32_t index;
+		if (!freeNodes.empty())
+		{
+			index = freeNodes.back();
+			freeNodes.pop_back();
+			nodes[index] = Node();
+		}
+		else
+		{
+			index = static_cast<std::uint32_t>(nodes.size());
+			nodes.emplace_back();
+		}
+		nodes[index].parent = node;
+		nodes[index].action = action;
+		nodes[index].depth = nodes[node].depth + 1;
+		nodes[node].children.emplace_back(action, index);
+		return index;
+	}
+
+	/**
+	* Releases the path of a procedure, nodes no other procedure uses are
+	* unlinked and reused later.
+	*/
+	void release(std::uint32_t node)
+	{
+		while (node != 0)
+		{
+			std::uint32_t parent = nodes[node].parent;
+			if (--nodes[node].refs == 0)
+			{
+				auto& siblings = nodes[parent].children;
+				for (size_t i = 0; i < siblings.size(); i++)
+				{
+					if (siblings[i].second == node)
+					{
+						siblings[i] = siblings.back();
+						siblings.pop_back();
+						break;
+					}
+				}
+				nodes[node].children.clear();
+				freeNodes.push_back(node);
+			}
+			node = parent;
+		}
+		nodes[0].refs--;
+	}
+
+public:
+	actiontrie()
+	{
+		nodes.emplace_back();
+	}
+
+	/**
+	* Returns the id of an action, interning it on first use.
+	*/
+	ActionId intern(const std::string& action)
+	{
+		auto it = actionIds.find(action);
+		if (it != actionIds.end())
+			return it->second;
+		ActionId id = static_cast<ActionId>(actionNames.size());
+		actionIds.emplace(action, id);
+		actionNames.push_back(action);
+		return id;
+	}
+
+	/**
+	* Returns the id of a known action, <code>sNONE</code> for actions no
+	* procedure contains.
+	*/
+	ActionId find(const std::string& action) const
+	{
+		auto it = actionIds.find(action);
+		return (it == actionIds.end()) ? sNONE : it->second;
+	}
+
+	/**
+	* Stores a procedure, replacing a procedure with the same name.
+	*
+	* @param name the name of the procedure
+	* @param actions the actions of the procedure
+	*/
+	void add(const std::string& name, const std::list<std::string>& actions)
+	{
+		remove(name);
+		version++;
+		std::uint32_t node = 0;
+		nodes[0].refs++;
+		for (const std::string& action : actions)
+		{
+			ActionId id = intern(action);
+			std::uint32_t next = child(node, id);
+			if (next == sNONE)
+				next = addChild(node, id);
+			node = next;
+			nodes[node].refs++;
+		}
+		procedures[name] = node;
+	}
+
+	void remove(const std::string& name)
+	{
+		auto it = procedures.find(name);
+		if (it == procedures.end())
+			return;
+		release(it->second);
+		procedures.erase(it);
+		version++;
+	}
+
+	bool contains(const std::string& name) const
+	{
+		return procedures.find(name) != procedures.end();
+	}
+
+	/**
+	* Returns the actions of a procedure, empty if it is unknown.
+	*/
+	std::list<std::string> get(const std::string& name) const
+	{
+		std::list<std::string> actions;
+		auto it = procedures.find(name);
+		if (it == procedures.end())
+			return actions;
+		for (std::uint32_t node = it->second; node != 0; node = nodes[node].parent)
+			actions.push_front(actionNames[nodes[node].action]);
+		return actions;
+	}
+
+	/**
+	* Returns a cursor before the first action.
+	*/
+	Cursor start() const
+	{
+		return Cursor();
+	}
+
+	/**
+	* Returns a cursor before the first action that keeps the path of the
+	* specified procedure, so <code>isPrefixOf</code> checks it in constant
+	* time while no procedure is added or removed.
+	*/
+	Cursor start(const std::string& name) const
+	{
+		Cursor cursor;
+		auto it = procedures.find(name);
+		if (it == procedures.end())
+			return cursor;
+		cursor.path.resize(nodes[it->second].depth + 1);
+		for (std::uint32_t node = it->second; node != 0; node = nodes[node].parent)
+			cursor.path[nodes[node].depth] = node;
+		cursor.path[0] = 0;
+		cursor.version = version;
+		return cursor;
+	}
+
+	/**
+	* Moves the cursor over the next executed action.
+	*
+	* @param cursor the cursor
+	* @param action the executed action
+	* @return false if no stored procedure continues with this action
+	*/
+	bool advance(Cursor& cursor, const std::string& action) const
+	{
+		if (!cursor.valid)
+			return false;
+		ActionId id = find(action);
+		std::uint32_t next = (id == sNONE) ? sNONE : child(cursor.node, id);
+		if (next == sNONE)
+		{
+			cursor.valid = false;
+			return false;
+		}
+		cursor.node = next;
+		cursor.depth++;
+		return true;
+	}
+
+	/**
+	* Returns true if the actions the cursor followed are the beginning of the
+	* specified procedure.
+	*/
+	bool isPrefixOf(const Cursor& cursor, const std::string& name) const
+	{
+		auto it = procedures.find(name);
+		if (!cursor.valid || (it == procedures.end()))
+			return false;
+		std::uint32_t node = it->second;
+		if (nodes[node].depth < cursor.depth)
+			return false;
+		if ((cursor.version == version) && !cursor.path.empty() && (cursor.path.back() == node))
+			return cursor.path[cursor.depth] == cursor.node;
+		while (nodes[node].depth > cursor.depth)
+			node = nodes[node].parent;
+		return node == cursor.node;
+	}
+
+	/**
+	* Returns true if the cursor followed exactly the specified procedure.
+	*/
+	bool completes(const Cursor& cursor, const std::string& name) const
+	{
+		auto it = procedures.find(name);
+		return cursor.valid && (it != procedures.end()) && (it->second == cursor.node);
+	}
+};
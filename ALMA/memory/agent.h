@@ -35,12 +35,29 @@ public:
 		
 
 	
-	//copy from long term mem to execute reinforce long term mem by repeating action 
+	//follow the procedure in long term mem while it is executed
+	void beginpro(std::string mems)
+	{
+		mem.begin(longmem.getProcedures(), mems);
+	}
+
+	// returns true while the actions executed so far are the beginning of the procedure
+	bool steppro(std::string command)
+	{
+		return mem.step(command);
+	}
+
+	//execute a whole command sequence and compare it to the procedure in long term mem
 	bool executepro(std::string mems, list<string> commands) 
 	{
 		
-		mem.addTOProMem(mems, longmem.getLongMem(mems));
-		if (commands==mem.getMem(mems))
+		beginpro(mems);
+		for (const auto& command : commands)
+		{
+			if (!steppro(command))
+				break;
+		}
+		if (mem.done())
 		{
 			cout << "i am equal";
 			return true;
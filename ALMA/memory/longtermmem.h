@@ -2,35 +2,37 @@
 #include<map>
 #include<list>
 #include<string>
-#include<time.h>
+#include<random>
 #include<iostream>
+#include"actiontrie.h"
 using namespace std;
 class longtermmem{
 
 private:
-	std::map<std::string, std::list<std::string>> LongTermMem;
+	actiontrie LongTermMem;
+	std::mt19937 random{ std::random_device{}() };
 
 public:
 	longtermmem(){}
 
+	// every action of the procedure is learned with a chance of one half
 	void addToLongMem(std::string mem, std::list<std::string> item)
 	{
-		if (LongTermMem.empty() )
-		{
-			list<string> hello;
-			LongTermMem.emplace(mem, hello);
-		}
-		srand(time(NULL));
+		std::bernoulli_distribution learned(0.5);
+		std::list<std::string> learnedItems;
 		for (const auto& iv : item)
 		{
-			if (((rand() % 2) + 1)<2)
+			if (learned(random))
 			{
-				LongTermMem.at(mem).emplace_back(iv);
+				learnedItems.emplace_back(iv);
 				cout << iv;
 			}
 
 		}
-		if (LongTermMem.at(mem) == item)
+		std::list<std::string> procedure = LongTermMem.get(mem);
+		procedure.insert(procedure.end(), learnedItems.begin(), learnedItems.end());
+		LongTermMem.add(mem, procedure);
+		if (procedure == item)
 		{
 			cout << "Perfectly Learned";
 		}
@@ -38,18 +40,21 @@ public:
 		{
 			cout << "Something went wrong";
 		}
-		system("pause");
-		//LongTermMem.emplace(mem, item);
 	}
 
 	void removeFromLongMem(std::string mem)
 	{
-		LongTermMem.erase(mem);
+		LongTermMem.remove(mem);
 	}
 
 	std::list<std::string> getLongMem(std::string mem)
 	{
-		return LongTermMem[mem];
+		return LongTermMem.get(mem);
+	}
+
+	const actiontrie& getProcedures() const
+	{
+		return LongTermMem;
 	}
 
 	
@@ -58,4 +63,4 @@ public:
 	{
 
 	}
-};
\ No newline at end of file
+};
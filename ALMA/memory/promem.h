@@ -2,27 +2,43 @@
 #include<list>
 #include<map>
 #include<string>
+#include"actiontrie.h"
 using namespace std;
+// follows the execution of one procedure step by step
 class promem
 {
 private:
-	std::map<std::string, std::list<std::string>> memmory;
-	std::list<std::string> items;
+	const actiontrie* procedures = nullptr;
+	std::string memmory;
+	actiontrie::Cursor cursor;
 
 public:
 	promem(){}
-	void addTOProMem(std::string mem, std::list<std::string> item)
+	// starts executing the procedure mem of the specified procedural memory
+	void begin(const actiontrie& trie, std::string mem)
 	{
-		memmory.emplace(mem, item);
+		procedures = &trie;
+		memmory = mem;
+		cursor = trie.start(mem);
 	}
 
-	void removeFromProMem(std::string mem)
+	// returns true while the executed actions are the beginning of the procedure
+	bool step(const std::string& action)
 	{
-		memmory.erase(mem);
+		if (procedures == nullptr)
+			return false;
+		procedures->advance(cursor, action);
+		return procedures->isPrefixOf(cursor, memmory);
 	}
 
-	std::list<std::string > getMem(std::string mem)
+	// returns true if the executed actions are exactly the procedure
+	bool done() const
 	{
-		return memmory[mem];
+		return (procedures != nullptr) && procedures->completes(cursor, memmory);
 	}
-};
\ No newline at end of file
+
+	std::string getMem() const
+	{
+		return memmory;
+	}
+};
@@ -30,7 +30,7 @@ public:
 
 	static void setmood(timer_ptr_t emo)
 	{
-		emotion = emo;
+		mood = emo;
 	}
 	static timer_ptr_t getmood() { return mood; }
 	class timer : public std::enable_shared_from_this<timer>
@@ -122,6 +122,10 @@ public:
 
 	static void remove_timer(const timer_ptr_t &timer_ptr)
 	{
+		if (!timer_ptr)
+			return;
+		// a removed timer must not fire in the pass that erases it
+		timer_ptr->_enable = false;
 		timer_ptr->_remove_me = true;
 	}
 
@@ -0,0 +1,266 @@
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+/**
+* The sweep runner executes the ALMA simulation for every configuration of a
+* parameter grid over the personality traits and the Setup.json constants.
+* <br>
+* Each configuration is run as a separate <code>ALMA --run</code> process, so
+* runs are isolated from each other (timers and relation tables of ALMA are
+* process wide) and are distributed over all cores. Every run writes its own
+* CSV files; after all runs a summary table with the final mood of each run
+* is written.
+* <br>
+* Usage: <code>Sweep sweep.json</code>, started in ALMA's data directory:
+* <pre>
+* {
+*   "executable": "ALMA.exe",
+*   "outputDirectory": "output/sweep",
+*   "threads": 0,
+*   "choices": [1, 2, 1, 1, 2],
+*   "personality": { "openness": [0.04], "conscientiousness": [0.02],
+*                    "extraversion": [-0.45, 0.0, 0.45], "agreeableness": [0.01],
+*                    "neurotism": [0.01] },
+*   "setup": { "emotionDecaySteps": [30, 47], "Moodneurotismstability": [false, true] }
+* }
+* </pre>
+* Missing traits default to 0.0, "threads" 0 uses all cores. The choices are
+* the scripted player choices of every run.
+*
+* @version 1.0
+*/
+
+static const char* sTRAITS[5] = { "openness", "conscientiousness", "extraversion", "agreeableness", "neurotism" };
+
+/**
+* One axis of the parameter grid.
+*/
+struct Dimension {
+	std::string name;
+	/** index into sTRAITS, -1 for a Setup.json constant */
+	int trait;
+	json values;
+};
+
+struct RunResult {
+	int exitCode = -1;
+	int rows = 0;
+	std::string pleasure;
+	std::string arousal;
+	std::string dominance;
+	std::string mood;
+};
+
+static std::string runName(size_t run)
+{
+	std::ostringstream name;
+	name << "run-" << std::setw(4) << std::setfill('0') << run + 1;
+	return name.str();
+}
+
+static void makeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+/**
+* Converts the status returned by <code>std::system</code> into the exit code
+* of the run. On POSIX the status is a wait status; a run killed by a signal
+* reports 128 + the signal number, like a shell does.
+*/
+static int exitCode(int status)
+{
+#ifdef _WIN32
+	return status;
+#else
+	if (status == -1)
+		return -1;
+	if (WIFEXITED(status))
+		return WEXITSTATUS(status);
+	if (WIFSIGNALED(status))
+		return 128 + WTERMSIG(status);
+	return -1;
+#endif
+}
+
+/**
+* Returns the values of all dimensions for a run; the first dimension varies
+* slowest.
+*/
+static std::vector<json> gridPoint(const std::vector<Dimension>& dimensions, size_t run)
+{
+	std::vector<json> point(dimensions.size());
+	for (size_t i = dimensions.size(); i-- > 0;) {
+		size_t count = dimensions[i].values.size();
+		point[i] = dimensions[i].values[run % count];
+		run /= count;
+	}
+	return point;
+}
+
+/**
+* Reads the reaction rows of a run's mood log and keeps the last mood. The
+* header and the initial "None" row, which holds the default mood before the
+* first reaction, are not counted.
+*/
+static void readResult(const std::string& csvFile, RunResult& result)
+{
+	std::ifstream csv{ csvFile };
+	std::string line;
+	std::string last;
+	bool header = true;
+	while (std::getline(csv, line)) {
+		if (line.empty())
+			continue;
+		if (header) {
+			header = false;
+			continue;
+		}
+		if (line.compare(0, 5, "None,") == 0)
+			continue;
+		result.rows++;
+		last = line;
+	}
+	std::vector<std::string> fields;
+	std::istringstream row(last);
+	std::string field;
+	while (std::getline(row, field, ','))
+		fields.push_back(field);
+	if (fields.size() >= 5) {
+		result.pleasure = fields[1];
+		result.arousal = fields[2];
+		result.dominance = fields[3];
+		result.mood = fields[4];
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2) {
+		std::cerr << "Usage: Sweep sweep.json" << std::endl;
+		return 1;
+	}
+	json sweep;
+	std::ifstream sweepFile{ argv[1] };
+	if (!sweepFile) {
+		std::cerr << "Failed to open '" << argv[1] << "'." << std::endl;
+		return 1;
+	}
+	sweepFile >> sweep;
+
+	std::string executable = sweep.value("executable", std::string("ALMA.exe"));
+	std::string outputDirectory = sweep.value("outputDirectory", std::string("output/sweep"));
+	json choices = sweep.value("choices", json::array());
+	makeDirectory(outputDirectory);
+
+	std::vector<Dimension> dimensions;
+	json personality = sweep.value("personality", json::object());
+	for (int i = 0; i < 5; i++) {
+		json values = (personality.find(sTRAITS[i]) != personality.end()) ? personality[sTRAITS[i]] : json::array({ 0.0 });
+		if (!values.is_array() || values.empty()) {
+			std::cerr << "Trait '" << sTRAITS[i] << "' needs a non-empty list of values." << std::endl;
+			return 1;
+		}
+		dimensions.push_back({ sTRAITS[i], i, values });
+	}
+	json setup = sweep.value("setup", json::object());
+	for (auto it = setup.begin(); it != setup.end(); ++it) {
+		if (!it.value().is_array() || it.value().empty()) {
+			std::cerr << "Constant '" << it.key() << "' needs a non-empty list of values." << std::endl;
+			return 1;
+		}
+		dimensions.push_back({ it.key(), -1, it.value() });
+	}
+
+	size_t runs = 1;
+	for (const Dimension& dimension : dimensions)
+		runs *= dimension.values.size();
+
+	// write all run configurations first, the workers only start processes
+	for (size_t run = 0; run < runs; run++) {
+		std::vector<json> point = gridPoint(dimensions, run);
+		json config;
+		config["personality"] = json::array();
+		config["setup"] = json::object();
+		for (size_t i = 0; i < dimensions.size(); i++) {
+			if (dimensions[i].trait >= 0)
+				config["personality"].push_back(point[i]);
+			else
+				config["setup"][dimensions[i].name] = point[i];
+		}
+		std::string base = outputDirectory + "/" + runName(run);
+		config["choices"] = choices;
+		config["output"] = base + ".csv";
+		config["memoryOutput"] = base + "-memory.csv";
+		std::ofstream configFile{ base + ".json" };
+		configFile << config.dump(4) << std::endl;
+	}
+
+	unsigned threads = sweep.value("threads", 0u);
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	std::vector<RunResult> results(runs);
+	std::atomic<size_t> next{ 0 };
+	std::atomic<size_t> finished{ 0 };
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; t++) {
+		workers.emplace_back([&]() {
+			for (size_t run = next++; run < runs; run = next++) {
+				std::string base = outputDirectory + "/" + runName(run);
+				std::string command = "\"" + executable + "\" --run \"" + base + ".json\" > \"" + base + ".log\" 2>&1";
+#ifdef _WIN32
+				// cmd.exe strips the outermost quotes
+				command = "\"" + command + "\"";
+#endif
+				results[run].exitCode = exitCode(std::system(command.c_str()));
+				readResult(base + ".csv", results[run]);
+				std::cout << runName(run) << " finished (" << ++finished << "/" << runs << ")" << std::endl;
+			}
+		});
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+
+	std::ofstream summary{ outputDirectory + "/summary.csv" };
+	summary << "Run";
+	for (const Dimension& dimension : dimensions)
+		summary << "," << dimension.name;
+	summary << ",ExitCode,Rows,Pleasure,Arousal,Dominance,Mood" << std::endl;
+	int failed = 0;
+	for (size_t run = 0; run < runs; run++) {
+		std::vector<json> point = gridPoint(dimensions, run);
+		summary << runName(run);
+		for (const json& value : point)
+			summary << "," << value.dump();
+		const RunResult& result = results[run];
+		summary << "," << result.exitCode << "," << result.rows << "," << result.pleasure << ","
+			<< result.arousal << "," << result.dominance << "," << result.mood << std::endl;
+		if (result.exitCode != 0)
+			failed++;
+	}
+	std::cout << runs << " runs, " << failed << " failed, summary in " << outputDirectory << "/summary.csv" << std::endl;
+	return (failed == 0) ? 0 : 2;
+}